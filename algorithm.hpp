@@ -1,14 +1,25 @@
 #ifndef SJTU_ALGORITHM_HPP
 #define SJTU_ALGORITHM_HPP
 
+#include "tuning.hpp"
+
 #include <functional>
 
 namespace sjtu{
 
+/**
+ * quicksort [begin, end) with cmp; partitions of at most cutoff elements are insertion sorted
+ */
 template<typename T>
-void sort(T *begin, T *end, std::function<bool(const T&, const T&)> cmp){
+void sort(T *begin, T *end, std::function<bool(const T&, const T&)> cmp, int cutoff){
     int len = end - begin;
     if (len <= 1) return ;
+    if (len <= cutoff){
+        for (T *i = begin + 1; i < end; i++)
+            for (T *j = i; j > begin && cmp(*j, *(j - 1)); j--)
+                std::swap(*j, *(j - 1));
+        return ;
+    }
     T *i = begin, *j = end - 1;
     T pivot = *(begin + (len + 1) / 2 - 1);
     while (j - i >= 0){
@@ -19,8 +30,13 @@ void sort(T *begin, T *end, std::function<bool(const T&, const T&)> cmp){
             i++, j--;
         }
     }
-    if (j - begin > 0) sort(begin, i, cmp);
-    if (end - i > 1) sort(i, end, cmp);
+    if (j - begin > 0) sort(begin, i, cmp, cutoff);
+    if (end - i > 1) sort(i, end, cmp, cutoff);
+}
+
+template<typename T>
+void sort(T *begin, T *end, std::function<bool(const T&, const T&)> cmp){
+    sort(begin, end, cmp, SJTU_SORT_CUTOFF);
 }
 
 template<class T>
@@ -43,6 +59,58 @@ T *lower_bound(const T *begin, const T *end, const T &num){
     return const_cast<T *>(begin + r);
 }
 
+/**
+ * lower_bound / upper_bound of sorted arithmetic keys by interpolation search
+ * a probe is placed where num would be if the keys between the two closest
+ * probes around the answer were evenly spread; a probe that does not halve the
+ * range is followed by a bisection. every key is read once, so skewed keys cost
+ * at most about twice the probes of a binary search.
+ * the results are those of sjtu::lower_bound / upper_bound
+ */
+template<class T>
+T *interpolation_bound(const T *begin, const T *end, const T &num, bool upper){
+    // before(x) says whether x goes before the answer
+    auto before = [&num, upper](const T &x){ return upper ? !(num < x) : x < num; };
+    size_t n = end - begin;
+    if (n == 0 || !before(begin[0])) return const_cast<T *>(begin);
+    T lo_key = begin[0], hi_key = begin[n - 1];
+    if (before(hi_key)) return const_cast<T *>(end);
+    // begin[lo] = lo_key goes before the answer and begin[hi] = hi_key does not,
+    // so the answer is in (lo, hi] and lo_key < hi_key
+    size_t lo = 0, hi = n - 1;
+    bool bisect = false;
+    while (hi - lo > 1){
+        size_t mid, width = hi - lo;
+        if (bisect){
+            mid = lo + width / 2;
+        } else {
+            long double share = ((long double)num - (long double)lo_key) / ((long double)hi_key - (long double)lo_key);
+            mid = lo + 1 + (size_t)(share * (long double)(width - 2));
+            if (mid > hi - 1) mid = hi - 1;
+        }
+        T key = begin[mid];
+        if (before(key)){
+            lo = mid;
+            lo_key = key;
+        } else {
+            hi = mid;
+            hi_key = key;
+        }
+        bisect = !bisect && hi - lo > width / 2;
+    }
+    return const_cast<T *>(begin + hi);
+}
+
+template<class T>
+T *interpolation_lower_bound(const T *begin, const T *end, const T &num){
+    return interpolation_bound(begin, end, num, false);
+}
+
+template<class T>
+T *interpolation_upper_bound(const T *begin, const T *end, const T &num){
+    return interpolation_bound(begin, end, num, true);
+}
+
 };
 
 #endif //SJTU_ALGORITHM_HPP
@@ -0,0 +1,125 @@
+#ifndef SJTU_APPEND_LIST_HPP
+#define SJTU_APPEND_LIST_HPP
+
+#include "list.hpp"
+
+#include <atomic>
+#include <cstddef>
+
+namespace sjtu {
+
+/**
+ * a list that many threads append to and one thread drains, without locks
+ * a producer builds a segment in a list<T> of its own and append() moves its
+ * whole chain of nodes onto the shared tail with one compare-and-swap; the
+ * consumer takes every appended chain at once with drain_all().
+ * no element is copied or moved on either side, the nodes change hands.
+ * segments come out in the order their appends took effect, each one intact.
+ */
+template<typename T>
+class append_list {
+protected:
+    typedef typename list<T>::node node;
+    /**
+     * an appended segment: its nodes first .. last are linked to each other,
+     * below is the segment appended just before it
+     */
+    struct chain {
+        node *first;
+        node *last;
+        size_t size;
+        chain *below;
+    };
+
+    /**
+     * the segment appended last, so the chains form a stack from the tail down
+     */
+    alignas(64) std::atomic<chain *> top;
+
+    static void free_chains(chain *c) {
+        while (c != nullptr) {
+            node *cur = c->first;
+            while (cur != nullptr) {
+                node *next = cur->next;
+                delete cur;
+                cur = next;
+            }
+            chain *below = c->below;
+            delete c;
+            c = below;
+        }
+    }
+
+public:
+    append_list() : top(nullptr) {}
+    append_list(const append_list &) = delete;
+    append_list &operator=(const append_list &) = delete;
+    ~append_list() {
+        free_chains(top.load(std::memory_order_acquire));
+    }
+
+    /**
+     * move every element of segment to the end in O(1), segment becomes empty
+     * safe to call from any number of threads at once, and while drain_all() runs
+     */
+    void append(list<T> &segment) {
+        segment.compact_erased();
+        if (segment.empty()) return;
+        chain *c = new chain;
+        c->first = segment.head->next;
+        c->last = segment.tail->prev;
+        c->size = segment.list_size;
+        c->first->prev = nullptr;
+        c->last->next = nullptr;
+        segment.head->next = segment.tail;
+        segment.tail->prev = segment.head;
+        segment.list_size = 0;
+        segment.sorted_prefix = 0;
+
+        c->below = top.load(std::memory_order_relaxed);
+        while (!top.compare_exchange_weak(c->below, c, std::memory_order_release, std::memory_order_relaxed)) {}
+    }
+    /**
+     * take everything appended so far and link it to the end of into
+     * the chains are detached with one exchange, then stitched together in
+     * time linear in the number of appends, not of elements
+     * only one thread may drain at a time
+     */
+    void drain_into(list<T> &into) {
+        chain *c = top.exchange(nullptr, std::memory_order_acquire);
+        if (c == nullptr) return;
+        into.reap_before(into.tail);
+        node *before = into.tail->prev;
+        node *next = into.tail;
+        // the newest chain goes last, so walk down the stack from the end
+        while (c != nullptr) {
+            c->last->next = next;
+            next->prev = c->last;
+            next = c->first;
+            into.list_size += c->size;
+            chain *below = c->below;
+            delete c;
+            c = below;
+        }
+        before->next = next;
+        next->prev = before;
+    }
+    /**
+     * take everything appended so far as a list
+     */
+    list<T> drain_all() {
+        list<T> out;
+        drain_into(out);
+        return out;
+    }
+    /**
+     * whether nothing is waiting to be drained, at the moment of the call
+     */
+    bool empty() const {
+        return top.load(std::memory_order_acquire) == nullptr;
+    }
+};
+
+}
+
+#endif //SJTU_APPEND_LIST_HPP
@@ -0,0 +1,120 @@
+// Measures the crossover thresholds of tuning.hpp on this machine.
+// Usage: autotune <output header>
+// Writes a tuning_generated.hpp with one #define per threshold and echoes
+// the timings as CSV lines knob,value,ns_per_op on stdout.
+
+#include "algorithm.hpp"
+#include "class-bint.hpp"
+#include "class-matrix.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+template<typename Work>
+double measure(const char *knob, size_t value, Work work) {
+    size_t reps = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::nanoseconds elapsed(0);
+    do {
+        work();
+        ++reps;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed < std::chrono::milliseconds(200));
+    double ns = double(elapsed.count()) / reps;
+    printf("%s,%zu,%.0f\n", knob, value, ns);
+    fflush(stdout);
+    return ns;
+}
+
+size_t tuneSortCutoff() {
+    std::vector<int> input(100000);
+    for (size_t i = 0; i < input.size(); ++i)
+        input[i] = rand();
+    std::vector<int> work;
+    std::function<bool(const int &, const int &)> less = [](const int &x, const int &y) { return x < y; };
+    const size_t candidates[] = {1, 4, 8, 12, 16, 24, 32, 48, 64};
+    size_t best = candidates[0];
+    double bestNs = 0;
+    for (size_t cutoff : candidates) {
+        double ns = measure("sort_cutoff", cutoff, [&]() {
+            work = input;
+            sjtu::sort(work.data(), work.data() + work.size(), less, int(cutoff));
+        });
+        if (cutoff == candidates[0] || ns < bestNs)
+            best = cutoff, bestNs = ns;
+    }
+    return best;
+}
+
+size_t tuneBintMulBase() {
+    std::string x(1, '7'), y(1, '3');
+    for (size_t i = 1; i < 2048 * 4; ++i) {
+        x += char('0' + rand() % 10);
+        y += char('0' + rand() % 10);
+    }
+    Util::Bint a(x), b(y);
+    const size_t candidates[] = {16, 24, 32, 48, 64, 96, 128, 256};
+    size_t best = candidates[0];
+    double bestNs = 0;
+    for (size_t baseCase : candidates) {
+        double ns = measure("bint_mul_base", baseCase, [&]() { Util::Bint c = multiply(a, b, baseCase); });
+        if (baseCase == candidates[0] || ns < bestNs)
+            best = baseCase, bestNs = ns;
+    }
+    return best;
+}
+
+void tuneMatrixTiles(size_t &bestRows, size_t &bestInner, size_t &bestCols) {
+    const size_t n = 192;
+    Diamond::Matrix<double> a(n, n), b(n, n);
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j) {
+            a[i][j] = double(rand() % 1000) / 1000;
+            b[i][j] = double(rand() % 1000) / 1000;
+        }
+    const size_t rowTiles[] = {8, 16, 32, 64};
+    const size_t innerTiles[] = {16, 32, 64, 128};
+    const size_t colTiles[] = {64, 128, 256};
+    double bestNs = 0;
+    bool first = true;
+    for (size_t r : rowTiles)
+        for (size_t k : innerTiles)
+            for (size_t c : colTiles) {
+                double ns = measure("matrix_tile", r * 1000000 + k * 1000 + c, [&]() {
+                    Diamond::Matrix<double> p = Diamond::Multiply(a, b, r, k, c);
+                });
+                if (first || ns < bestNs) {
+                    bestRows = r, bestInner = k, bestCols = c, bestNs = ns;
+                    first = false;
+                }
+            }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <output header>\n", argv[0]);
+        return 1;
+    }
+    srand(20220207);
+    size_t sortCutoff = tuneSortCutoff();
+    size_t mulBase = tuneBintMulBase();
+    size_t tileRows, tileInner, tileCols;
+    tuneMatrixTiles(tileRows, tileInner, tileCols);
+
+    FILE *out = fopen(argv[1], "w");
+    if (out == nullptr) {
+        perror(argv[1]);
+        return 1;
+    }
+    fprintf(out, "// Generated by autotune; rerun the tune target to refresh.\n");
+    fprintf(out, "#ifndef SJTU_SORT_CUTOFF\n#define SJTU_SORT_CUTOFF %zu\n#endif\n", sortCutoff);
+    fprintf(out, "#ifndef UTIL_BINT_MUL_BASE\n#define UTIL_BINT_MUL_BASE %zu\n#endif\n", mulBase);
+    fprintf(out, "#ifndef DIAMOND_MATRIX_TILE_ROWS\n#define DIAMOND_MATRIX_TILE_ROWS %zu\n#endif\n", tileRows);
+    fprintf(out, "#ifndef DIAMOND_MATRIX_TILE_INNER\n#define DIAMOND_MATRIX_TILE_INNER %zu\n#endif\n", tileInner);
+    fprintf(out, "#ifndef DIAMOND_MATRIX_TILE_COLS\n#define DIAMOND_MATRIX_TILE_COLS %zu\n#endif\n", tileCols);
+    fclose(out);
+    return 0;
+}
@@ -0,0 +1,45 @@
+// Timing of Util::gcd and Util::exact_div from 10^2 to 10^5 limbs.
+// Usage: bint_gcd_bench [max_limbs]; prints CSV lines op,limbs,reps,ns_per_op
+
+#include "class-bint.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+std::string randomDigits(size_t limbs) {
+    std::string s(1, char('1' + rand() % 9));
+    for (size_t i = 1; i < limbs * 4; ++i)
+        s += char('0' + rand() % 10);
+    return s;
+}
+
+template<typename Work>
+void measure(const char *op, size_t limbs, Work work) {
+    size_t reps = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::nanoseconds elapsed(0);
+    do {
+        work();
+        ++reps;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed < std::chrono::milliseconds(200));
+    printf("%s,%zu,%zu,%.0f\n", op, limbs, reps, double(elapsed.count()) / reps);
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[]) {
+    size_t maxLimbs = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000;
+    srand(20220207);
+    printf("op,limbs,reps,ns_per_op\n");
+    for (size_t limbs = 100; limbs <= maxLimbs; limbs *= 10) {
+        Util::Bint a(randomDigits(limbs)), b(randomDigits(limbs));
+        measure("gcd", limbs, [&]() { Util::gcd(a, b); });
+
+        Util::Bint x(randomDigits(limbs / 2)), y(randomDigits(limbs / 2));
+        Util::Bint xy = x * y;
+        measure("exact_div", limbs, [&]() { Util::exact_div(xy, y); });
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+// A pipeline of stages passing integers through bounded queues.
+// Usage: channel_bench [items] [max_stages]
+// Every stage receives a value, adds one and passes it on. Prints CSV lines
+// variant,stages,capacity,items,ns_per_item for coroutines on one thread
+// connected by sjtu::channel, and one thread per stage connected by
+// sjtu::list queues behind a mutex and condition variables.
+
+#include "channel.hpp"
+#include "list.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+class BlockingQueue {
+    std::mutex lock;
+    std::condition_variable notEmpty, notFull;
+    sjtu::list<int> items;
+    size_t capacity;
+    bool closed = false;
+public:
+    explicit BlockingQueue(size_t c) : capacity(c) {}
+    void push(int x) {
+        std::unique_lock<std::mutex> guard(lock);
+        notFull.wait(guard, [this]() { return items.size() < capacity; });
+        items.push_back(x);
+        notEmpty.notify_one();
+    }
+    bool pop(int &x) {
+        std::unique_lock<std::mutex> guard(lock);
+        notEmpty.wait(guard, [this]() { return !items.empty() || closed; });
+        if (items.empty())
+            return false;
+        x = items.front();
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+    void close() {
+        std::lock_guard<std::mutex> guard(lock);
+        closed = true;
+        notEmpty.notify_all();
+    }
+};
+
+sjtu::task source(sjtu::channel<int> &out, size_t items) {
+    for (size_t i = 0; i < items; ++i)
+        co_await out.send(int(i));
+    out.close();
+}
+
+sjtu::task stage(sjtu::channel<int> &in, sjtu::channel<int> &out) {
+    while (true) {
+        std::optional<int> x = co_await in.recv();
+        if (!x)
+            break;
+        co_await out.send(*x + 1);
+    }
+    out.close();
+}
+
+sjtu::task sink(sjtu::channel<int> &in, long long &sum) {
+    while (true) {
+        std::optional<int> x = co_await in.recv();
+        if (!x)
+            break;
+        sum += *x;
+    }
+}
+
+template<typename Body>
+void measure(const char *variant, size_t stages, size_t capacity, size_t items, Body body) {
+    auto start = std::chrono::steady_clock::now();
+    long long sum = body();
+    std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+    printf("%s,%zu,%zu,%zu,%.1f\n", variant, stages, capacity, items, double(elapsed.count()) / items);
+    fflush(stdout);
+    long long expect = (long long)items * (long long)(items - 1) / 2 + (long long)items * (long long)stages;
+    if (sum != expect)
+        printf("wrong sum %lld, expected %lld\n", sum, expect);
+}
+
+int main(int argc, char *argv[]) {
+    size_t items = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+    size_t maxStages = argc > 2 ? strtoul(argv[2], nullptr, 10) : 8;
+    printf("variant,stages,capacity,items,ns_per_item\n");
+    for (size_t stages = 1; stages <= maxStages; stages *= 2) {
+        for (size_t capacity : {1, 64}) {
+            measure("coroutine", stages, capacity, items, [&]() {
+                sjtu::executor ex;
+                std::vector<sjtu::channel<int> *> links;
+                for (size_t s = 0; s <= stages; ++s)
+                    links.push_back(new sjtu::channel<int>(ex, capacity));
+                long long sum = 0;
+                ex.spawn(source(*links[0], items));
+                for (size_t s = 0; s < stages; ++s)
+                    ex.spawn(stage(*links[s], *links[s + 1]));
+                ex.spawn(sink(*links[stages], sum));
+                ex.run();
+                for (size_t s = 0; s <= stages; ++s)
+                    delete links[s];
+                return sum;
+            });
+            measure("condvar", stages, capacity, items, [&]() {
+                std::vector<BlockingQueue *> links;
+                for (size_t s = 0; s <= stages; ++s)
+                    links.push_back(new BlockingQueue(capacity));
+                long long sum = 0;
+                std::vector<std::thread> pool;
+                pool.emplace_back([&]() {
+                    for (size_t i = 0; i < items; ++i)
+                        links[0]->push(int(i));
+                    links[0]->close();
+                });
+                for (size_t s = 0; s < stages; ++s) {
+                    pool.emplace_back([&, s]() {
+                        int x;
+                        while (links[s]->pop(x))
+                            links[s + 1]->push(x + 1);
+                        links[s + 1]->close();
+                    });
+                }
+                int x;
+                while (links[stages]->pop(x))
+                    sum += x;
+                for (size_t t = 0; t < pool.size(); ++t)
+                    pool[t].join();
+                for (size_t s = 0; s <= stages; ++s)
+                    delete links[s];
+                return sum;
+            });
+        }
+    }
+    return 0;
+}
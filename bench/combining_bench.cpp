@@ -0,0 +1,157 @@
+// Contended queue workload on three shared lists.
+// Usage: combining_bench [max_threads] [ops_per_thread]
+// Every thread alternates push_back and pop_front. Prints CSV lines
+// variant,threads,ops,ns_per_op for a mutex around sjtu::list, the flat
+// combining list and a lock-free Michael-Scott queue.
+
+#include "combining_list.hpp"
+#include "list.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class MutexList {
+    std::mutex lock;
+    sjtu::list<int> items;
+public:
+    void push_back(int x) {
+        std::lock_guard<std::mutex> guard(lock);
+        items.push_back(x);
+    }
+    bool pop_front(int &x) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (items.empty())
+            return false;
+        x = items.front();
+        items.pop_front();
+        return true;
+    }
+};
+
+// Popped nodes are retired per thread and freed only after the run, which
+// keeps the queue free of ABA and reclamation costs for the comparison.
+class LockFreeQueue {
+    struct Node {
+        int value;
+        std::atomic<Node *> next;
+        Node(int v) : value(v), next(nullptr) {}
+    };
+    alignas(64) std::atomic<Node *> head;
+    alignas(64) std::atomic<Node *> tail;
+    std::mutex retiredLock;
+    std::vector<Node *> retired;
+public:
+    LockFreeQueue() {
+        Node *dummy = new Node(0);
+        head.store(dummy);
+        tail.store(dummy);
+    }
+    ~LockFreeQueue() {
+        for (Node *n : retired)
+            delete n;
+        for (Node *n = head.load(); n != nullptr;) {
+            Node *next = n->next.load();
+            delete n;
+            n = next;
+        }
+    }
+    void push_back(int x) {
+        Node *n = new Node(x);
+        while (true) {
+            Node *last = tail.load(std::memory_order_acquire);
+            Node *next = last->next.load(std::memory_order_acquire);
+            if (next == nullptr) {
+                if (last->next.compare_exchange_weak(next, n, std::memory_order_release)) {
+                    tail.compare_exchange_strong(last, n, std::memory_order_release);
+                    return;
+                }
+            } else {
+                tail.compare_exchange_weak(last, next, std::memory_order_release);
+            }
+        }
+    }
+    bool pop_front(int &x, std::vector<Node *> &mine) {
+        while (true) {
+            Node *first = head.load(std::memory_order_acquire);
+            Node *last = tail.load(std::memory_order_acquire);
+            Node *next = first->next.load(std::memory_order_acquire);
+            if (next == nullptr)
+                return false;
+            if (first == last) {
+                tail.compare_exchange_weak(last, next, std::memory_order_release);
+                continue;
+            }
+            int value = next->value;
+            if (head.compare_exchange_weak(first, next, std::memory_order_acq_rel)) {
+                x = value;
+                mine.push_back(first);
+                return true;
+            }
+        }
+    }
+    void retire(std::vector<Node *> &mine) {
+        std::lock_guard<std::mutex> guard(retiredLock);
+        retired.insert(retired.end(), mine.begin(), mine.end());
+        mine.clear();
+    }
+    typedef std::vector<Node *> Retired;
+};
+
+template<typename Body>
+void measure(const char *variant, size_t threads, size_t ops, Body body) {
+    std::vector<std::thread> pool;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; ++t)
+        pool.emplace_back([&, t]() { body(t); });
+    for (size_t t = 0; t < threads; ++t)
+        pool[t].join();
+    std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+    printf("%s,%zu,%zu,%.1f\n", variant, threads, threads * ops, double(elapsed.count()) / (threads * ops));
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[]) {
+    size_t maxThreads = argc > 1 ? strtoul(argv[1], nullptr, 10) : 8;
+    size_t ops = argc > 2 ? strtoul(argv[2], nullptr, 10) : 200000;
+    printf("variant,threads,ops,ns_per_op\n");
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        {
+            MutexList shared;
+            measure("mutex", threads, ops, [&](size_t t) {
+                int x;
+                for (size_t i = 0; i < ops; i += 2) {
+                    shared.push_back(int(t * ops + i));
+                    shared.pop_front(x);
+                }
+            });
+        }
+        {
+            sjtu::combining_list<int> shared;
+            measure("combining", threads, ops, [&](size_t t) {
+                int x;
+                for (size_t i = 0; i < ops; i += 2) {
+                    shared.push_back(int(t * ops + i));
+                    shared.pop_front(x);
+                }
+            });
+        }
+        {
+            LockFreeQueue shared;
+            measure("lockfree", threads, ops, [&](size_t t) {
+                LockFreeQueue::Retired mine;
+                int x;
+                for (size_t i = 0; i < ops; i += 2) {
+                    shared.push_back(int(t * ops + i));
+                    shared.pop_front(x, mine);
+                }
+                shared.retire(mine);
+            });
+        }
+    }
+    return 0;
+}
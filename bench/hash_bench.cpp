@@ -0,0 +1,82 @@
+// Point operations on sjtu::unordered_map and std::unordered_map.
+// Usage: hash_bench [int_keys] [bint_keys]
+// Prints CSV lines map,key,op,n,ns_per_op for inserting n distinct keys,
+// looking all of them up, looking up as many absent keys and erasing them.
+// Every Bint reserves its minimum capacity, so keep bint_keys moderate.
+
+#include "class-bint.hpp"
+#include "unordered_map.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+template<typename Work>
+void measure(const char *map, const char *key, const char *op, size_t n, Work work) {
+    auto start = std::chrono::steady_clock::now();
+    size_t checksum = work();
+    std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+    printf("%s,%s,%s,%zu,%.1f\n", map, key, op, n, double(elapsed.count()) / n);
+    fflush(stdout);
+    if (checksum == size_t(-1))
+        printf("unreachable\n");
+}
+
+template<class Map, class K>
+void run(const char *map, const char *key, const std::vector<K> &present, const std::vector<K> &absent) {
+    size_t n = present.size();
+    Map m;
+    measure(map, key, "insert", n, [&]() {
+        for (size_t i = 0; i < n; ++i)
+            m[present[i]] = int(i);
+        return m.size();
+    });
+    measure(map, key, "hit", n, [&]() {
+        size_t found = 0;
+        for (size_t i = 0; i < n; ++i)
+            found += m.find(present[i]) != m.end();
+        return found;
+    });
+    measure(map, key, "miss", n, [&]() {
+        size_t found = 0;
+        for (size_t i = 0; i < n; ++i)
+            found += m.count(absent[i]);
+        return found;
+    });
+    measure(map, key, "erase", n, [&]() {
+        size_t erased = 0;
+        for (size_t i = 0; i < n; ++i)
+            erased += m.erase(present[i]);
+        return erased;
+    });
+}
+
+int main(int argc, char *argv[]) {
+    size_t intKeys = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+    size_t bintKeys = argc > 2 ? strtoul(argv[2], nullptr, 10) : 20000;
+    printf("map,key,op,n,ns_per_op\n");
+
+    std::vector<long long> present, absent;
+    for (size_t i = 0; i < intKeys; ++i) {
+        long long x = ((long long)rand() << 31 | rand()) & ~1LL;
+        present.push_back(x);
+        absent.push_back(x | 1);
+    }
+    run<sjtu::unordered_map<long long, int>>("sjtu", "int", present, absent);
+    run<std::unordered_map<long long, int>>("std", "int", present, absent);
+
+    std::vector<Util::Bint> bintPresent, bintAbsent;
+    for (size_t i = 0; i < bintKeys; ++i) {
+        std::string digits(1, char('1' + rand() % 9));
+        for (int j = 0; j < 30; ++j)
+            digits += char('0' + rand() % 10);
+        bintPresent.push_back(Util::Bint(digits + "0"));
+        bintAbsent.push_back(Util::Bint(digits + "1"));
+    }
+    run<sjtu::unordered_map<Util::Bint, int>>("sjtu", "Bint", bintPresent, bintAbsent);
+    run<std::unordered_map<Util::Bint, int>>("std", "Bint", bintPresent, bintAbsent);
+    return 0;
+}
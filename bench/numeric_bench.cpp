@@ -0,0 +1,92 @@
+// Timing sweep of the Bint and Matrix kernels.
+// Usage: numeric_bench [max_bint_limbs] [max_matrix_size]
+// Prints CSV lines kernel,size,reps,ns_per_op where size is the number of
+// limbs for Bint kernels and the side length for Matrix kernels.
+
+#include "class-matrix-bint.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+std::string randomDigits(size_t limbs) {
+    std::string s(1, char('1' + rand() % 9));
+    for (size_t i = 1; i < limbs * 4; ++i)
+        s += char('0' + rand() % 10);
+    return s;
+}
+
+template<typename _Td>
+Diamond::Matrix<_Td> randomMatrix(size_t n) {
+    Diamond::Matrix<_Td> m(n, n);
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j)
+            m[i][j] = _Td(rand() % 1000) / _Td(1000);
+    return m;
+}
+
+template<typename Work>
+void measure(const char *kernel, size_t size, Work work) {
+    size_t reps = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::nanoseconds elapsed(0);
+    do {
+        work();
+        ++reps;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed < std::chrono::milliseconds(100));
+    printf("%s,%zu,%zu,%.0f\n", kernel, size, reps, double(elapsed.count()) / reps);
+    fflush(stdout);
+}
+
+void benchBint(size_t maxLimbs) {
+    for (size_t limbs = 4; limbs <= maxLimbs; limbs *= 2) {
+        std::string digits = randomDigits(limbs);
+        Util::Bint a(digits), b(randomDigits(limbs));
+        measure("bint_add", limbs, [&]() { Util::Bint c = a + b; });
+        measure("bint_mul", limbs, [&]() { Util::Bint c = a * b; });
+        measure("bint_parse", limbs, [&]() { Util::Bint c(digits); });
+        measure("bint_print", limbs, [&]() { std::ostringstream os; os << a; });
+    }
+}
+
+void benchMatrix(size_t maxSize) {
+    for (size_t n = 4; n <= maxSize; n *= 2) {
+        Diamond::Matrix<double> a = randomMatrix<double>(n), b = randomMatrix<double>(n);
+        measure("matrix_mul", n, [&]() { Diamond::Matrix<double> c = a * b; });
+        measure("matrix_transpose", n, [&]() { Diamond::Matrix<double> c = Diamond::Transpose(a); });
+        measure("matrix_print", n, [&]() { std::ostringstream os; os << a; });
+        measure("matrix_pow8", n, [&]() { size_t e = 8; Diamond::Matrix<double> c = Diamond::Pow(a, e); });
+        measure("matrix_add", n, [&]() { Diamond::Matrix<double> c = a + b; });
+        measure("matrix_sub", n, [&]() { Diamond::Matrix<double> c = a - b; });
+        measure("matrix_scale", n, [&]() { Diamond::Matrix<double> c = a * 1.5; });
+        measure("matrix_div", n, [&]() { Diamond::Matrix<double> c = a / 1.5; });
+        measure("matrix_lu", n, [&]() { Diamond::LUFactors<double> f = Diamond::LUDecompose(a); });
+        measure("matrix_lu_unblocked", n, [&]() { Diamond::LUFactors<double> f = Diamond::LUDecompose(a, n); });
+        measure("matrix_inverse", n, [&]() { Diamond::Matrix<double> c = Diamond::Inverse(a); });
+    }
+    for (size_t n = 2; n <= maxSize / 4; n *= 2) {
+        Diamond::Matrix<Util::Bint> a(n, n), b(n, n);
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; ++j) {
+                a[i][j] = Util::Bint(randomDigits(8));
+                b[i][j] = Util::Bint(randomDigits(8));
+            }
+        measure("matrix_bint_mul", n, [&]() { Diamond::Matrix<Util::Bint> c = a * b; });
+        // Bareiss cells grow to n times the digits of a, so its cost runs away fast
+        if (n <= 32)
+            measure("matrix_bint_det", n, [&]() { Util::Bint d = Diamond::Det(a); });
+    }
+}
+
+int main(int argc, char *argv[]) {
+    size_t maxLimbs = argc > 1 ? strtoul(argv[1], nullptr, 10) : 4096;
+    size_t maxSize = argc > 2 ? strtoul(argv[2], nullptr, 10) : 256;
+    srand(20220207);
+    printf("kernel,size,reps,ns_per_op\n");
+    benchBint(maxLimbs);
+    benchMatrix(maxSize);
+    return 0;
+}
@@ -0,0 +1,72 @@
+// Lookups in a large sorted array of integer keys.
+// Usage: search_bench [n] [lookups]
+// Prints CSV lines data,method,n,ns_per_lookup for sjtu::lower_bound,
+// interpolation search and learned_index (with two error bounds) on evenly
+// spread, smoothly skewed and clustered keys.
+
+#include "algorithm.hpp"
+#include "learned_index.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+template<typename Work>
+void measure(const char *data, const char *method, size_t n, size_t lookups, Work work) {
+    auto start = std::chrono::steady_clock::now();
+    size_t checksum = work();
+    std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+    printf("%s,%s,%zu,%.1f\n", data, method, n, double(elapsed.count()) / lookups);
+    fflush(stdout);
+    if (checksum == size_t(-1))
+        printf("unreachable\n");
+}
+
+void run(const char *name, std::vector<long long> keys, size_t lookups) {
+    sjtu::sort<long long>(keys.data(), keys.data() + keys.size(), [](const long long &a, const long long &b) { return a < b; });
+    const long long *b = keys.data(), *e = keys.data() + keys.size();
+    std::vector<long long> queries;
+    for (size_t i = 0; i < lookups; ++i)
+        queries.push_back(rand() % 2 ? keys[rand() % keys.size()] : keys[rand() % keys.size()] + 1);
+    size_t n = keys.size();
+    measure(name, "binary", n, lookups, [&]() {
+        size_t sum = 0;
+        for (long long q : queries)
+            sum += sjtu::lower_bound(b, e, q) - b;
+        return sum;
+    });
+    measure(name, "interpolation", n, lookups, [&]() {
+        size_t sum = 0;
+        for (long long q : queries)
+            sum += sjtu::interpolation_lower_bound(b, e, q) - b;
+        return sum;
+    });
+    for (size_t error : {8, 64}) {
+        sjtu::learned_index<long long> index(b, e, error);
+        measure(name, error == 8 ? "learned_8" : "learned_64", n, lookups, [&]() {
+            size_t sum = 0;
+            for (long long q : queries)
+                sum += index.lower_bound(q) - b;
+            return sum;
+        });
+    }
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? strtoul(argv[1], nullptr, 10) : 10000000;
+    size_t lookups = argc > 2 ? strtoul(argv[2], nullptr, 10) : 1000000;
+    printf("data,method,n,ns_per_lookup\n");
+    std::vector<long long> uniform, skewed, clustered;
+    for (size_t i = 0; i < n; ++i) {
+        long long r = (long long)rand() << 20 ^ rand();
+        uniform.push_back(r);
+        skewed.push_back((long long)(std::exp(double(rand()) / RAND_MAX * 30)));
+        clustered.push_back((long long)(rand() % 100) * 1000000000LL + rand() % 1000);
+    }
+    run("uniform", uniform, lookups);
+    run("skewed", skewed, lookups);
+    run("clustered", clustered, lookups);
+    return 0;
+}
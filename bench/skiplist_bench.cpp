@@ -0,0 +1,108 @@
+// Throughput of a shared ordered map under read/write mixes.
+// Usage: skiplist_bench [max_threads] [ops_per_thread] [key_range]
+// Half of the keys are inserted up front; every thread then runs a mix of
+// find, insert and erase on random keys. Prints CSV lines
+// variant,mix,threads,ops,ns_per_op,mops for sjtu::map behind a mutex and
+// the lock-free sjtu::concurrent_skiplist, for 1, 2, 4, ... max_threads.
+
+#include "concurrent_skiplist.hpp"
+#include "map.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class MutexMap {
+    std::mutex lock;
+    sjtu::map<int, int> items;
+public:
+    bool insert(int key, int value) {
+        std::lock_guard<std::mutex> guard(lock);
+        return items.insert(sjtu::map<int, int>::value_type(key, value)).second;
+    }
+    bool erase(int key) {
+        std::lock_guard<std::mutex> guard(lock);
+        return items.erase(key) != 0;
+    }
+    bool contains(int key) {
+        std::lock_guard<std::mutex> guard(lock);
+        return items.count(key) != 0;
+    }
+};
+
+class SkiplistMap {
+    sjtu::concurrent_skiplist<int, int> items;
+public:
+    bool insert(int key, int value) {
+        return items.insert(key, value);
+    }
+    bool erase(int key) {
+        return items.erase(key);
+    }
+    bool contains(int key) {
+        return items.count(key) != 0;
+    }
+};
+
+struct Mix {
+    const char *name;
+    unsigned reads;  // percent of finds, the rest split between insert and erase
+};
+
+template<class Map>
+void run(const char *variant, const Mix &mix, size_t threads, size_t ops, unsigned range) {
+    Map shared;
+    for (unsigned k = 0; k < range; k += 2)
+        shared.insert(int(k), int(k));
+    std::vector<std::thread> pool;
+    std::vector<size_t> hits(threads);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t]() {
+            unsigned long long state = 0x9E3779B97F4A7C15ULL * (t + 1);
+            size_t found = 0;
+            for (size_t i = 0; i < ops; ++i) {
+                state ^= state << 13, state ^= state >> 7, state ^= state << 17;
+                int key = int(state % range);
+                unsigned roll = unsigned(state >> 40) % 100;
+                if (roll < mix.reads)
+                    found += shared.contains(key);
+                else if (roll % 2)
+                    found += shared.insert(key, key);
+                else
+                    found += shared.erase(key);
+            }
+            hits[t] = found;
+        });
+    }
+    for (size_t t = 0; t < threads; ++t)
+        pool[t].join();
+    std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+    double total = double(threads * ops);
+    printf("%s,%s,%zu,%zu,%.1f,%.2f\n", variant, mix.name, threads, threads * ops,
+           double(elapsed.count()) / total, total * 1e3 / double(elapsed.count()));
+    fflush(stdout);
+    size_t checksum = 0;
+    for (size_t t = 0; t < threads; ++t)
+        checksum += hits[t];
+    if (checksum == size_t(-1))
+        printf("unreachable\n");
+}
+
+int main(int argc, char *argv[]) {
+    size_t maxThreads = argc > 1 ? strtoul(argv[1], nullptr, 10) : 64;
+    size_t ops = argc > 2 ? strtoul(argv[2], nullptr, 10) : 200000;
+    unsigned range = argc > 3 ? unsigned(strtoul(argv[3], nullptr, 10)) : 100000;
+    const Mix mixes[] = {{"read90", 90}, {"read50", 50}, {"read10", 10}};
+    printf("variant,mix,threads,ops,ns_per_op,mops\n");
+    for (const Mix &mix : mixes) {
+        for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+            run<MutexMap>("mutex_map", mix, threads, ops, range);
+            run<SkiplistMap>("skiplist", mix, threads, ops, range);
+        }
+    }
+    return 0;
+}
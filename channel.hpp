@@ -0,0 +1,423 @@
+#ifndef SJTU_CHANNEL_HPP
+#define SJTU_CHANNEL_HPP
+
+#include "exceptions.hpp"
+
+#if !defined(__cpp_impl_coroutine)
+#error "channel.hpp needs C++20 coroutines"
+#endif
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <optional>
+#include <utility>
+
+namespace sjtu {
+
+class executor;
+
+/**
+ * a coroutine started and resumed by an executor
+ * it starts suspended; executor::spawn() takes it over
+ */
+class task {
+public:
+    struct promise_type {
+        executor *owner = nullptr;
+        promise_type *prev = nullptr;
+        promise_type *next = nullptr;
+        std::exception_ptr error;
+
+        task get_return_object() {
+            return task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception() {
+            error = std::current_exception();
+        }
+    };
+    typedef std::coroutine_handle<promise_type> handle_type;
+
+    task(task &&other) noexcept : handle(other.handle) {
+        other.handle = nullptr;
+    }
+    task(const task &) = delete;
+    task &operator=(const task &) = delete;
+    ~task() {
+        if (handle) handle.destroy();
+    }
+
+private:
+    friend class executor;
+    explicit task(handle_type h) : handle(h) {}
+
+    handle_type handle;
+};
+
+/**
+ * runs tasks on the calling thread
+ * a task that waits is parked where it waits (e.g. in a channel) and put back
+ * in the ready queue by whoever lets it go on, so resuming it is a function call,
+ * never a system call.
+ */
+class executor {
+protected:
+    /**
+     * the tasks not finished yet, linked through their promises
+     */
+    task::promise_type live;
+    size_t live_count;
+    /**
+     * the ready queue, a ring buffer that doubles when full
+     */
+    task::handle_type *ready;
+    size_t ready_head;
+    size_t ready_count;
+    size_t ready_capacity;
+
+    void finish(task::handle_type h) {
+        task::promise_type &p = h.promise();
+        p.prev->next = p.next;
+        p.next->prev = p.prev;
+        live_count--;
+        std::exception_ptr error = p.error;
+        h.destroy();
+        if (error) std::rethrow_exception(error);
+    }
+
+public:
+    executor() : live_count(0), ready(nullptr), ready_head(0), ready_count(0), ready_capacity(0) {
+        live.prev = live.next = &live;
+    }
+    executor(const executor &) = delete;
+    executor &operator=(const executor &) = delete;
+    /**
+     * destroys the tasks that never finished, e.g. ones still waiting on a channel
+     */
+    ~executor() {
+        while (live.next != &live) {
+            task::promise_type *p = live.next;
+            p->prev->next = p->next;
+            p->next->prev = p->prev;
+            task::handle_type::from_promise(*p).destroy();
+        }
+        delete [] ready;
+    }
+
+    /**
+     * take over t and queue it to start
+     */
+    void spawn(task t) {
+        task::handle_type h = t.handle;
+        schedule(h);
+        t.handle = nullptr;
+        task::promise_type &p = h.promise();
+        p.owner = this;
+        p.prev = live.prev;
+        p.next = &live;
+        live.prev->next = &p;
+        live.prev = &p;
+        live_count++;
+    }
+    /**
+     * queue h to be resumed
+     */
+    void schedule(task::handle_type h) {
+        if (ready_count == ready_capacity) {
+            size_t capacity = ready_capacity == 0 ? 16 : ready_capacity * 2;
+            task::handle_type *grown = new task::handle_type[capacity];
+            for (size_t i = 0; i < ready_count; ++i) {
+                grown[i] = ready[(ready_head + i) % ready_capacity];
+            }
+            delete [] ready;
+            ready = grown;
+            ready_head = 0;
+            ready_capacity = capacity;
+        }
+        ready[(ready_head + ready_count) % ready_capacity] = h;
+        ready_count++;
+    }
+    /**
+     * resume ready tasks until none is ready
+     * a finished task is destroyed at once; if it threw, run() rethrows the exception
+     * and can be called again to go on with the others
+     */
+    void run() {
+        while (ready_count > 0) {
+            task::handle_type h = ready[ready_head];
+            ready_head = (ready_head + 1) % ready_capacity;
+            ready_count--;
+            h.resume();
+            if (h.done()) finish(h);
+        }
+    }
+    /**
+     * the tasks started and not finished; after run() they all wait for something
+     */
+    size_t pending() const {
+        return live_count;
+    }
+};
+
+/**
+ * a bounded FIFO channel between tasks of one executor
+ * co_await send(x) suspends while the channel is full, co_await recv() while it is
+ * empty; a waiting receiver gets a sent value directly, and a capacity of 0 makes
+ * every send a hand-over to a receiver.
+ * the buffered values live in nodes from a pool of capacity nodes allocated with
+ * the channel and recycled through a free list, and the waiting tasks are linked
+ * through their awaiters, so passing values allocates nothing.
+ * after close(), sends fail and recv() drains the buffer, then yields nothing.
+ */
+template<typename T>
+class channel {
+protected:
+    struct node {
+        node *next;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T *item() {
+            return std::launder(reinterpret_cast<T *>(storage));
+        }
+    };
+
+public:
+    class send_awaiter;
+    class recv_awaiter;
+
+protected:
+    /**
+     * a FIFO of waiting awaiters, linked through their next
+     */
+    template<class W>
+    struct waiters {
+        W *first = nullptr;
+        W *last = nullptr;
+
+        bool empty() const {
+            return first == nullptr;
+        }
+        void push(W *w) {
+            w->next = nullptr;
+            if (last == nullptr) first = w;
+            else last->next = w;
+            last = w;
+        }
+        W *pop() {
+            W *w = first;
+            first = w->next;
+            if (first == nullptr) last = nullptr;
+            return w;
+        }
+    };
+
+    executor *ex;
+    node *pool;
+    node *free_nodes;
+    node *first;
+    node *last;
+    size_t count;
+    size_t cap;
+    bool closed;
+    waiters<send_awaiter> senders;
+    waiters<recv_awaiter> receivers;
+
+    void push_value(T &&value) {
+        node *n = free_nodes;
+        new(n->storage) T(std::move(value));
+        free_nodes = n->next;
+        n->next = nullptr;
+        if (last == nullptr) first = n;
+        else last->next = n;
+        last = n;
+        count++;
+    }
+    void pop_value(std::optional<T> &into) {
+        node *n = first;
+        into.emplace(std::move(*n->item()));
+        n->item()->~T();
+        first = n->next;
+        if (first == nullptr) last = nullptr;
+        n->next = free_nodes;
+        free_nodes = n;
+        count--;
+    }
+    /**
+     * complete a send of value if it need not wait
+     */
+    bool offer(send_awaiter &s) {
+        if (closed) {
+            s.sent = false;
+            return true;
+        }
+        if (!receivers.empty()) {
+            recv_awaiter *r = receivers.pop();
+            r->result.emplace(std::move(s.value));
+            ex->schedule(r->handle);
+        } else if (count < cap) {
+            push_value(std::move(s.value));
+        } else {
+            return false;
+        }
+        s.sent = true;
+        return true;
+    }
+    /**
+     * complete a receive if it need not wait
+     */
+    bool take(recv_awaiter &r) {
+        if (count > 0) {
+            pop_value(r.result);
+            if (!senders.empty()) {
+                // the freed node takes the value of the first waiting sender
+                send_awaiter *s = senders.pop();
+                push_value(std::move(s->value));
+                s->sent = true;
+                ex->schedule(s->handle);
+            }
+        } else if (!senders.empty()) {
+            send_awaiter *s = senders.pop();
+            r.result.emplace(std::move(s->value));
+            s->sent = true;
+            ex->schedule(s->handle);
+        } else if (!closed) {
+            return false;
+        }
+        return true;
+    }
+
+public:
+    class send_awaiter {
+        friend class channel;
+
+    protected:
+        channel *ch;
+        T value;
+        bool sent;
+        send_awaiter *next;
+        task::handle_type handle;
+
+    public:
+        send_awaiter(channel *c, T &&v) : ch(c), value(std::move(v)), sent(false), next(nullptr) {}
+
+        bool await_ready() {
+            return ch->offer(*this);
+        }
+        void await_suspend(task::handle_type h) {
+            handle = h;
+            ch->senders.push(this);
+        }
+        /**
+         * whether the value went into the channel (false once it is closed)
+         */
+        bool await_resume() {
+            return sent;
+        }
+    };
+    class recv_awaiter {
+        friend class channel;
+
+    protected:
+        channel *ch;
+        std::optional<T> result;
+        recv_awaiter *next;
+        task::handle_type handle;
+
+    public:
+        explicit recv_awaiter(channel *c) : ch(c), next(nullptr) {}
+
+        bool await_ready() {
+            return ch->take(*this);
+        }
+        void await_suspend(task::handle_type h) {
+            handle = h;
+            ch->receivers.push(this);
+        }
+        /**
+         * the value received, nothing once the channel is closed and drained
+         */
+        std::optional<T> await_resume() {
+            return std::move(result);
+        }
+    };
+
+    channel(executor &e, size_t capacity)
+            : ex(&e), pool(nullptr), free_nodes(nullptr), first(nullptr), last(nullptr),
+              count(0), cap(capacity), closed(false) {
+        if (cap > 0) {
+            pool = new node[cap];
+            for (size_t i = 0; i < cap; ++i) {
+                pool[i].next = i + 1 < cap ? &pool[i + 1] : nullptr;
+            }
+            free_nodes = pool;
+        }
+    }
+    channel(const channel &) = delete;
+    channel &operator=(const channel &) = delete;
+    /**
+     * tasks still waiting on the channel must not be resumed afterwards
+     */
+    ~channel() {
+        for (node *n = first; n != nullptr; n = n->next) {
+            n->item()->~T();
+        }
+        delete [] pool;
+    }
+
+    send_awaiter send(T value) {
+        return send_awaiter(this, std::move(value));
+    }
+    recv_awaiter recv() {
+        return recv_awaiter(this);
+    }
+    /**
+     * send and receive without waiting, e.g. from outside a task
+     * return whether a value was sent / received
+     */
+    bool try_send(T value) {
+        send_awaiter s(this, std::move(value));
+        return offer(s) && s.sent;
+    }
+    bool try_recv(T &value) {
+        recv_awaiter r(this);
+        if (!take(r) || !r.result) return false;
+        value = std::move(*r.result);
+        return true;
+    }
+    /**
+     * wake every waiting task: senders fail, receivers get nothing
+     * (receivers only wait on an empty buffer)
+     */
+    void close() {
+        closed = true;
+        while (!senders.empty()) {
+            send_awaiter *s = senders.pop();
+            s->sent = false;
+            ex->schedule(s->handle);
+        }
+        while (!receivers.empty()) {
+            ex->schedule(receivers.pop()->handle);
+        }
+    }
+    bool is_closed() const {
+        return closed;
+    }
+    size_t size() const {
+        return count;
+    }
+    size_t capacity() const {
+        return cap;
+    }
+};
+
+}
+
+#endif //SJTU_CHANNEL_HPP
@@ -0,0 +1,214 @@
+#ifndef SJTU_COMBINING_LIST_HPP
+#define SJTU_COMBINING_LIST_HPP
+
+#include "list.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <thread>
+
+namespace sjtu {
+
+/**
+ * a list shared between threads by flat combining
+ * a thread publishes its operation in a slot and then either waits for it
+ * to be done or, if the combiner lock is free, takes it and applies every
+ * published operation in one pass, so the list stays in one cache while a
+ * whole batch is applied and the lock is taken once per batch.
+ */
+template<typename T>
+class combining_list {
+protected:
+    enum operation {
+        op_push_back, op_push_front, op_pop_back, op_pop_front, op_apply
+    };
+    enum slot_state {
+        slot_idle, slot_pending, slot_done
+    };
+    /**
+     * one publication record, on a cache line of its own
+     */
+    struct alignas(64) slot {
+        std::atomic<bool> owned;
+        std::atomic<int> state;
+        operation op;
+        const T *in;
+        T *out;
+        bool found;
+        void (*call)(list<T> &, void *);
+        void *context;
+        std::exception_ptr error;
+
+        slot() : owned(false), state(slot_idle), op(op_push_back), in(nullptr), out(nullptr),
+                 found(false), call(nullptr), context(nullptr) {}
+    };
+    /**
+     * more threads than slots share them, probing from their home slot
+     */
+    static const size_t slot_count = 64;
+    /**
+     * rounds over the slots a combiner makes before it lets go of the lock
+     */
+    static const size_t combine_rounds = 3;
+
+    list<T> items;
+    slot slots[slot_count];
+    alignas(64) std::atomic<bool> combining;
+
+    static size_t home_slot() {
+        static std::atomic<size_t> threads(0);
+        thread_local size_t id = threads.fetch_add(1, std::memory_order_relaxed);
+        return id % slot_count;
+    }
+    slot *acquire_slot() {
+        size_t i = home_slot();
+        while (true) {
+            for (size_t k = 0; k < slot_count; ++k) {
+                slot *s = &slots[(i + k) % slot_count];
+                bool expected = false;
+                if (!s->owned.load(std::memory_order_relaxed)
+                    && s->owned.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                    return s;
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+    void apply_slot(slot *s) {
+        try {
+            switch (s->op) {
+                case op_push_back:
+                    items.push_back(*s->in);
+                    break;
+                case op_push_front:
+                    items.push_front(*s->in);
+                    break;
+                case op_pop_back:
+                    s->found = !items.empty();
+                    if (s->found) {
+                        *s->out = items.back();
+                        items.pop_back();
+                    }
+                    break;
+                case op_pop_front:
+                    s->found = !items.empty();
+                    if (s->found) {
+                        *s->out = items.front();
+                        items.pop_front();
+                    }
+                    break;
+                case op_apply:
+                    s->call(items, s->context);
+                    break;
+            }
+        } catch (...) {
+            s->error = std::current_exception();
+        }
+        s->state.store(slot_done, std::memory_order_release);
+    }
+    void combine() {
+        for (size_t round = 0; round < combine_rounds; ++round) {
+            bool any = false;
+            for (size_t i = 0; i < slot_count; ++i) {
+                if (slots[i].state.load(std::memory_order_acquire) == slot_pending) {
+                    apply_slot(&slots[i]);
+                    any = true;
+                }
+            }
+            if (!any) break;
+        }
+    }
+    /**
+     * publishes the operation in s and returns once it has been applied
+     * returns found of the slot, rethrows what the operation threw
+     */
+    bool run(slot *s) {
+        s->error = nullptr;
+        s->found = false;
+        s->state.store(slot_pending, std::memory_order_release);
+        while (s->state.load(std::memory_order_acquire) != slot_done) {
+            if (!combining.load(std::memory_order_relaxed)
+                && !combining.exchange(true, std::memory_order_acquire)) {
+                combine();
+                combining.store(false, std::memory_order_release);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        bool found = s->found;
+        std::exception_ptr error = s->error;
+        s->error = nullptr;
+        s->state.store(slot_idle, std::memory_order_relaxed);
+        s->owned.store(false, std::memory_order_release);
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return found;
+    }
+    bool run_value(operation op, const T &value) {
+        slot *s = acquire_slot();
+        s->op = op;
+        s->in = &value;
+        return run(s);
+    }
+    bool run_pop(operation op, T &value) {
+        slot *s = acquire_slot();
+        s->op = op;
+        s->out = &value;
+        return run(s);
+    }
+    template<class F>
+    static void call_with(list<T> &items, void *context) {
+        (*static_cast<F *>(context))(items);
+    }
+
+public:
+    combining_list() : combining(false) {}
+    combining_list(const combining_list &) = delete;
+    combining_list &operator=(const combining_list &) = delete;
+
+    void push_back(const T &value) {
+        run_value(op_push_back, value);
+    }
+    void push_front(const T &value) {
+        run_value(op_push_front, value);
+    }
+    /**
+     * copies the last / first element into value and removes it
+     * return false, leaving value alone, when the list is empty
+     */
+    bool pop_back(T &value) {
+        return run_pop(op_pop_back, value);
+    }
+    bool pop_front(T &value) {
+        return run_pop(op_pop_front, value);
+    }
+    /**
+     * runs f(list) with no other operation on the list in between,
+     * e.g. an insert at a position found by walking the list
+     */
+    template<class F>
+    void apply(F f) {
+        slot *s = acquire_slot();
+        s->op = op_apply;
+        s->call = call_with<F>;
+        s->context = &f;
+        run(s);
+    }
+    size_t size() {
+        size_t n = 0;
+        apply([&n](list<T> &items) { n = items.size(); });
+        return n;
+    }
+    /**
+     * the list itself, only while no thread uses the wrapper
+     */
+    list<T> &unsafe_list() {
+        return items;
+    }
+};
+
+}
+
+#endif //SJTU_COMBINING_LIST_HPP
@@ -0,0 +1,549 @@
+#ifndef SJTU_CONCURRENT_SKIPLIST_HPP
+#define SJTU_CONCURRENT_SKIPLIST_HPP
+
+#include "exceptions.hpp"
+#include "utility.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <thread>
+
+namespace sjtu {
+
+/**
+ * an ordered map shared between threads, as a lock-free skip list
+ * every level is a singly-linked list whose links are changed with compare-and-swap;
+ * erase() marks the links of a node (the low bit of the pointer) from the top down,
+ * the mark on level 0 deciding the erase, and whoever walks past a marked node
+ * unlinks it. lookups and scans only read and never retry.
+ * unlinked nodes are freed by epoch-based reclamation: every operation announces
+ * the global epoch while it runs, and a node retired in epoch e may be freed once the
+ * epoch has reached e + 2, when no running operation can still see it.
+ * keys are compared with operator<; the elements are immutable once inserted.
+ */
+template<class Key, class T>
+class concurrent_skiplist {
+public:
+    typedef pair<const Key, T> value_type;
+    class const_iterator;
+    /**
+     * the elements cannot be modified in place
+     */
+    typedef const_iterator iterator;
+
+protected:
+    /**
+     * a node gets each further level with probability 1 / 4
+     */
+    static const size_t max_level = 24;
+    /**
+     * more threads than records in one operation at a time wait for a free one
+     */
+    static const size_t record_count = 128;
+    /**
+     * a record tries to advance the epoch every this many retires
+     */
+    static const size_t retire_batch = 64;
+    static const size_t idle = size_t(-1);
+
+    /**
+     * the links of a node follow it in the same allocation, height of them
+     * finished counts the insert and the erase that are done with the node,
+     * the second one retires it
+     */
+    struct node {
+        value_type item;
+        size_t height;
+        std::atomic<int> finished;
+        node *retired_next;
+
+        node(const Key &key, const T &value, size_t h)
+                : item(key, value), height(h), finished(0), retired_next(nullptr) {}
+    };
+    /**
+     * the epoch announced by an operation (idle between operations) and the
+     * nodes retired through the record, in one bag per epoch modulo 3:
+     * bag i holds nodes retired in epoch bag_epoch[i]
+     */
+    struct alignas(64) record {
+        std::atomic<bool> owned;
+        std::atomic<size_t> epoch;
+        node *bags[3];
+        size_t bag_epoch[3];
+        size_t retires;
+
+        record() : owned(false), epoch(idle), bags(), bag_epoch(), retires(0) {}
+    };
+    /**
+     * holds a record for the length of one operation
+     */
+    class epoch_guard {
+    public:
+        concurrent_skiplist *owner;
+        record *r;
+
+        explicit epoch_guard(const concurrent_skiplist *list) : owner(const_cast<concurrent_skiplist *>(list)) {
+            r = owner->pin();
+        }
+        ~epoch_guard() {
+            owner->unpin(r);
+        }
+        epoch_guard(const epoch_guard &) = delete;
+        epoch_guard &operator=(const epoch_guard &) = delete;
+    };
+
+    node *head;
+    record records[record_count];
+    alignas(64) std::atomic<size_t> global_epoch;
+    alignas(64) std::atomic<size_t> element_count;
+
+    static std::atomic<node *> *links(node *n) {
+        return reinterpret_cast<std::atomic<node *> *>(reinterpret_cast<char *>(n) + sizeof(node));
+    }
+    static bool marked(node *p) {
+        return reinterpret_cast<uintptr_t>(p) & 1;
+    }
+    static node *with_mark(node *p) {
+        return reinterpret_cast<node *>(reinterpret_cast<uintptr_t>(p) | 1);
+    }
+    static node *without_mark(node *p) {
+        return reinterpret_cast<node *>(reinterpret_cast<uintptr_t>(p) & ~uintptr_t(1));
+    }
+
+    static node *make_node(const Key &key, const T &value, size_t height) {
+        void *block = ::operator new(sizeof(node) + height * sizeof(std::atomic<node *>));
+        node *n;
+        try {
+            n = new(block) node(key, value, height);
+        } catch (...) {
+            ::operator delete(block);
+            throw;
+        }
+        for (size_t l = 0; l < height; ++l) {
+            new(links(n) + l) std::atomic<node *>(nullptr);
+        }
+        return n;
+    }
+    static void free_node(node *n) {
+        n->~node();
+        ::operator delete(n);
+    }
+    static size_t random_height() {
+        thread_local unsigned long long state = 0;
+        if (state == 0) {
+            state = (unsigned long long)reinterpret_cast<uintptr_t>(&state) * 0x9E3779B97F4A7C15ULL | 1;
+        }
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        unsigned long long bits = state;
+        size_t height = 1;
+        while (height < max_level && (bits & 3) == 0) {
+            height++;
+            bits >>= 2;
+        }
+        return height;
+    }
+
+    static size_t home_record() {
+        static std::atomic<size_t> threads(0);
+        thread_local size_t id = threads.fetch_add(1, std::memory_order_relaxed);
+        return id % record_count;
+    }
+    record *pin() {
+        size_t i = home_record();
+        record *r = nullptr;
+        while (r == nullptr) {
+            for (size_t k = 0; k < record_count && r == nullptr; ++k) {
+                record *candidate = &records[(i + k) % record_count];
+                bool expected = false;
+                if (!candidate->owned.load(std::memory_order_relaxed)
+                    && candidate->owned.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                    r = candidate;
+                }
+            }
+            if (r == nullptr) std::this_thread::yield();
+        }
+        // the announcement must not lag behind the epoch it was read in
+        size_t e = global_epoch.load();
+        while (true) {
+            r->epoch.store(e);
+            size_t now = global_epoch.load();
+            if (now == e) break;
+            e = now;
+        }
+        return r;
+    }
+    void unpin(record *r) {
+        r->epoch.store(idle, std::memory_order_release);
+        r->owned.store(false, std::memory_order_release);
+    }
+    /**
+     * the epoch moves on once every running operation has announced it
+     */
+    void try_advance() {
+        size_t e = global_epoch.load();
+        for (size_t i = 0; i < record_count; ++i) {
+            size_t announced = records[i].epoch.load();
+            if (announced != idle && announced != e) return;
+        }
+        global_epoch.compare_exchange_strong(e, e + 1);
+    }
+    static void free_bag(node *n) {
+        while (n != nullptr) {
+            node *next = n->retired_next;
+            free_node(n);
+            n = next;
+        }
+    }
+    /**
+     * a bag of an older epoch in the slot of epoch e is at least three epochs old,
+     * so it is freed before the slot takes nodes of e
+     */
+    void retire(record *r, node *n) {
+        size_t e = global_epoch.load();
+        size_t slot = e % 3;
+        if (r->bag_epoch[slot] != e) {
+            free_bag(r->bags[slot]);
+            r->bags[slot] = nullptr;
+            r->bag_epoch[slot] = e;
+        }
+        n->retired_next = r->bags[slot];
+        r->bags[slot] = n;
+        if (++r->retires >= retire_batch) {
+            r->retires = 0;
+            try_advance();
+        }
+    }
+    /**
+     * the insert or the erase of n is done with it
+     */
+    void release(record *r, node *n) {
+        if (n->finished.fetch_add(1, std::memory_order_acq_rel) == 1) {
+            retire(r, n);
+        }
+    }
+
+    /**
+     * fill preds and succs with the last node before key and the first node not
+     * before it on every level, unlinking the marked nodes met on the way
+     * return whether succs[0] is a node of key
+     */
+    bool locate(const Key &key, node **preds, node **succs) {
+        bool restart = true;
+        while (restart) {
+            restart = false;
+            node *pred = head;
+            for (size_t l = max_level; l-- > 0 && !restart;) {
+                node *curr = without_mark(links(pred)[l].load(std::memory_order_acquire));
+                while (curr != nullptr) {
+                    node *succ = links(curr)[l].load(std::memory_order_acquire);
+                    if (marked(succ)) {
+                        node *expected = curr;
+                        if (!links(pred)[l].compare_exchange_strong(expected, without_mark(succ), std::memory_order_acq_rel)) {
+                            // pred was erased or changed meanwhile
+                            restart = true;
+                            break;
+                        }
+                        curr = without_mark(succ);
+                    } else if (curr->item.first < key) {
+                        pred = curr;
+                        curr = succ;
+                    } else {
+                        break;
+                    }
+                }
+                preds[l] = pred;
+                succs[l] = curr;
+            }
+        }
+        return succs[0] != nullptr && !(key < succs[0]->item.first);
+    }
+    /**
+     * the first live node with a key not before key (after key if strict), or nullptr
+     * only reads: marked nodes are stepped over, not unlinked
+     */
+    node *search(const Key &key, bool strict) const {
+        node *pred = head, *curr = nullptr;
+        for (size_t l = max_level; l-- > 0;) {
+            curr = without_mark(links(pred)[l].load(std::memory_order_acquire));
+            while (curr != nullptr) {
+                node *succ = links(curr)[l].load(std::memory_order_acquire);
+                while (marked(succ)) {
+                    curr = without_mark(succ);
+                    if (curr == nullptr) break;
+                    succ = links(curr)[l].load(std::memory_order_acquire);
+                }
+                if (curr == nullptr) break;
+                if (strict ? !(key < curr->item.first) : curr->item.first < key) {
+                    pred = curr;
+                    curr = succ;
+                } else {
+                    break;
+                }
+            }
+        }
+        return curr;
+    }
+    /**
+     * the first live node from n on at level 0, or nullptr
+     */
+    static node *live_from(node *n) {
+        while (n != nullptr) {
+            node *succ = links(n)[0].load(std::memory_order_acquire);
+            if (!marked(succ)) return n;
+            n = without_mark(succ);
+        }
+        return nullptr;
+    }
+    /**
+     * link fresh above level 0, bottom up, until it is done or erased
+     */
+    void link_upper(node *fresh, const Key &key, node **preds, node **succs) {
+        for (size_t l = 1; l < fresh->height; ++l) {
+            while (true) {
+                node *own = links(fresh)[l].load(std::memory_order_acquire);
+                if (marked(own)) return;
+                // only erase() changes the link once it is set, by marking it
+                if (own != succs[l] && !links(fresh)[l].compare_exchange_strong(own, succs[l], std::memory_order_acq_rel)) {
+                    return;
+                }
+                node *expected = succs[l];
+                if (links(preds[l])[l].compare_exchange_strong(expected, fresh, std::memory_order_acq_rel)) break;
+                locate(key, preds, succs);
+                if (succs[0] != fresh) return;
+            }
+        }
+    }
+    value_type *copy_of(node *n) const {
+        return n == nullptr ? nullptr : new value_type(n->item);
+    }
+
+public:
+    /**
+     * weakly consistent: holds a copy of the element it points to and moves on
+     * with a search for the next key, so it never sees an element twice, sees
+     * every element present for the whole traversal and maybe some of the ones
+     * inserted or erased during it
+     */
+    class const_iterator {
+        friend class concurrent_skiplist;
+
+    protected:
+        const concurrent_skiplist *owner;
+        value_type *item;  // nullptr at end()
+
+        const_iterator(const concurrent_skiplist *o, value_type *i) : owner(o), item(i) {}
+
+    public:
+        const_iterator() : owner(nullptr), item(nullptr) {}
+        const_iterator(const const_iterator &other)
+                : owner(other.owner), item(other.item == nullptr ? nullptr : new value_type(*other.item)) {}
+        const_iterator &operator=(const const_iterator &other) {
+            if (this == &other) return *this;
+            value_type *copy = other.item == nullptr ? nullptr : new value_type(*other.item);
+            delete item;
+            item = copy;
+            owner = other.owner;
+            return *this;
+        }
+        ~const_iterator() {
+            delete item;
+        }
+        /**
+         * throw invalid_iterator at end()
+         */
+        const_iterator operator++(int) {
+            const_iterator old(*this);
+            ++*this;
+            return old;
+        }
+        const_iterator &operator++() {
+            if (owner == nullptr || item == nullptr) throw invalid_iterator();
+            value_type *next;
+            {
+                epoch_guard guard(owner);
+                next = owner->copy_of(owner->search(item->first, true));
+            }
+            delete item;
+            item = next;
+            return *this;
+        }
+        const value_type &operator*() const {
+            if (item == nullptr) throw invalid_iterator();
+            return *item;
+        }
+        const value_type *operator->() const {
+            if (item == nullptr) throw invalid_iterator();
+            return item;
+        }
+        /**
+         * two iterators are equal at the same key of the same map, or both at end()
+         */
+        bool operator==(const const_iterator &rhs) const {
+            if (owner != rhs.owner || (item == nullptr) != (rhs.item == nullptr)) return false;
+            return item == nullptr || (!(item->first < rhs.item->first) && !(rhs.item->first < item->first));
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return !(*this == rhs);
+        }
+    };
+
+    concurrent_skiplist() : global_epoch(0), element_count(0) {
+        // the head only has links, its element is never constructed
+        head = static_cast<node *>(::operator new(sizeof(node) + max_level * sizeof(std::atomic<node *>)));
+        for (size_t l = 0; l < max_level; ++l) {
+            new(links(head) + l) std::atomic<node *>(nullptr);
+        }
+    }
+    concurrent_skiplist(const concurrent_skiplist &) = delete;
+    concurrent_skiplist &operator=(const concurrent_skiplist &) = delete;
+    /**
+     * no other thread may use the map any more
+     */
+    ~concurrent_skiplist() {
+        node *cur = without_mark(links(head)[0].load());
+        while (cur != nullptr) {
+            node *next = without_mark(links(cur)[0].load());
+            free_node(cur);
+            cur = next;
+        }
+        for (size_t i = 0; i < record_count; ++i) {
+            for (size_t slot = 0; slot < 3; ++slot) {
+                free_bag(records[i].bags[slot]);
+            }
+        }
+        ::operator delete(head);
+    }
+
+    /**
+     * insert (key, value) unless key is present
+     * return whether it was inserted
+     */
+    bool insert(const Key &key, const T &value) {
+        epoch_guard guard(this);
+        node *preds[max_level], *succs[max_level];
+        node *fresh = nullptr;
+        while (true) {
+            if (locate(key, preds, succs)) {
+                if (fresh != nullptr) free_node(fresh);
+                return false;
+            }
+            if (fresh == nullptr) {
+                fresh = make_node(key, value, random_height());
+            }
+            for (size_t l = 0; l < fresh->height; ++l) {
+                links(fresh)[l].store(succs[l], std::memory_order_relaxed);
+            }
+            node *expected = succs[0];
+            if (links(preds[0])[0].compare_exchange_strong(expected, fresh, std::memory_order_acq_rel)) break;
+        }
+        element_count.fetch_add(1, std::memory_order_relaxed);
+        link_upper(fresh, key, preds, succs);
+        if (marked(links(fresh)[0].load(std::memory_order_acquire))) {
+            // erased while being linked: unlink the levels linked after the erase looked
+            locate(key, preds, succs);
+        }
+        release(guard.r, fresh);
+        return true;
+    }
+    bool insert(const value_type &value) {
+        return insert(value.first, value.second);
+    }
+    /**
+     * remove the element of key
+     * return whether there was one
+     */
+    bool erase(const Key &key) {
+        epoch_guard guard(this);
+        node *preds[max_level], *succs[max_level];
+        if (!locate(key, preds, succs)) return false;
+        node *victim = succs[0];
+        for (size_t l = victim->height; l-- > 1;) {
+            node *succ = links(victim)[l].load(std::memory_order_acquire);
+            while (!marked(succ)
+                   && !links(victim)[l].compare_exchange_weak(succ, with_mark(succ), std::memory_order_acq_rel)) {}
+        }
+        node *succ = links(victim)[0].load(std::memory_order_acquire);
+        while (true) {
+            // another erase of the same element got there first
+            if (marked(succ)) return false;
+            if (links(victim)[0].compare_exchange_weak(succ, with_mark(succ), std::memory_order_acq_rel)) break;
+        }
+        element_count.fetch_sub(1, std::memory_order_relaxed);
+        locate(key, preds, succs);
+        release(guard.r, victim);
+        return true;
+    }
+    /**
+     * a copy of the element of key, end() if there is none
+     */
+    const_iterator find(const Key &key) const {
+        epoch_guard guard(this);
+        node *n = search(key, false);
+        if (n == nullptr || key < n->item.first) return cend();
+        return const_iterator(this, copy_of(n));
+    }
+    size_t count(const Key &key) const {
+        epoch_guard guard(this);
+        node *n = search(key, false);
+        return n != nullptr && !(key < n->item.first);
+    }
+    /**
+     * a copy of the value of key
+     * throw index_out_of_bound if there is none
+     */
+    T at(const Key &key) const {
+        epoch_guard guard(this);
+        node *n = search(key, false);
+        if (n == nullptr || key < n->item.first) throw index_out_of_bound();
+        return n->item.second;
+    }
+    /**
+     * call f(element) for the elements with keys in [low, high), in key order
+     * weakly consistent like the iterators, but in one pass over level 0
+     */
+    template<class F>
+    void scan(const Key &low, const Key &high, F f) const {
+        epoch_guard guard(this);
+        for (node *n = search(low, false); n != nullptr && n->item.first < high; n = live_from(without_mark(links(n)[0].load(std::memory_order_acquire)))) {
+            f(static_cast<const value_type &>(n->item));
+        }
+    }
+    const_iterator lower_bound(const Key &key) const {
+        epoch_guard guard(this);
+        return const_iterator(this, copy_of(search(key, false)));
+    }
+    const_iterator upper_bound(const Key &key) const {
+        epoch_guard guard(this);
+        return const_iterator(this, copy_of(search(key, true)));
+    }
+    const_iterator cbegin() const {
+        epoch_guard guard(this);
+        return const_iterator(this, copy_of(live_from(without_mark(links(head)[0].load(std::memory_order_acquire)))));
+    }
+    const_iterator cend() const {
+        return const_iterator(this, nullptr);
+    }
+    const_iterator begin() const {
+        return cbegin();
+    }
+    const_iterator end() const {
+        return cend();
+    }
+    /**
+     * exact while no other thread changes the map
+     */
+    size_t size() const {
+        return element_count.load(std::memory_order_relaxed);
+    }
+    bool empty() const {
+        return size() == 0;
+    }
+};
+
+}
+
+#endif //SJTU_CONCURRENT_SKIPLIST_HPP
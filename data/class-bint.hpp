@@ -1,14 +1,23 @@
+#ifndef UTIL_BINT_HPP
+#define UTIL_BINT_HPP
+
 #include <string>
 #include <iostream>
 #include <cstring>
 #include <cstdlib>
+#include <functional>
 #include <vector>
 #include <stdexcept>
 
+#include "tuning.hpp"
+#include "parallel.hpp"
+
 namespace Util {
 
 const size_t MIN_CAPACITY = 2048;
 
+class BintAccumulator;
+
 class Bint {
 	class NewSpaceFailed : public std::runtime_error {
 	public:
@@ -25,6 +34,10 @@ class Bint {
 	void _DoubleSpace();
 	void _SafeNewSpace(int *&p, const size_t &len);
 	explicit Bint(const size_t &capa);
+	std::vector<int> _Magnitude() const;
+	static Bint _FromMagnitude(const std::vector<int> &mag, bool minus);
+	static const char *_DigitTable();
+	friend class BintAccumulator;
 public:
 	Bint();
 	Bint(int x);
@@ -53,16 +66,62 @@ public:
 	friend Bint operator-(Bint &&b);
 	friend Bint operator-(const Bint &lhs, const Bint &rhs);
 	friend Bint operator*(const Bint &lhs, const Bint &rhs);
+	friend Bint multiply(const Bint &lhs, const Bint &rhs, size_t baseCase);
+
+	Bint &operator+=(const Bint &rhs);
+
+	friend Bint gcd(const Bint &lhs, const Bint &rhs);
+	friend Bint exact_div(const Bint &lhs, const Bint &rhs);
+
+	size_t FormatSize() const;
+	char *Format(char *out) const;
+	size_t Hash() const;
 
 	friend std::istream &operator>>(std::istream &is, Bint &b);
 	friend std::ostream &operator<<(std::ostream &os, const Bint &b);
 
 	~Bint();
 };
+
+/**
+ * Sums of Bint values and products with deferred carries.
+ * Limbs are kept as signed 64-bit accumulators and only normalized when
+ * they could overflow or when the result is requested, so a whole dot
+ * product costs one buffer instead of a temporary Bint per term.
+ * The buffer is kept across Reset(), which makes it cheap to reuse.
+ */
+class BintAccumulator {
+	std::vector<long long> limbs;
+	size_t used = 0;
+	unsigned long long bound = 0; // upper bound of any |limbs[i]|
+	void _Reserve(const size_t &len);
+	void _Charge(const unsigned long long &amount);
+	long long _Normalize(const size_t &top);
+public:
+	BintAccumulator() = default;
+
+	void Reset();
+	void Add(const Bint &b);
+	void AddProduct(const Bint &lhs, const Bint &rhs);
+	Bint Result();
+};
+
+/**
+ * Sum of all Bint values in [first, last).
+ */
+template<class InputIt>
+Bint sum(InputIt first, InputIt last, size_t threads = 0);
+
+/**
+ * Writes every Bint of [first, last) followed by sep, in large writes.
+ */
+template<class InputIt>
+void WriteAll(std::ostream &os, InputIt first, InputIt last, char sep = '\n');
 }
 
 #include <iomanip>
 #include <algorithm>
+#include <thread>
 
 namespace Util {
 
@@ -194,8 +253,8 @@ Bint &Bint::operator=(int x)
 {
 	memset(data, 0, sizeof(unsigned int) * capacity);
 	length = 0;
-	if (x < 0) {
-		isMinus = true;
+	isMinus = x < 0;
+	if (isMinus) {
 		x = -x;
 	}
 	while (x) {
@@ -212,8 +271,8 @@ Bint &Bint::operator=(long long x)
 {
 	memset(data, 0, sizeof(unsigned int) * capacity);
 	length = 0;
-	if (x < 0) {
-		isMinus = true;
+	isMinus = x < 0;
+	if (isMinus) {
 		x = -x;
 	}
 	while (x) {
@@ -246,11 +305,10 @@ Bint &Bint::operator=(Bint &&rhs) noexcept
 	if (this == &rhs) {
 		return *this;
 	}
-	capacity = rhs.capacity;
-	length = rhs.length;
-	isMinus = rhs.isMinus;
-	data = rhs.data;
-	rhs.data = nullptr;
+	std::swap(capacity, rhs.capacity);
+	std::swap(length, rhs.length);
+	std::swap(isMinus, rhs.isMinus);
+	std::swap(data, rhs.data);
 	return *this;
 }
 
@@ -262,21 +320,123 @@ std::istream &operator>>(std::istream &is, Bint &b)
 	return is;
 }
 
+/**
+ * The four decimal digits of every limb value, 0000 to 9999.
+ */
+const char *Bint::_DigitTable()
+{
+	struct Table {
+		char digits[40000];
+		Table()
+		{
+			for (int i = 0; i < 10000; ++i) {
+				digits[4 * i] = char('0' + i / 1000);
+				digits[4 * i + 1] = char('0' + i / 100 % 10);
+				digits[4 * i + 2] = char('0' + i / 10 % 10);
+				digits[4 * i + 3] = char('0' + i % 10);
+			}
+		}
+	};
+	static const Table table;
+	return table.digits;
+}
+
+/**
+ * A hash of the sign and the limbs, consistent with operator==.
+ */
+size_t Bint::Hash() const
+{
+	unsigned long long h = isMinus ? 0x9E3779B97F4A7C15ULL : 0;
+	if (data == nullptr) {
+		return size_t(h);
+	}
+	for (size_t i = 0; i < length; ++i) {
+		h = (h + (unsigned int)data[i]) * 0xFF51AFD7ED558CCDULL;
+		h ^= h >> 32;
+	}
+	return size_t(h ^ length);
+}
+
+/**
+ * Upper bound of the number of characters Format() writes.
+ */
+size_t Bint::FormatSize() const
+{
+	return 4 * length + 1;
+}
+
+/**
+ * Writes the number in decimal to out, without a terminating null,
+ * and returns the end of what was written.
+ */
+char *Bint::Format(char *out) const
+{
+	if (data == nullptr) {
+		return out;
+	}
+	if (isMinus && (length > 1 || data[0] != 0)) {
+		*out++ = '-';
+	}
+	const char *table = _DigitTable();
+	const int top = data[length - 1];
+	const size_t skip = top >= 1000 ? 0 : top >= 100 ? 1 : top >= 10 ? 2 : 3;
+	memcpy(out, table + 4 * top + skip, 4 - skip);
+	out += 4 - skip;
+	for (size_t i = length - 1; i-- > 0;) {
+		memcpy(out, table + 4 * data[i], 4);
+		out += 4;
+	}
+	return out;
+}
+
 std::ostream &operator<<(std::ostream &os, const Bint &b)
 {
-	if (b.data == nullptr) {
-		return os;
+	char local[256];
+	std::vector<char> heap;
+	char *buffer = local;
+	if (b.FormatSize() > sizeof(local)) {
+		heap.resize(b.FormatSize());
+		buffer = heap.data();
 	}
-	if (b.isMinus && (b.length > 1 || b.data[0] != 0)) {
-		os << "-";
+	const std::streamsize len = b.Format(buffer) - buffer;
+	const std::streamsize pad = os.width() > len ? os.width() - len : 0;
+	const bool left = (os.flags() & std::ios::adjustfield) == std::ios::left;
+	os.width(0);
+	for (std::streamsize i = 0; !left && i < pad; ++i) {
+		os.put(os.fill());
 	}
-	os << b.data[b.length - 1];
-	for (long long i = b.length - 2LL; i >= 0; --i) {
-		os << std::setw(4) << std::setfill('0') << b.data[i];
+	os.write(buffer, len);
+	for (std::streamsize i = 0; left && i < pad; ++i) {
+		os.put(os.fill());
 	}
 	return os;
 }
 
+/**
+ * Writes every value of [first, last) followed by sep, formatting them
+ * into one buffer that is handed to os in large writes.
+ */
+template<class InputIt>
+void WriteAll(std::ostream &os, InputIt first, InputIt last, char sep)
+{
+	std::vector<char> buffer(1 << 16);
+	size_t used = 0;
+	for (; first != last; ++first) {
+		const Bint &b = *first;
+		const size_t need = b.FormatSize() + 1;
+		if (used + need > buffer.size()) {
+			os.write(buffer.data(), used);
+			used = 0;
+			if (need > buffer.size()) {
+				buffer.resize(need);
+			}
+		}
+		used = b.Format(buffer.data() + used) - buffer.data();
+		buffer[used++] = sep;
+	}
+	os.write(buffer.data(), used);
+}
+
 Bint abs(const Bint &b)
 {
 	Bint result(b);
@@ -422,7 +582,7 @@ Bint operator+(const Bint &lhs, const Bint &rhs)
 			result.data[i] = lhs.data[i] + rhs.data[i];
 		}
 		for (size_t i = 0; i < maxLen; ++i) {
-			if (result.data[i] > 10000) {
+			if (result.data[i] >= 10000) {
 				result.data[i] -= 10000;
 				++result.data[i + 1];
 			}
@@ -462,13 +622,14 @@ Bint operator-(const Bint &lhs, const Bint &rhs)
 				return -(rhs - lhs);
 			}
 			Bint result(std::max(lhs.length, rhs.length));
+			result.length = lhs.length;
 			for (size_t i = 0; i < lhs.length; ++i) {
 				result.data[i] = lhs.data[i] - rhs.data[i];
 			}
 			for (size_t i = 0; i < lhs.length; ++i) {
 				if (result.data[i] < 0) {
 					result.data[i] += 10000;
-					++result.data[i + 1];
+					--result.data[i + 1];
 				}
 			}
 			while (result.length > 1 && result.data[result.length - 1] == 0) {
@@ -483,34 +644,688 @@ Bint operator-(const Bint &lhs, const Bint &rhs)
 
 Bint operator*(const Bint &lhs, const Bint &rhs)
 {
-	size_t expectLen = lhs.length + rhs.length + 2;
-	Bint result(expectLen);
-	for (size_t i = 0; i < lhs.length; ++i) {
-		for (size_t j = 0; j < rhs.length; ++j) {
-			long long tmp = result.data[i + j] + static_cast<long long>(lhs.data[i]) * rhs.data[j];
-			if (tmp >= 10000) {
-				result.data[i + j] = tmp % 10000;
-				result.data[i + j + 1] += static_cast<int>(tmp / 10000);
-			} else {
-				result.data[i + j] = tmp;
+	return multiply(lhs, rhs, UTIL_BINT_MUL_BASE);
+}
+
+Bint &Bint::operator+=(const Bint &rhs)
+{
+	*this = *this + rhs;
+	return *this;
+}
+
+Bint::~Bint()
+{
+	if (data != nullptr) {
+		delete[] data;
+		data = nullptr;
+	}
+}
+
+std::vector<int> Bint::_Magnitude() const
+{
+	std::vector<int> mag(data, data + length);
+	while (!mag.empty() && mag.back() == 0) {
+		mag.pop_back();
+	}
+	return mag;
+}
+
+Bint Bint::_FromMagnitude(const std::vector<int> &mag, bool minus)
+{
+	Bint result(mag.size() + 1);
+	result.length = mag.empty() ? 1 : mag.size();
+	for (size_t i = 0; i < mag.size(); ++i) {
+		result.data[i] = mag[i];
+	}
+	result.isMinus = minus && !mag.empty();
+	return result;
+}
+
+/**
+ * Magnitude arithmetic on little-endian base 10000 limbs without
+ * leading zeros (zero is the empty vector), used by gcd and exact_div.
+ */
+namespace BintLimbs {
+
+const long long BASE = 10000;
+
+void Trim(std::vector<int> &x)
+{
+	while (!x.empty() && x.back() == 0) {
+		x.pop_back();
+	}
+}
+
+int Compare(const std::vector<int> &x, const std::vector<int> &y)
+{
+	if (x.size() != y.size()) {
+		return x.size() < y.size() ? -1 : 1;
+	}
+	for (size_t i = x.size(); i-- > 0;) {
+		if (x[i] != y[i]) {
+			return x[i] < y[i] ? -1 : 1;
+		}
+	}
+	return 0;
+}
+
+long long FloorDiv(long long x)
+{
+	return x >= 0 ? x / BASE : -((-x + BASE - 1) / BASE);
+}
+
+/**
+ * x /= d for 0 < d < 10^14, returns the remainder.
+ */
+unsigned long long DivSmall(std::vector<int> &x, unsigned long long d)
+{
+	unsigned long long rem = 0;
+	for (size_t i = x.size(); i-- > 0;) {
+		unsigned long long cur = rem * BASE + x[i];
+		x[i] = static_cast<int>(cur / d);
+		rem = cur % d;
+	}
+	Trim(x);
+	return rem;
+}
+
+unsigned long long ModSmall(const std::vector<int> &x, unsigned long long d)
+{
+	unsigned long long rem = 0;
+	for (size_t i = x.size(); i-- > 0;) {
+		rem = (rem * BASE + x[i]) % d;
+	}
+	return rem;
+}
+
+unsigned long long ToU64(const std::vector<int> &x)
+{
+	unsigned long long value = 0;
+	for (size_t i = x.size(); i-- > 0;) {
+		value = value * BASE + x[i];
+	}
+	return value;
+}
+
+std::vector<int> FromU64(unsigned long long value)
+{
+	std::vector<int> x;
+	while (value) {
+		x.push_back(static_cast<int>(value % BASE));
+		value /= BASE;
+	}
+	return x;
+}
+
+/**
+ * Stein's binary gcd.
+ */
+unsigned long long BinaryGcd(unsigned long long u, unsigned long long v)
+{
+	if (u == 0) {
+		return v;
+	}
+	if (v == 0) {
+		return u;
+	}
+	int shift = __builtin_ctzll(u | v);
+	u >>= __builtin_ctzll(u);
+	while (v != 0) {
+		v >>= __builtin_ctzll(v);
+		if (u > v) {
+			std::swap(u, v);
+		}
+		v -= u;
+	}
+	return u << shift;
+}
+
+/**
+ * Whether the n + 1 limbs rem[j .. j + n] are at least b (n limbs).
+ */
+bool WindowAtLeast(const std::vector<long long> &rem, size_t j, const std::vector<int> &b)
+{
+	size_t n = b.size();
+	if (rem[j + n] != 0) {
+		return rem[j + n] > 0;
+	}
+	for (size_t i = n; i-- > 0;) {
+		if (rem[j + i] != b[i]) {
+			return rem[j + i] > b[i];
+		}
+	}
+	return true;
+}
+
+/**
+ * Schoolbook long division a = q * b + r, b != 0.
+ * Each quotient limb is estimated from the top three limbs of the
+ * remainder and the top two of b, then corrected by at most a few
+ * additions or subtractions of b.
+ */
+void DivMod(const std::vector<int> &a, const std::vector<int> &b, std::vector<int> &q, std::vector<int> &r)
+{
+	if (Compare(a, b) < 0) {
+		q.clear();
+		r = a;
+		return;
+	}
+	if (b.size() == 1) {
+		q = a;
+		r = FromU64(DivSmall(q, b[0]));
+		return;
+	}
+	const size_t n = b.size(), m = a.size();
+	std::vector<long long> rem(a.begin(), a.end());
+	rem.push_back(0);
+	q.assign(m - n + 1, 0);
+	const long long btop = b[n - 1] * BASE + b[n - 2];
+	for (size_t j = m - n + 1; j-- > 0;) {
+		long long rtop = (rem[j + n] * BASE + rem[j + n - 1]) * BASE + rem[j + n - 2];
+		long long qhat = rtop / btop;
+		if (qhat >= BASE) {
+			qhat = BASE - 1;
+		}
+		long long carry = 0;
+		for (size_t i = 0; i < n; ++i) {
+			long long cur = rem[i + j] - qhat * b[i] + carry;
+			carry = FloorDiv(cur);
+			rem[i + j] = cur - carry * BASE;
+		}
+		rem[j + n] += carry;
+		while (rem[j + n] < 0) {
+			--qhat;
+			carry = 0;
+			for (size_t i = 0; i < n; ++i) {
+				long long cur = rem[i + j] + b[i] + carry;
+				carry = cur / BASE;
+				rem[i + j] = cur % BASE;
+			}
+			rem[j + n] += carry;
+		}
+		while (WindowAtLeast(rem, j, b)) {
+			++qhat;
+			carry = 0;
+			for (size_t i = 0; i < n; ++i) {
+				long long cur = rem[i + j] - b[i] + carry;
+				carry = FloorDiv(cur);
+				rem[i + j] = cur - carry * BASE;
+			}
+			rem[j + n] += carry;
+		}
+		q[j] = static_cast<int>(qhat);
+	}
+	r.assign(rem.begin(), rem.begin() + n);
+	Trim(q);
+	Trim(r);
+}
+
+/**
+ * (x, y) = (A x + B y, C x + D y) for Lehmer cofactors, which keep both
+ * results non-negative and no larger than x.
+ */
+void Combine(std::vector<int> &x, std::vector<int> &y, long long A, long long B, long long C, long long D)
+{
+	size_t n = std::max(x.size(), y.size());
+	x.resize(n, 0);
+	y.resize(n, 0);
+	long long cx = 0, cy = 0;
+	for (size_t i = 0; i < n; ++i) {
+		long long nx = A * x[i] + B * y[i] + cx;
+		long long ny = C * x[i] + D * y[i] + cy;
+		cx = FloorDiv(nx);
+		cy = FloorDiv(ny);
+		x[i] = static_cast<int>(nx - cx * BASE);
+		y[i] = static_cast<int>(ny - cy * BASE);
+	}
+	Trim(x);
+	Trim(y);
+}
+
+/**
+ * Inverse of a modulo BASE for a coprime to BASE.
+ */
+long long InverseModBase(long long a)
+{
+	long long r0 = BASE, r1 = a, t0 = 0, t1 = 1;
+	while (r1 != 0) {
+		long long q = r0 / r1;
+		long long tmp = r0 - q * r1;
+		r0 = r1;
+		r1 = tmp;
+		tmp = t0 - q * t1;
+		t0 = t1;
+		t1 = tmp;
+	}
+	return ((t0 % BASE) + BASE) % BASE;
+}
+
+/**
+ * out[0 .. 2n) = a[0 .. n) * b[0 .. n), normalized.
+ * Below baseCase limbs (and always below 4, where splitting would not
+ * shrink the operands) this is schoolbook; above it the operands are
+ * halved and three half-size products are combined.
+ */
+void Karatsuba(const int *a, const int *b, size_t n, int *out, size_t baseCase)
+{
+	std::vector<long long> acc(2 * n + 2, 0);
+	if (n < baseCase || n < 4) {
+		for (size_t i = 0; i < n; ++i) {
+			long long x = a[i];
+			for (size_t j = 0; j < n; ++j) {
+				acc[i + j] += x * b[j];
+			}
+		}
+	} else {
+		const size_t m = n / 2, h = n - m;
+		std::vector<int> z0(2 * m), z2(2 * h), sa(h + 1, 0), sb(h + 1, 0), z1(2 * h + 2);
+		Karatsuba(a, b, m, z0.data(), baseCase);
+		Karatsuba(a + m, b + m, h, z2.data(), baseCase);
+		for (size_t i = 0; i < h; ++i) {
+			sa[i] += a[m + i] + (i < m ? a[i] : 0);
+			sb[i] += b[m + i] + (i < m ? b[i] : 0);
+			if (sa[i] >= BASE) {
+				sa[i] -= BASE;
+				++sa[i + 1];
+			}
+			if (sb[i] >= BASE) {
+				sb[i] -= BASE;
+				++sb[i + 1];
 			}
 		}
+		Karatsuba(sa.data(), sb.data(), h + 1, z1.data(), baseCase);
+		for (size_t i = 0; i < 2 * m; ++i) {
+			acc[i] += z0[i];
+			acc[i + m] -= z0[i];
+		}
+		for (size_t i = 0; i < 2 * h; ++i) {
+			acc[i + 2 * m] += z2[i];
+			acc[i + m] -= z2[i];
+		}
+		for (size_t i = 0; i < 2 * h + 2; ++i) {
+			acc[i + m] += z1[i];
+		}
+	}
+	long long carry = 0;
+	for (size_t i = 0; i < 2 * n; ++i) {
+		long long cur = acc[i] + carry;
+		carry = FloorDiv(cur);
+		out[i] = static_cast<int>(cur - carry * BASE);
+	}
+}
+
+}
+
+/**
+ * lhs * rhs, by schoolbook when the shorter operand has fewer than
+ * baseCase limbs and by Karatsuba otherwise. A much longer operand is
+ * cut into pieces as long as the shorter one.
+ */
+Bint multiply(const Bint &lhs, const Bint &rhs, size_t baseCase)
+{
+	if (std::min(lhs.length, rhs.length) < baseCase || std::min(lhs.length, rhs.length) < 4) {
+		size_t expectLen = lhs.length + rhs.length + 2;
+		Bint result(expectLen);
+		for (size_t i = 0; i < lhs.length; ++i) {
+			for (size_t j = 0; j < rhs.length; ++j) {
+				long long tmp = result.data[i + j] + static_cast<long long>(lhs.data[i]) * rhs.data[j];
+				if (tmp >= 10000) {
+					result.data[i + j] = tmp % 10000;
+					result.data[i + j + 1] += static_cast<int>(tmp / 10000);
+				} else {
+					result.data[i + j] = tmp;
+				}
+			}
+		}
+		result.length = lhs.length + rhs.length -1;
+		while (result.data[result.length] > 0) {
+			++result.length;
+		}
+		while (result.length > 1 && result.data[result.length - 1] == 0) {
+			--result.length;
+		}
+		result.isMinus = (lhs.isMinus != rhs.isMinus) && (result.length > 1 || result.data[0] != 0);
+		return result;
+	}
+
+	const Bint &shorter = lhs.length <= rhs.length ? lhs : rhs;
+	const Bint &longer = lhs.length <= rhs.length ? rhs : lhs;
+	const size_t n = shorter.length;
+	std::vector<long long> acc(longer.length + 2 * n, 0);
+	std::vector<int> piece(n), prod(2 * n);
+	for (size_t offset = 0; offset < longer.length; offset += n) {
+		size_t len = std::min(n, longer.length - offset);
+		std::copy(longer.data + offset, longer.data + offset + len, piece.begin());
+		std::fill(piece.begin() + len, piece.end(), 0);
+		BintLimbs::Karatsuba(shorter.data, piece.data(), n, prod.data(), baseCase);
+		for (size_t i = 0; i < 2 * n; ++i) {
+			acc[offset + i] += prod[i];
+		}
 	}
-	result.length = lhs.length + rhs.length -1;
-	while (result.data[result.length] > 0) {
-		++result.length;
+	size_t len = acc.size();
+	Bint result(len + 1);
+	long long carry = 0;
+	for (size_t i = 0; i < len; ++i) {
+		long long cur = acc[i] + carry;
+		carry = cur / BintLimbs::BASE;
+		result.data[i] = static_cast<int>(cur % BintLimbs::BASE);
 	}
-	while (result.length > 1 && result.data[result.length - 1] == 0) {
-		--result.length;
+	while (len > 1 && result.data[len - 1] == 0) {
+		--len;
 	}
+	result.length = len;
+	result.isMinus = (lhs.isMinus != rhs.isMinus) && (len > 1 || result.data[0] != 0);
 	return result;
 }
 
-Bint::~Bint()
+/**
+ * Lehmer's gcd. While both operands are long, three leading limbs of
+ * each drive a single-precision Euclid that yields cofactors, and one
+ * multi-precision combination replaces many division steps. Once the
+ * smaller operand fits in a machine word the rest is a binary gcd.
+ * The result is never negative.
+ */
+Bint gcd(const Bint &lhs, const Bint &rhs)
 {
-	if (data != nullptr) {
-		delete[] data;
-		data = nullptr;
+	std::vector<int> a = lhs._Magnitude(), b = rhs._Magnitude();
+	if (BintLimbs::Compare(a, b) < 0) {
+		a.swap(b);
+	}
+	std::vector<int> q, r;
+	while (b.size() > 3) {
+		const size_t n = a.size();
+		long long x = (a[n - 1] * BintLimbs::BASE + a[n - 2]) * BintLimbs::BASE + a[n - 3];
+		long long y = 0;
+		for (size_t i = n; i-- > n - 3;) {
+			y = y * BintLimbs::BASE + (i < b.size() ? b[i] : 0);
+		}
+		long long A = 1, B = 0, C = 0, D = 1;
+		while (y + C > 0 && y + D > 0) {
+			long long q1 = (x + A) / (y + C), q2 = (x + B) / (y + D);
+			if (q1 != q2) {
+				break;
+			}
+			long long t = A - q1 * C;
+			A = C;
+			C = t;
+			t = B - q1 * D;
+			B = D;
+			D = t;
+			t = x - q1 * y;
+			x = y;
+			y = t;
+		}
+		if (B == 0) {
+			BintLimbs::DivMod(a, b, q, r);
+			a.swap(b);
+			b.swap(r);
+		} else {
+			BintLimbs::Combine(a, b, A, B, C, D);
+		}
+	}
+	if (b.empty()) {
+		return Bint::_FromMagnitude(a, false);
+	}
+	unsigned long long small = BintLimbs::ToU64(b);
+	return Bint::_FromMagnitude(BintLimbs::FromU64(BintLimbs::BinaryGcd(small, BintLimbs::ModSmall(a, small))), false);
+}
+
+/**
+ * lhs / rhs when rhs is known to divide lhs; otherwise the result is
+ * unspecified. Common factors of 2 and 5 are divided out of both sides
+ * until the lowest limb of the divisor is invertible modulo 10000, then
+ * the quotient is produced from its lowest limb upwards (Jebelean),
+ * touching only the limbs of lhs below the quotient's length.
+ */
+Bint exact_div(const Bint &lhs, const Bint &rhs)
+{
+	std::vector<int> a = lhs._Magnitude(), b = rhs._Magnitude();
+	if (b.empty()) {
+		throw std::invalid_argument("Division by zero");
+	}
+	const bool minus = lhs.isMinus != rhs.isMinus;
+	while (true) {
+		size_t zeros = 0;
+		while (b[zeros] == 0) {
+			++zeros;
+		}
+		b.erase(b.begin(), b.begin() + zeros);
+		a.erase(a.begin(), a.begin() + std::min(zeros, a.size()));
+		// BASE = 2^4 * 5^4, so a common factor of b[0] and BASE divides b.
+		unsigned long long factor = BintLimbs::BinaryGcd(b[0], BintLimbs::BASE);
+		if (factor == 1) {
+			break;
+		}
+		BintLimbs::DivSmall(a, factor);
+		BintLimbs::DivSmall(b, factor);
+	}
+	if (a.size() < b.size()) {
+		return Bint::_FromMagnitude(std::vector<int>(), minus);
+	}
+
+	const long long inv = BintLimbs::InverseModBase(b[0]);
+	const size_t qn = a.size() - b.size() + 1;
+	std::vector<long long> rem(a.begin(), a.begin() + qn);
+	std::vector<int> q(qn, 0);
+	for (size_t i = 0; i < qn; ++i) {
+		long long low = rem[i] - BintLimbs::FloorDiv(rem[i]) * BintLimbs::BASE;
+		long long qi = low * inv % BintLimbs::BASE;
+		q[i] = static_cast<int>(qi);
+		size_t top = std::min(b.size(), qn - i);
+		for (size_t k = 0; k < top; ++k) {
+			rem[i + k] -= qi * b[k];
+		}
+		// rem[i] is now a multiple of BASE.
+		if (i + 1 < qn) {
+			rem[i + 1] += rem[i] / BintLimbs::BASE;
+		}
+	}
+	BintLimbs::Trim(q);
+	return Bint::_FromMagnitude(q, minus);
+}
+
+void BintAccumulator::_Reserve(const size_t &len)
+{
+	if (limbs.size() < len) {
+		size_t newSize = limbs.empty() ? 64 : limbs.size();
+		while (newSize < len) {
+			newSize <<= 1;
+		}
+		limbs.resize(newSize, 0);
+	}
+	if (used < len) {
+		used = len;
+	}
+}
+
+/**
+ * Carries limbs[0 .. top - 1] into their upper neighbours with floor
+ * division, so every limb below top lies in [0, 10000).
+ * Returns the carry out of limbs[top - 1].
+ */
+long long BintAccumulator::_Normalize(const size_t &top)
+{
+	long long carry = 0;
+	for (size_t i = 0; i < top; ++i) {
+		long long cur = limbs[i] + carry;
+		carry = cur / 10000;
+		cur %= 10000;
+		if (cur < 0) {
+			cur += 10000;
+			--carry;
+		}
+		limbs[i] = cur;
+	}
+	return carry;
+}
+
+void BintAccumulator::_Charge(const unsigned long long &amount)
+{
+	const unsigned long long LIMIT = 4000000000000000000ULL;
+	if (bound + amount <= LIMIT) {
+		bound += amount;
+		return;
+	}
+	// Keep the carry out in a fresh top limb; it is far below the limit.
+	long long carry = _Normalize(used);
+	if (carry != 0) {
+		_Reserve(used + 1);
+		limbs[used - 1] += carry;
+	}
+	unsigned long long top = static_cast<unsigned long long>(std::llabs(limbs[used - 1]));
+	bound = std::max(top, 10000ULL) + amount;
+}
+
+void BintAccumulator::Reset()
+{
+	std::fill(limbs.begin(), limbs.begin() + used, 0);
+	used = 0;
+	bound = 0;
+}
+
+void BintAccumulator::Add(const Bint &b)
+{
+	_Reserve(b.length);
+	_Charge(10000);
+	if (b.isMinus) {
+		for (size_t i = 0; i < b.length; ++i) {
+			limbs[i] -= b.data[i];
+		}
+	} else {
+		for (size_t i = 0; i < b.length; ++i) {
+			limbs[i] += b.data[i];
+		}
+	}
+}
+
+void BintAccumulator::AddProduct(const Bint &lhs, const Bint &rhs)
+{
+	_Reserve(lhs.length + rhs.length);
+	// A limb of the product collects at most min(length) partial products.
+	_Charge(100000000ULL * std::min(lhs.length, rhs.length));
+	const int *a = lhs.data, *b = rhs.data;
+	long long *out = limbs.data();
+	if (lhs.isMinus != rhs.isMinus) {
+		for (size_t i = 0; i < lhs.length; ++i) {
+			long long x = a[i];
+			for (size_t j = 0; j < rhs.length; ++j) {
+				out[i + j] -= x * b[j];
+			}
+		}
+	} else {
+		for (size_t i = 0; i < lhs.length; ++i) {
+			long long x = a[i];
+			for (size_t j = 0; j < rhs.length; ++j) {
+				out[i + j] += x * b[j];
+			}
+		}
+	}
+}
+
+Bint BintAccumulator::Result()
+{
+	bool minus = false;
+	_Reserve(1);
+	long long carry = _Normalize(used);
+	while (carry > 0) {
+		_Reserve(used + 1);
+		limbs[used - 1] = carry;
+		carry = _Normalize(used);
+	}
+	if (carry < 0) {
+		// The total is negative: flip every limb and carry again.
+		minus = true;
+		for (size_t i = 0; i < used; ++i) {
+			limbs[i] = -limbs[i];
+		}
+		limbs[used - 1] -= carry * 10000;
+		carry = _Normalize(used);
+		while (carry > 0) {
+			_Reserve(used + 1);
+			limbs[used - 1] = carry;
+			carry = _Normalize(used);
+		}
 	}
+	bound = 10000;
+
+	size_t len = used;
+	while (len > 1 && limbs[len - 1] == 0) {
+		--len;
+	}
+	Bint result(len + 1);
+	result.length = len == 0 ? 1 : len;
+	for (size_t i = 0; i < len; ++i) {
+		result.data[i] = static_cast<int>(limbs[i]);
+	}
+	result.isMinus = minus && (len > 1 || limbs[0] != 0);
+	return result;
 }
+/**
+ * Operands summed by one thread at least.
+ */
+const size_t SUM_OPERANDS_PER_THREAD = 4096;
+
+/**
+ * Every operand is added into one BintAccumulator and the carries are
+ * normalized once at the end. When threads (0 for hardware concurrency)
+ * allows it, the range is cut into pieces that are accumulated in
+ * parallel and the partial sums are added up the same way.
+ */
+template<class InputIt>
+Bint sum(InputIt first, InputIt last, size_t threads)
+{
+	if (threads == 0) {
+		threads = std::thread::hardware_concurrency();
+	}
+	if (threads <= 1) {
+		BintAccumulator acc;
+		for (; first != last; ++first) {
+			acc.Add(*first);
+		}
+		return acc.Result();
+	}
+
+	std::vector<const Bint *> operands;
+	for (; first != last; ++first) {
+		operands.push_back(&*first);
+	}
+	if (threads > operands.size() / SUM_OPERANDS_PER_THREAD) {
+		threads = operands.size() / SUM_OPERANDS_PER_THREAD;
+	}
+	if (threads <= 1) {
+		BintAccumulator acc;
+		for (size_t i = 0; i < operands.size(); ++i) {
+			acc.Add(*operands[i]);
+		}
+		return acc.Result();
+	}
+
+	// one piece of operands per thread, each summed into its own accumulator
+	std::vector<BintAccumulator> partial(threads);
+	size_t step = (operands.size() + threads - 1) / threads;
+	ParallelFor(threads, 1, threads, [&](size_t first, size_t last) {
+		for (size_t t = first; t < last; ++t) {
+			size_t to = std::min(operands.size(), (t + 1) * step);
+			for (size_t i = t * step; i < to; ++i) {
+				partial[t].Add(*operands[i]);
+			}
+		}
+	});
+	BintAccumulator acc;
+	for (size_t t = 0; t < threads; ++t) {
+		acc.Add(partial[t].Result());
+	}
+	return acc.Result();
+}
+}
+
+namespace std {
+template<>
+struct hash<Util::Bint> {
+	size_t operator()(const Util::Bint &b) const
+	{
+		return b.Hash();
+	}
+};
 }
+#endif
@@ -0,0 +1,278 @@
+#ifndef DIAMOND_MATRIX_BATCH_HPP
+#define DIAMOND_MATRIX_BATCH_HPP
+
+#include "class-matrix.hpp"
+#include "parallel.hpp"
+#include "list.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+namespace Diamond {
+
+/**
+ * Batched products of many small matrics of the same shape.
+ * The operands are packed once into flat pools, every product runs
+ * through a kernel chosen for the shape, and the results land in a
+ * single output pool before they are handed out as Matrix objects.
+ */
+namespace Batch {
+
+/**
+ * c = a * b for a R x K and a K x C matrix stored row by row.
+ * The sizes are known at compile time so the loops unroll.
+ */
+template<typename _Td, size_t R, size_t K, size_t C>
+void FixedKernel(const _Td *a, const _Td *b, _Td *c)
+{
+	for (size_t i = 0; i < R; ++i) {
+		for (size_t j = 0; j < C; ++j) {
+			_Td sum = a[i * K] * b[j];
+			for (size_t k = 1; k < K; ++k) {
+				sum = sum + a[i * K + k] * b[k * C + j];
+			}
+			c[i * C + j] = sum;
+		}
+	}
+}
+
+template<typename _Td>
+void GenericKernel(const _Td *a, const _Td *b, _Td *c, size_t r, size_t k, size_t m)
+{
+	if (k == 0) {
+		for (size_t i = 0; i < r * m; ++i) {
+			c[i] = _Td(0);
+		}
+		return;
+	}
+	for (size_t i = 0; i < r; ++i) {
+		for (size_t j = 0; j < m; ++j) {
+			_Td sum = a[i * k] * b[j];
+			for (size_t t = 1; t < k; ++t) {
+				sum = sum + a[i * k + t] * b[t * m + j];
+			}
+			c[i * m + j] = sum;
+		}
+	}
+}
+
+/**
+ * A kernel bound to one shape, resolved once per batch.
+ */
+template<typename _Td>
+class Kernel {
+	size_t r, k, m;
+	void (*fixed)(const _Td *, const _Td *, _Td *) = nullptr;
+
+	template<size_t R, size_t K>
+	bool _PickC()
+	{
+		switch (m) {
+			case 1: fixed = FixedKernel<_Td, R, K, 1>; return true;
+			case 2: fixed = FixedKernel<_Td, R, K, 2>; return true;
+			case 3: fixed = FixedKernel<_Td, R, K, 3>; return true;
+			case 4: fixed = FixedKernel<_Td, R, K, 4>; return true;
+			default: return false;
+		}
+	}
+	template<size_t R>
+	bool _PickK()
+	{
+		switch (k) {
+			case 1: return _PickC<R, 1>();
+			case 2: return _PickC<R, 2>();
+			case 3: return _PickC<R, 3>();
+			case 4: return _PickC<R, 4>();
+			default: return false;
+		}
+	}
+public:
+	Kernel(size_t _r, size_t _k, size_t _m) : r(_r), k(_k), m(_m)
+	{
+		switch (r) {
+			case 1: _PickK<1>(); break;
+			case 2: _PickK<2>(); break;
+			case 3: _PickK<3>(); break;
+			case 4: _PickK<4>(); break;
+			default: break;
+		}
+	}
+	void operator()(const _Td *a, const _Td *b, _Td *c) const
+	{
+		if (fixed != nullptr) {
+			fixed(a, b, c);
+		} else {
+			GenericKernel(a, b, c, r, k, m);
+		}
+	}
+};
+
+template<typename _Td>
+void Pack(const Matrix<_Td> &mat, _Td *out)
+{
+	for (size_t i = 0; i < mat.RowSize(); ++i) {
+		for (size_t j = 0; j < mat.ColSize(); ++j) {
+			*out++ = mat[i][j];
+		}
+	}
+}
+
+template<typename _Td>
+Matrix<_Td> Unpack(const _Td *in, size_t rows, size_t cols)
+{
+	Matrix<_Td> mat(rows, cols);
+	for (size_t i = 0; i < rows; ++i) {
+		for (size_t j = 0; j < cols; ++j) {
+			mat[i][j] = *in++;
+		}
+	}
+	return mat;
+}
+
+/**
+ * Packs every matrix of the list into one pool.
+ * All of them must have the shape of the first one.
+ */
+template<typename _Td>
+std::vector<_Td> PackAll(const sjtu::list<Matrix<_Td>> &mats, size_t &rows, size_t &cols)
+{
+	std::vector<_Td> pool;
+	if (mats.empty()) {
+		rows = cols = 0;
+		return pool;
+	}
+	rows = mats.front().RowSize();
+	cols = mats.front().ColSize();
+	pool.resize(mats.size() * rows * cols, _Td(0));
+	_Td *out = pool.data();
+	for (typename sjtu::list<Matrix<_Td>>::const_iterator it = mats.cbegin(); it != mats.cend(); ++it) {
+		if (it->RowSize() != rows || it->ColSize() != cols) {
+			throw std::invalid_argument("different matrics\'s sizes");
+		}
+		Pack(*it, out);
+		out += rows * cols;
+	}
+	return pool;
+}
+
+/**
+ * Number of small products given to one thread at least.
+ */
+const size_t PRODUCTS_PER_THREAD = 256;
+
+}
+
+/**
+ * Pairwise products lhs[i] * rhs[i] of two equally long lists.
+ */
+template<typename _Td>
+sjtu::list<Matrix<_Td>> BatchMultiply(const sjtu::list<Matrix<_Td>> &lhs, const sjtu::list<Matrix<_Td>> &rhs)
+{
+	if (lhs.size() != rhs.size()) {
+		throw std::invalid_argument("different batch sizes");
+	}
+	sjtu::list<Matrix<_Td>> result;
+	if (lhs.empty()) {
+		return result;
+	}
+	size_t r, k, k2, m;
+	std::vector<_Td> a = Batch::PackAll(lhs, r, k);
+	std::vector<_Td> b = Batch::PackAll(rhs, k2, m);
+	if (k != k2) {
+		throw std::invalid_argument("different matrics\'s sizes");
+	}
+	const size_t n = lhs.size();
+	std::vector<_Td> c(n * r * m, _Td(0));
+	Batch::Kernel<_Td> kernel(r, k, m);
+	Util::ParallelFor(n, Batch::PRODUCTS_PER_THREAD, 0, [&](size_t from, size_t to) {
+		for (size_t i = from; i < to; ++i) {
+			kernel(a.data() + i * r * k, b.data() + i * k * m, c.data() + i * r * m);
+		}
+	});
+	for (size_t i = 0; i < n; ++i) {
+		result.push_back(Batch::Unpack(c.data() + i * r * m, r, m));
+	}
+	return result;
+}
+
+/**
+ * Applies one transform to every matrix of the list: t * x for each x.
+ */
+template<typename _Td>
+sjtu::list<Matrix<_Td>> BatchTransform(const Matrix<_Td> &t, const sjtu::list<Matrix<_Td>> &xs)
+{
+	sjtu::list<Matrix<_Td>> result;
+	if (xs.empty()) {
+		return result;
+	}
+	size_t k, m;
+	std::vector<_Td> b = Batch::PackAll(xs, k, m);
+	if (t.ColSize() != k) {
+		throw std::invalid_argument("different matrics\'s sizes");
+	}
+	const size_t r = t.RowSize(), n = xs.size();
+	std::vector<_Td> a(r * k, _Td(0));
+	Batch::Pack(t, a.data());
+	std::vector<_Td> c(n * r * m, _Td(0));
+	Batch::Kernel<_Td> kernel(r, k, m);
+	Util::ParallelFor(n, Batch::PRODUCTS_PER_THREAD, 0, [&](size_t from, size_t to) {
+		for (size_t i = from; i < to; ++i) {
+			kernel(a.data(), b.data() + i * k * m, c.data() + i * r * m);
+		}
+	});
+	for (size_t i = 0; i < n; ++i) {
+		result.push_back(Batch::Unpack(c.data() + i * r * m, r, m));
+	}
+	return result;
+}
+
+/**
+ * Product of a chain of square matrics of the same size, in list order.
+ * The chain is folded left to right through two scratch buffers; with
+ * parallel set it is reduced as a balanced tree instead, one level at a
+ * time, which for floating point may round differently from the fold.
+ */
+template<typename _Td>
+Matrix<_Td> ChainProduct(const sjtu::list<Matrix<_Td>> &chain, bool parallel = false)
+{
+	if (chain.empty()) {
+		throw std::invalid_argument("empty chain");
+	}
+	size_t n, cols;
+	std::vector<_Td> pool = Batch::PackAll(chain, n, cols);
+	if (n != cols) {
+		throw std::invalid_argument("The row size and column size are different.");
+	}
+	const size_t area = n * n;
+	Batch::Kernel<_Td> kernel(n, n, n);
+	size_t count = chain.size();
+
+	if (!parallel) {
+		std::vector<_Td> acc(pool.begin(), pool.begin() + area), next(area, _Td(0));
+		for (size_t i = 1; i < count; ++i) {
+			kernel(acc.data(), pool.data() + i * area, next.data());
+			acc.swap(next);
+		}
+		return Batch::Unpack(acc.data(), n, n);
+	}
+
+	std::vector<_Td> next((count + 1) / 2 * area, _Td(0));
+	while (count > 1) {
+		size_t pairs = count / 2;
+		Util::ParallelFor(pairs, Batch::PRODUCTS_PER_THREAD / 4, 0, [&](size_t from, size_t to) {
+			for (size_t i = from; i < to; ++i) {
+				kernel(pool.data() + 2 * i * area, pool.data() + (2 * i + 1) * area, next.data() + i * area);
+			}
+		});
+		if (count & 1) {
+			std::copy(pool.begin() + (count - 1) * area, pool.begin() + count * area, next.begin() + pairs * area);
+		}
+		count = (count + 1) / 2;
+		pool.swap(next);
+	}
+	return Batch::Unpack(pool.data(), n, n);
+}
+
+}
+#endif
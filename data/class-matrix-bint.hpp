@@ -0,0 +1,47 @@
+#ifndef DIAMOND_MATRIX_BINT_HPP
+#define DIAMOND_MATRIX_BINT_HPP
+
+#include "class-matrix.hpp"
+#include "class-bint.hpp"
+#include "parallel.hpp"
+
+namespace Diamond {
+
+/**
+ * Minimum number of output cells handed to one worker thread.
+ */
+const size_t BINT_CELLS_PER_THREAD = 16;
+
+/**
+ * Multiplication of two big-integer matrics.
+ * Each output cell is a dot product accumulated in one BintAccumulator,
+ * so no temporary Bint is created per term; the cells are split across
+ * threads, each thread reusing its own accumulator.
+ */
+inline Matrix<Util::Bint> operator*(const Matrix<Util::Bint> &a, const Matrix<Util::Bint> &b)
+{
+	if (a.ColSize() != b.RowSize()) {
+		throw std::invalid_argument("different matrics\'s sizes");
+	}
+	const size_t rows = a.RowSize(), cols = b.ColSize(), inner = a.ColSize();
+	const size_t cells = rows * cols;
+	Matrix<Util::Bint> c(rows, cols);
+
+	auto work = [&](size_t from, size_t to) {
+		Util::BintAccumulator acc;
+		for (size_t cell = from; cell < to; ++cell) {
+			size_t i = cell / cols, j = cell % cols;
+			acc.Reset();
+			for (size_t k = 0; k < inner; ++k) {
+				acc.AddProduct(a[i][k], b[k][j]);
+			}
+			c[i][j] = acc.Result();
+		}
+	};
+
+	Util::ParallelFor(cells, BINT_CELLS_PER_THREAD, 0, work);
+	return c;
+}
+
+}
+#endif
@@ -5,6 +5,16 @@
 #include <iomanip>
 #include <vector>
 #include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <charconv>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+#include "tuning.hpp"
+#include "parallel.hpp"
 
 namespace Diamond {
 
@@ -72,6 +82,13 @@ public:
 	{
 		return ConstRowProxy(this->data[Kth]);
 	}
+	/**
+	 * Exchanges two rows in constant time.
+	 */
+	void SwapRows(const size_t &x, const size_t &y)
+	{
+		this->data[x].swap(this->data[y]);
+	}
 	~Matrix() = default;
 };
 
@@ -146,25 +163,51 @@ Matrix<_Td> operator-(Matrix<_Td> &&mat)
 }
 
 /**
- * Multiplication of two matrics.
+ * Multiplication of two matrics, blocked into tiles of tileRows rows of
+ * the result, tileInner steps of the inner dimension and tileCols columns
+ * of the result. Inner tiles are visited in order, so every cell is still
+ * summed over k from first to last.
  */
 template<typename _Td>
-Matrix<_Td> operator*(const Matrix<_Td> &a, const Matrix<_Td> &b)
+Matrix<_Td> Multiply(const Matrix<_Td> &a, const Matrix<_Td> &b, size_t tileRows, size_t tileInner, size_t tileCols)
 {
 	if (a.ColSize() != b.RowSize()) {
 		throw std::invalid_argument("different matrics\'s sizes");
 	}
-	Matrix<_Td> c(a.RowSize(), b.ColSize(), 0);
-	for (size_t i = 0; i < a.RowSize(); ++i) {
-		for (size_t j = 0; j < b.ColSize(); ++j) {
-			for (size_t k = 0; k < a.ColSize(); ++k) {
-				c[i][j] += a[i][k] * b[k][j];
+	if (tileRows == 0 || tileInner == 0 || tileCols == 0) {
+		throw std::invalid_argument("empty tile");
+	}
+	const size_t rows = a.RowSize(), inner = a.ColSize(), cols = b.ColSize();
+	Matrix<_Td> c(rows, cols, 0);
+	for (size_t i0 = 0; i0 < rows; i0 += tileRows) {
+		const size_t i1 = std::min(rows, i0 + tileRows);
+		for (size_t k0 = 0; k0 < inner; k0 += tileInner) {
+			const size_t k1 = std::min(inner, k0 + tileInner);
+			for (size_t j0 = 0; j0 < cols; j0 += tileCols) {
+				const size_t j1 = std::min(cols, j0 + tileCols);
+				for (size_t i = i0; i < i1; ++i) {
+					for (size_t k = k0; k < k1; ++k) {
+						const _Td &aik = a[i][k];
+						for (size_t j = j0; j < j1; ++j) {
+							c[i][j] += aik * b[k][j];
+						}
+					}
+				}
 			}
 		}
 	}
 	return c;
 }
 
+/**
+ * Multiplication of two matrics, with the tile sizes from tuning.hpp.
+ */
+template<typename _Td>
+Matrix<_Td> operator*(const Matrix<_Td> &a, const Matrix<_Td> &b)
+{
+	return Multiply(a, b, DIAMOND_MATRIX_TILE_ROWS, DIAMOND_MATRIX_TILE_INNER, DIAMOND_MATRIX_TILE_COLS);
+}
+
 /**
  * Operations between a number and a matrix;
  */
@@ -216,11 +259,147 @@ Matrix<_Td> Transpose(const Matrix<_Td> &a)
 	return res;
 }
 
+/**
+ * Writes x to [out, end) in fixed notation with precision digits after
+ * the point, or with precision < 0 as the shortest text that reads back
+ * as x. Returns the end of what was written.
+ */
+template<typename _Tf>
+char *FormatFloat(char *out, char *end, const _Tf &x, int precision)
+{
+	std::to_chars_result res = precision < 0 ? std::to_chars(out, end, x)
+		: std::to_chars(out, end, x, std::chars_format::fixed, precision);
+	if (res.ec != std::errc()) {
+		throw std::length_error("buffer too small");
+	}
+	return res.ptr;
+}
+
+/**
+ * Cells that std::to_chars can format; other types go through a stream.
+ */
+template<typename _Td>
+struct FastCell : std::integral_constant<bool, std::is_floating_point<_Td>::value
+	|| (std::is_integral<_Td>::value && sizeof(_Td) > 1 && !std::is_same<_Td, bool>::value
+		&& !std::is_same<_Td, wchar_t>::value && !std::is_same<_Td, char16_t>::value
+		&& !std::is_same<_Td, char32_t>::value)> {};
+
+/**
+ * Text of a matrix built in one buffer and written in large pieces.
+ */
+class MatrixWriter {
+	std::ostream &stream;
+	std::string buffer;
+	std::string scratch;
+	std::ostringstream slow;
+	int precision;
+	int width;
+	char fill;
+
+	template<typename _Td>
+	void _Cell(const _Td &x, std::true_type)
+	{
+		// room for the longest fixed text of the type
+		const size_t room = std::numeric_limits<_Td>::max_exponent10 + std::numeric_limits<_Td>::digits10
+			+ (precision > 0 ? precision : 0) + 16;
+		if (scratch.size() < room) {
+			scratch.resize(room);
+		}
+		char *text = &scratch[0], *end;
+		if constexpr (std::is_floating_point<_Td>::value) {
+			end = FormatFloat(text, text + room, x, precision);
+		} else {
+			end = std::to_chars(text, text + room, x).ptr;
+		}
+		_Pad(end - text);
+		buffer.append(text, end);
+	}
+	template<typename _Td>
+	void _Cell(const _Td &x, std::false_type)
+	{
+		slow.str(std::string());
+		slow << x;
+		const std::string &text = slow.str();
+		_Pad(text.size());
+		buffer += text;
+	}
+	void _Pad(size_t len)
+	{
+		if (width > 0 && static_cast<size_t>(width) > len) {
+			buffer.append(width - len, fill);
+		}
+	}
+public:
+	static const size_t FLUSH_SIZE = 1 << 16;
+
+	MatrixWriter(std::ostream &_stream, int _precision, int _width)
+		: stream(_stream), precision(_precision), width(_width), fill(_stream.fill())
+	{
+		slow.precision(precision < 0 ? 6 : precision);
+		if (precision >= 0) {
+			slow.setf(std::ios::fixed);
+		}
+	}
+	~MatrixWriter()
+	{
+		Flush();
+	}
+	template<typename _Td>
+	void Write(const Matrix<_Td> &mat)
+	{
+		buffer += '\n';
+		for (size_t i = 0; i < mat.RowSize(); ++i) {
+			for (size_t j = 0; j < mat.ColSize(); ++j) {
+				_Cell(mat[i][j], FastCell<_Td>());
+			}
+			buffer += '\n';
+			if (buffer.size() >= FLUSH_SIZE) {
+				Flush();
+			}
+		}
+	}
+	void Flush()
+	{
+		stream.write(buffer.data(), buffer.size());
+		buffer.clear();
+	}
+};
+
+/**
+ * Writes mat as operator<< lays it out, every cell right aligned in
+ * width characters padded with the fill character of stream; floating
+ * point cells in fixed notation with precision digits, or shortest with
+ * precision < 0.
+ */
+template<typename _Td>
+void WriteMatrix(std::ostream &stream, const Matrix<_Td> &mat, int precision = 8, int width = 15)
+{
+	MatrixWriter writer(stream, precision, width);
+	writer.Write(mat);
+}
+
+/**
+ * WriteMatrix() for every matrix of [first, last), through one buffer.
+ */
+template<class InputIt>
+void WriteMatrices(std::ostream &stream, InputIt first, InputIt last, int precision = 8, int width = 15)
+{
+	MatrixWriter writer(stream, precision, width);
+	for (; first != last; ++first) {
+		writer.Write(*first);
+	}
+}
+
 template<typename _Td>
 std::ostream & operator<<(std::ostream &stream, const Matrix<_Td> &mat)
 {
-	std::ostream::fmtflags oldFlags = stream.flags();
 	stream.precision(8);
+	if (FastCell<_Td>::value) {
+		WriteMatrix(stream, mat, 8, 15);
+		return stream;
+	}
+
+	std::ostream::fmtflags oldFlags = stream.flags();
 	stream.setf(std::ios::fixed | std::ios::right);
 
 	stream << '\n';
@@ -262,5 +441,327 @@ Matrix<_Td> Pow(Matrix<_Td> A, size_t &b)
 	return result;
 }
 
+
+/**
+ * Minimum number of rows (columns when solving) handed to one worker
+ * thread by the factorizations, and of cells for a Bareiss step.
+ */
+const size_t LU_LINES_PER_THREAD = 32;
+const size_t BAREISS_CELLS_PER_THREAD = 256;
+
+/**
+ * LU factorization with partial pivoting: row i of the factored matrix is
+ * row perm[i] of the original, and lu holds U on and above the diagonal
+ * and L, whose diagonal is all ones, below it. sign is the sign of the
+ * permutation; singular is set when a column had no nonzero pivot.
+ */
+template<typename _Td>
+struct LUFactors {
+	Matrix<_Td> lu;
+	std::vector<size_t> perm;
+	int sign = 1;
+	bool singular = false;
+};
+
+/**
+ * Blocked right-looking LU factorization of a square floating point
+ * matrix. Panels of block columns are factored with row pivoting, then
+ * the rest of the matrix takes the panel's rank-block update as one
+ * tiled multiply, split by rows across threads (0 for one per hardware
+ * thread).
+ */
+template<typename _Td>
+LUFactors<_Td> LUDecompose(const Matrix<_Td> &a, size_t block = DIAMOND_MATRIX_LU_BLOCK, size_t threads = 0)
+{
+	static_assert(std::is_floating_point<_Td>::value, "LU needs floating point cells; use Bareiss for exact ones");
+	if (a.RowSize() != a.ColSize()) {
+		throw std::invalid_argument("The row size and column size are different.");
+	}
+	if (block == 0) {
+		throw std::invalid_argument("empty block");
+	}
+	const size_t n = a.RowSize();
+	LUFactors<_Td> f;
+	f.lu = a;
+	f.perm.resize(n);
+	for (size_t i = 0; i < n; ++i) {
+		f.perm[i] = i;
+	}
+	Matrix<_Td> &lu = f.lu;
+
+	for (size_t k0 = 0; k0 < n; k0 += block) {
+		const size_t k1 = std::min(n, k0 + block);
+		// the panel: columns k0 .. k1 of every row from k0 down
+		for (size_t k = k0; k < k1; ++k) {
+			size_t p = k;
+			for (size_t i = k + 1; i < n; ++i) {
+				if (std::abs(lu[i][k]) > std::abs(lu[p][k])) {
+					p = i;
+				}
+			}
+			if (lu[p][k] == _Td(0)) {
+				f.singular = true;
+				continue;
+			}
+			if (p != k) {
+				lu.SwapRows(p, k);
+				std::swap(f.perm[p], f.perm[k]);
+				f.sign = -f.sign;
+			}
+			const _Td *rk = &lu[k][0];
+			for (size_t i = k + 1; i < n; ++i) {
+				_Td *ri = &lu[i][0];
+				const _Td lik = ri[k] /= rk[k];
+				for (size_t j = k + 1; j < k1; ++j) {
+					ri[j] -= lik * rk[j];
+				}
+			}
+		}
+		if (k1 == n) {
+			break;
+		}
+		// U of the block row: the panel's unit lower triangle applied to its right
+		for (size_t k = k0; k < k1; ++k) {
+			const _Td *rk = &lu[k][0];
+			for (size_t i = k + 1; i < k1; ++i) {
+				_Td *ri = &lu[i][0];
+				const _Td lik = ri[k];
+				for (size_t j = k1; j < n; ++j) {
+					ri[j] -= lik * rk[j];
+				}
+			}
+		}
+		// the trailing matrix minus L of the panel times U of the block row
+		Util::ParallelFor(n - k1, LU_LINES_PER_THREAD, threads, [&](size_t from, size_t to) {
+			for (size_t j0 = k1; j0 < n; j0 += DIAMOND_MATRIX_TILE_COLS) {
+				const size_t j1 = std::min(n, j0 + DIAMOND_MATRIX_TILE_COLS);
+				for (size_t i = k1 + from; i < k1 + to; ++i) {
+					_Td *ri = &lu[i][0];
+					for (size_t k = k0; k < k1; ++k) {
+						const _Td lik = ri[k];
+						const _Td *rk = &lu[k][0];
+						for (size_t j = j0; j < j1; ++j) {
+							ri[j] -= lik * rk[j];
+						}
+					}
+				}
+			}
+		});
+	}
+	return f;
+}
+
+/**
+ * Solution x of a x = b for the factors of a, one column per column of b.
+ * The columns are split across threads.
+ */
+template<typename _Td>
+Matrix<_Td> Solve(const LUFactors<_Td> &f, const Matrix<_Td> &b, size_t threads = 0)
+{
+	const size_t n = f.lu.RowSize(), m = b.ColSize();
+	if (b.RowSize() != n) {
+		throw std::invalid_argument("different matrics\'s sizes");
+	}
+	if (f.singular) {
+		throw std::domain_error("singular matrix");
+	}
+	Matrix<_Td> x(n, m);
+	if (m == 0) {
+		return x;
+	}
+	for (size_t i = 0; i < n; ++i) {
+		std::copy(&b[f.perm[i]][0], &b[f.perm[i]][0] + m, &x[i][0]);
+	}
+	Util::ParallelFor(m, LU_LINES_PER_THREAD, threads, [&](size_t from, size_t to) {
+		for (size_t i = 0; i < n; ++i) {
+			_Td *xi = &x[i][0];
+			for (size_t k = 0; k < i; ++k) {
+				const _Td lik = f.lu[i][k];
+				const _Td *xk = &x[k][0];
+				for (size_t j = from; j < to; ++j) {
+					xi[j] -= lik * xk[j];
+				}
+			}
+		}
+		for (size_t i = n; i-- > 0;) {
+			_Td *xi = &x[i][0];
+			for (size_t k = i + 1; k < n; ++k) {
+				const _Td uik = f.lu[i][k];
+				const _Td *xk = &x[k][0];
+				for (size_t j = from; j < to; ++j) {
+					xi[j] -= uik * xk[j];
+				}
+			}
+			const _Td uii = f.lu[i][i];
+			for (size_t j = from; j < to; ++j) {
+				xi[j] /= uii;
+			}
+		}
+	});
+	return x;
+}
+
+/**
+ * Solution x of a x = b, for floating point cells.
+ */
+template<typename _Td>
+Matrix<_Td> Solve(const Matrix<_Td> &a, const Matrix<_Td> &b)
+{
+	return Solve(LUDecompose(a), b);
+}
+
+template<typename _Td>
+Matrix<_Td> Inverse(const Matrix<_Td> &a)
+{
+	return Solve(LUDecompose(a), I<_Td>(a.RowSize()));
+}
+
+/**
+ * Exact quotient of a by b, for divisions known to leave no remainder.
+ * It is called unqualified, so a type with an exact_div of its own, as
+ * Util::Bint has, gets that one by argument-dependent lookup wherever
+ * the type is complete.
+ */
+template<typename _Td>
+_Td exact_div(const _Td &a, const _Td &b)
+{
+	return a / b;
+}
+
+/**
+ * Fraction-free Gaussian elimination (Bareiss) of the first n columns of
+ * m, whose other columns are carried along. Every cell stays a minor of
+ * the input, so exact cells never leave their ring; after the step of
+ * column k, m[k][k] is the leading minor of order k + 1 of the row-swapped
+ * input. Rows are swapped only past a zero pivot, flipping sign. Returns
+ * false, with the elimination unfinished, if the n columns are singular.
+ */
+template<typename _Td>
+bool BareissEliminate(Matrix<_Td> &m, const size_t &n, int &sign, size_t threads = 0)
+{
+	const size_t cols = m.ColSize();
+	const _Td zero = static_cast<_Td>(0);
+	_Td prev = static_cast<_Td>(1);
+	sign = 1;
+	for (size_t k = 0; k < n; ++k) {
+		if (m[k][k] == zero) {
+			size_t p = k + 1;
+			while (p < n && m[p][k] == zero) {
+				++p;
+			}
+			if (p == n) {
+				return false;
+			}
+			m.SwapRows(p, k);
+			sign = -sign;
+		}
+		const size_t rows = n - k - 1;
+		const size_t grain = std::max<size_t>(1, BAREISS_CELLS_PER_THREAD / std::max<size_t>(1, cols - k));
+		Util::ParallelFor(rows, grain, threads, [&](size_t from, size_t to) {
+			const _Td *rk = &m[k][0];
+			for (size_t i = k + 1 + from; i < k + 1 + to; ++i) {
+				_Td *ri = &m[i][0];
+				for (size_t j = k + 1; j < cols; ++j) {
+					ri[j] = exact_div(ri[j] * rk[k] - ri[k] * rk[j], prev);
+				}
+				ri[k] = zero;
+			}
+		});
+		prev = m[k][k];
+	}
+	return true;
+}
+
+/**
+ * Fraction-free solution of a x = b: returns y and det with a y = det b,
+ * so x = y / det, every cell of y exact. Throws for singular a.
+ */
+template<typename _Td>
+Matrix<_Td> BareissSolve(const Matrix<_Td> &a, const Matrix<_Td> &b, _Td &det, size_t threads = 0)
+{
+	if (a.RowSize() != a.ColSize()) {
+		throw std::invalid_argument("The row size and column size are different.");
+	}
+	if (b.RowSize() != a.RowSize()) {
+		throw std::invalid_argument("different matrics\'s sizes");
+	}
+	const size_t n = a.RowSize(), m = b.ColSize();
+	Matrix<_Td> w(n, n + m);
+	for (size_t i = 0; i < n; ++i) {
+		for (size_t j = 0; j < n; ++j) {
+			w[i][j] = a[i][j];
+		}
+		for (size_t j = 0; j < m; ++j) {
+			w[i][n + j] = b[i][j];
+		}
+	}
+	int sign;
+	if (!BareissEliminate(w, n, sign, threads)) {
+		throw std::domain_error("singular matrix");
+	}
+	const _Td d = n > 0 ? w[n - 1][n - 1] : static_cast<_Td>(1);
+	det = sign < 0 ? -d : d;
+	// back substitution of det b: y = det x is exact, so every division by a pivot is too
+	Matrix<_Td> y(n, m);
+	Util::ParallelFor(m, std::max<size_t>(1, BAREISS_CELLS_PER_THREAD / std::max<size_t>(1, n)), threads,
+		[&](size_t from, size_t to) {
+			for (size_t j = from; j < to; ++j) {
+				for (size_t i = n; i-- > 0;) {
+					_Td s = det * w[i][n + j];
+					for (size_t k = i + 1; k < n; ++k) {
+						s = s - w[i][k] * y[k][j];
+					}
+					y[i][j] = exact_div(s, w[i][i]);
+				}
+			}
+		});
+	return y;
+}
+
+/**
+ * Adjugate of a, the exact inverse scaled by det: a adj = det I.
+ * Throws for singular a.
+ */
+template<typename _Td>
+Matrix<_Td> Adjugate(const Matrix<_Td> &a, _Td &det)
+{
+	return BareissSolve(a, I<_Td>(a.RowSize()), det);
+}
+
+/**
+ * Determinant: from the LU factors for floating point cells, by Bareiss
+ * elimination for exact ones (integers, Util::Bint), where no cell
+ * grows past a minor of a.
+ */
+template<typename _Td>
+_Td Det(const Matrix<_Td> &a)
+{
+	if (a.RowSize() != a.ColSize()) {
+		throw std::invalid_argument("The row size and column size are different.");
+	}
+	const size_t n = a.RowSize();
+	if constexpr (std::is_floating_point<_Td>::value) {
+		LUFactors<_Td> f = LUDecompose(a);
+		if (f.singular) {
+			return static_cast<_Td>(0);
+		}
+		_Td det = static_cast<_Td>(f.sign);
+		for (size_t i = 0; i < n; ++i) {
+			det *= f.lu[i][i];
+		}
+		return det;
+	} else {
+		if (n == 0) {
+			return static_cast<_Td>(1);
+		}
+		Matrix<_Td> m(a);
+		int sign;
+		if (!BareissEliminate(m, n, sign)) {
+			return static_cast<_Td>(0);
+		}
+		return sign < 0 ? -m[n - 1][n - 1] : m[n - 1][n - 1];
+	}
+}
+
 }
 #endif
@@ -0,0 +1,143 @@
+// Batched products over lists of small matrices
+
+#include "class-matrix-batch.hpp"
+#include "list.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+typedef Diamond::Matrix<unsigned long long> Matrix;
+
+Matrix randomMatrix(size_t rows, size_t cols) {
+    Matrix m(rows, cols);
+    for (size_t i = 0; i < rows; ++i)
+        for (size_t j = 0; j < cols; ++j)
+            m[i][j] = rand() % 7;
+    return m;
+}
+
+bool testBatchMultiply() {
+    size_t shapes[][3] = {{2, 2, 2}, {3, 3, 3}, {4, 4, 4}, {2, 3, 4}, {4, 1, 3}, {5, 6, 2}, {7, 7, 7}};
+    for (auto &shape : shapes) {
+        sjtu::list<Matrix> lhs, rhs;
+        for (int i = 0; i < 600; ++i) {
+            lhs.push_back(randomMatrix(shape[0], shape[1]));
+            rhs.push_back(randomMatrix(shape[1], shape[2]));
+        }
+        sjtu::list<Matrix> product = Diamond::BatchMultiply(lhs, rhs);
+        if (product.size() != lhs.size())
+            return false;
+        sjtu::list<Matrix>::const_iterator a = lhs.cbegin(), b = rhs.cbegin(), c = product.cbegin();
+        for (; a != lhs.cend(); ++a, ++b, ++c)
+            if (!(*c == *a * *b))
+                return false;
+    }
+    return Diamond::BatchMultiply(sjtu::list<Matrix>(), sjtu::list<Matrix>()).empty();
+}
+
+bool testBatchTransform() {
+    Matrix t = randomMatrix(3, 4);
+    sjtu::list<Matrix> xs;
+    for (int i = 0; i < 1000; ++i)
+        xs.push_back(randomMatrix(4, 2));
+    sjtu::list<Matrix> ys = Diamond::BatchTransform(t, xs);
+    sjtu::list<Matrix>::const_iterator x = xs.cbegin(), y = ys.cbegin();
+    for (; x != xs.cend(); ++x, ++y)
+        if (!(*y == t * *x))
+            return false;
+    return ys.size() == xs.size();
+}
+
+bool testChainProduct() {
+    for (size_t n = 1; n <= 6; ++n) {
+        for (int len = 1; len <= 40; len += 13) {
+            sjtu::list<Matrix> chain;
+            Matrix expect = Diamond::I<unsigned long long>(n);
+            for (int i = 0; i < len; ++i) {
+                chain.push_back(randomMatrix(n, n));
+                expect = expect * chain.back();
+            }
+            if (!(Diamond::ChainProduct(chain) == expect))
+                return false;
+            if (!(Diamond::ChainProduct(chain, true) == expect))
+                return false;
+        }
+    }
+    return true;
+}
+
+bool testShapeErrors() {
+    int caught = 0;
+    sjtu::list<Matrix> lhs, rhs;
+    lhs.push_back(randomMatrix(2, 2));
+    lhs.push_back(randomMatrix(2, 3));
+    rhs.push_back(randomMatrix(2, 2));
+    rhs.push_back(randomMatrix(2, 2));
+    try { Diamond::BatchMultiply(lhs, rhs); } catch (std::invalid_argument &) { caught++; }
+    rhs.pop_back();
+    try { Diamond::BatchMultiply(lhs, rhs); } catch (std::invalid_argument &) { caught++; }
+    try { Diamond::ChainProduct(sjtu::list<Matrix>()); } catch (std::invalid_argument &) { caught++; }
+    sjtu::list<Matrix> chain;
+    chain.push_back(randomMatrix(2, 3));
+    try { Diamond::ChainProduct(chain); } catch (std::invalid_argument &) { caught++; }
+    return caught == 4;
+}
+
+// every index is visited once, whatever the thread count, and a throwing range is reported
+bool testParallelFor() {
+    const size_t counts[] = {0, 1, 7, 100, 1000};
+    for (size_t count : counts) {
+        for (size_t threads = 1; threads <= 5; ++threads) {
+            std::vector<std::atomic<int>> hits(count);
+            Util::ParallelFor(count, 3, threads, [&](size_t from, size_t to) {
+                for (size_t i = from; i < to; ++i)
+                    hits[i]++;
+            });
+            for (size_t i = 0; i < count; ++i)
+                if (hits[i] != 1)
+                    return false;
+        }
+    }
+    std::atomic<size_t> done(0);
+    try {
+        Util::ParallelFor(1000, 10, 4, [&](size_t from, size_t to) {
+            if (from <= 600 && 600 < to)
+                throw std::runtime_error("range failed");
+            done += to - from;
+        });
+        return false;
+    } catch (std::runtime_error &) {}
+    return done == 750;
+}
+
+int main(){
+    srand(20220207);
+    bool (*testList[])() = {
+            testBatchMultiply, testBatchTransform, testChainProduct, testShapeErrors, testParallelFor
+    };
+    const char* Messages[] = {
+            "Test 1: Testing BatchMultiply()...",
+            "Test 2: Testing BatchTransform()...",
+            "Test 3: Testing ChainProduct() as fold and as tree...",
+            "Test 4: Testing shape checks...",
+            "Test 5: Testing the shared ParallelFor..."
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
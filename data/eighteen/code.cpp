@@ -0,0 +1,175 @@
+// pair_list: keys in packed nodes, values out of line
+
+#include "pair_list.hpp"
+
+#include <iostream>
+#include <list>
+#include <string>
+#include <utility>
+
+const int N = 5e4;
+
+int alive = 0, copies = 0;
+class Payload {
+public:
+    int tag;
+    char bytes[240];
+    Payload(int t) : tag(t) { alive++; }
+    Payload(const Payload &other) : tag(other.tag) { alive++, copies++; }
+    ~Payload() { alive--; }
+    bool operator==(const Payload &rhs) const { return tag == rhs.tag; }
+};
+
+typedef sjtu::pair_list<int, Payload> PairList;
+typedef std::list<std::pair<int, int>> Reference;
+
+bool equal(const Reference &x, const PairList &y) {
+    if (x.size() != y.size())
+        return false;
+
+    Reference::const_iterator itx = x.cbegin();
+    PairList::const_iterator ity = y.cbegin();
+    for (; itx != x.cend() && ity != y.cend(); ++itx, ++ity)
+        if (itx->first != ity->first || itx->second != (*ity).second.tag)
+            return false;
+
+    return true;
+}
+
+bool testRandomOperations() {
+    Reference ans;
+    PairList myList;
+    for (int i = 0; i < N; ++i) {
+        int op = rand() % 8, key = rand() % 100, tag = rand();
+        if (op < 2) {
+            ans.push_back({key, tag}), myList.push_back(sjtu::pair<int, Payload>(key, Payload(tag)));
+        } else if (op < 3) {
+            ans.push_front({key, tag}), myList.push_front(sjtu::pair<int, Payload>(key, Payload(tag)));
+        } else if (op < 4 && !ans.empty()) {
+            ans.pop_back(), myList.pop_back();
+        } else if (op < 5 && !ans.empty()) {
+            ans.pop_front(), myList.pop_front();
+        } else if (op < 7) {
+            Reference::iterator itx = ans.begin();
+            PairList::iterator ity = myList.begin();
+            for (int k = rand() % (ans.size() + 1) % 30; k > 0 && itx != ans.end(); --k)
+                ++itx, ++ity;
+            if (op == 5 || itx == ans.end()) {
+                ans.insert(itx, {key, tag}), myList.insert(ity, sjtu::pair<int, Payload>(key, Payload(tag)));
+            } else {
+                ans.erase(itx), myList.erase(ity);
+            }
+        } else if (!ans.empty()) {
+            ans.front().second = tag, myList.front().second.tag = tag;
+            ans.back().second ^= 1, (--myList.end())->second.tag ^= 1;
+        }
+        if (i % 1000 == 0 && !equal(ans, myList))
+            return false;
+    }
+    return equal(ans, myList);
+}
+
+bool testKeyAlgorithms() {
+    Reference ans, other;
+    PairList myList, myOther;
+    for (int i = 0; i < N / 5; ++i) {
+        int key = rand() % 500, tag = rand();
+        ans.push_back({key, tag}), myList.push_back(sjtu::pair<int, Payload>(key, Payload(tag)));
+        key = rand() % 500, tag = rand();
+        other.push_back({key, tag}), myOther.push_back(sjtu::pair<int, Payload>(key, Payload(tag)));
+    }
+    int before = copies;
+    auto byKey = [](const std::pair<int, int> &a, const std::pair<int, int> &b) { return a.first < b.first; };
+    ans.sort(byKey), other.sort(byKey);
+    myList.sort(), myOther.sort();
+    if (!equal(ans, myList) || !equal(other, myOther))
+        return false;
+    ans.merge(other, byKey);
+    myList.merge(myOther);
+    if (!equal(ans, myList) || !myOther.empty())
+        return false;
+    ans.unique([](const std::pair<int, int> &a, const std::pair<int, int> &b) { return a.first == b.first; });
+    myList.unique();
+    if (!equal(ans, myList) || copies != before)
+        return false;
+    for (int k = 0; k < 1000; ++k) {
+        int key = rand() % 600;
+        Reference::iterator itx = ans.begin();
+        while (itx != ans.end() && itx->first != key)
+            ++itx;
+        PairList::iterator ity = myList.find(key);
+        if ((itx == ans.end()) != (ity == myList.end()) || (ity != myList.end() && ity->second.tag != itx->second))
+            return false;
+        if (myList.count(key) != (itx == ans.end() ? 0u : 1u))
+            return false;
+    }
+    return copies == before;
+}
+
+bool testConversions() {
+    sjtu::pair_list<std::string, std::string> myList;
+    myList.push_back(sjtu::pair<std::string, std::string>(std::string("b"), std::string("second")));
+    myList.push_front(sjtu::pair<std::string, std::string>(std::string("a"), std::string("first")));
+    sjtu::pair<std::string, std::string> p = *myList.begin();
+    const sjtu::pair_list<std::string, std::string> copy(myList);
+    sjtu::pair<std::string, std::string> q = copy.back();
+    sjtu::pair_list<std::string, std::string>::const_iterator it = myList.begin();
+    int caught = 0;
+    try { --it; } catch (sjtu::invalid_iterator &) { caught++; }
+    try { *myList.end(); } catch (sjtu::invalid_iterator &) { caught++; }
+    try { myList.erase(myList.end()); } catch (sjtu::invalid_iterator &) { caught++; }
+    if (it.key() != "a")
+        return false;
+    myList.clear();
+    try { myList.pop_front(); } catch (sjtu::container_is_empty &) { caught++; }
+    return caught == 4 && p.first == "a" && p.second == "first" && q.first == "b" && q.second == "second"
+        && myList.empty() && copy.size() == 2;
+}
+
+bool testOwnership() {
+    {
+        PairList myList;
+        for (int i = 0; i < 1000; ++i)
+            myList.push_back(sjtu::pair<int, Payload>(rand() % 10, Payload(i)));
+        PairList copy(myList), assigned;
+        assigned.push_back(sjtu::pair<int, Payload>(1, Payload(1)));
+        assigned = copy;
+        copy.sort();
+        copy.unique();
+        myList.merge(copy);
+        for (int i = 0; i < 500; ++i)
+            assigned.pop_front();
+        if (myList.size() != 1010 || alive != 1010 + 500 || !copy.empty())
+            return false;
+    }
+    return alive == 0;
+}
+
+int main(){
+    srand(20220207);
+    bool (*testList[])() = {
+            testRandomOperations, testKeyAlgorithms, testConversions, testOwnership
+    };
+    const char* Messages[] = {
+            "Test 1: Testing random operations against std::list...",
+            "Test 2: Testing sort(), merge(), unique() and find() by key...",
+            "Test 3: Testing references, copies and invalid iterators...",
+            "Test 4: Testing that values are freed..."
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
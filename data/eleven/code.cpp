@@ -0,0 +1,177 @@
+// sorted_list: skip list order, bounds and conversion from and to list
+
+#include "sorted_list.hpp"
+#include "list.hpp"
+
+#include <iostream>
+#include <set>
+#include <vector>
+
+const int N = 1e5;
+
+template<typename T>
+bool equal(const std::multiset<T> &x, const sjtu::sorted_list<T> &y) {
+    if (x.size() != y.size())
+        return false;
+
+    typename std::multiset<T>::const_iterator itx = x.cbegin();
+    typename sjtu::sorted_list<T>::const_iterator ity = y.cbegin();
+    for (; itx != x.cend() && ity != y.cend(); ++itx, ++ity)
+        if (!(*itx == *ity))
+            return false;
+
+    return true;
+}
+
+class Tagged {
+public:
+    int key, id;
+    Tagged(int k, int i) : key(k), id(i) {}
+    bool operator<(const Tagged &rhs) const { return key < rhs.key; }
+};
+
+bool testInsertErase() {
+    std::multiset<int> ans;
+    sjtu::sorted_list<int> myList;
+    for (int i = 0; i < N; ++i) {
+        int x = rand() % 5000;
+        if (rand() % 3 || myList.empty()) {
+            ans.insert(x);
+            myList.insert(x);
+        } else {
+            sjtu::sorted_list<int>::iterator it = myList.find(x);
+            if ((it == myList.end()) != (ans.find(x) == ans.end()))
+                return false;
+            if (it != myList.end()) {
+                myList.erase(it);
+                ans.erase(ans.find(x));
+            }
+        }
+    }
+    return equal(ans, myList);
+}
+
+bool testBounds() {
+    std::multiset<int> ans;
+    sjtu::sorted_list<int> myList;
+    for (int i = 0; i < N; ++i) {
+        int x = rand() % 20000;
+        ans.insert(x);
+        myList.insert(x);
+    }
+    for (int i = 0; i < N; ++i) {
+        int x = rand() % 20002 - 1;
+        std::multiset<int>::iterator lo = ans.lower_bound(x), hi = ans.upper_bound(x);
+        sjtu::sorted_list<int>::iterator myLo = myList.lower_bound(x), myHi = myList.upper_bound(x);
+        if ((lo == ans.end()) != (myLo == myList.end()) || (hi == ans.end()) != (myHi == myList.end()))
+            return false;
+        if (lo != ans.end() && *lo != *myLo)
+            return false;
+        if (hi != ans.end() && *hi != *myHi)
+            return false;
+    }
+    return true;
+}
+
+bool testStableOrder() {
+    sjtu::sorted_list<Tagged> myList;
+    for (int i = 0; i < 10000; ++i)
+        myList.insert(Tagged(rand() % 10, i));
+    sjtu::sorted_list<Tagged>::iterator it = myList.begin(), prev = it++;
+    for (; it != myList.end(); prev = it++)
+        if (it->key < prev->key || (it->key == prev->key && it->id < prev->id))
+            return false;
+    it = myList.end();
+    size_t count = 0;
+    while (it != myList.begin()) {
+        --it;
+        count++;
+    }
+    return count == myList.size();
+}
+
+bool testConversion() {
+    sjtu::list<int> source;
+    std::multiset<int> ans;
+    std::set<const int *> addresses;
+    for (int i = 0; i < N; ++i) {
+        int x = rand();
+        source.push_back(x);
+        ans.insert(x);
+    }
+    for (sjtu::list<int>::const_iterator it = source.cbegin(); it != source.cend(); ++it)
+        addresses.insert(&*it);
+    sjtu::sorted_list<int> myList(std::move(source));
+    if (!source.empty() || !equal(ans, myList))
+        return false;
+    for (sjtu::sorted_list<int>::iterator it = myList.begin(); it != myList.end(); ++it)
+        if (!addresses.count(&*it))
+            return false;
+    for (int i = 0; i < 1000; ++i) {
+        int x = rand();
+        ans.insert(x);
+        myList.insert(x);
+    }
+    sjtu::list<int> back;
+    back.push_back(-1);
+    myList.splice_into(back);
+    if (!myList.empty() || back.size() != ans.size() + 1 || back.front() != -1)
+        return false;
+    back.pop_front();
+    std::multiset<int>::iterator itx = ans.begin();
+    for (sjtu::list<int>::const_iterator it = back.cbegin(); it != back.cend(); ++it, ++itx)
+        if (*it != *itx)
+            return false;
+    myList.insert(3);
+    return myList.size() == 1 && myList.front() == 3;
+}
+
+bool testCopyAndExceptions() {
+    sjtu::sorted_list<int> a;
+    for (int i = 0; i < 1000; ++i)
+        a.insert(rand() % 100);
+    sjtu::sorted_list<int> b(a), c;
+    c = b;
+    c.erase(c.begin());
+    if (b.size() != 1000 || c.size() != 999 || !(*a.begin() == *b.begin()))
+        return false;
+    int caught = 0;
+    sjtu::sorted_list<int> empty;
+    try { empty.erase(empty.begin()); } catch (sjtu::container_is_empty &) { caught++; }
+    try { empty.front(); } catch (sjtu::container_is_empty &) { caught++; }
+    try { a.erase(a.end()); } catch (sjtu::invalid_iterator &) { caught++; }
+    try { a.erase(b.begin()); } catch (sjtu::invalid_iterator &) { caught++; }
+    try { *a.end(); } catch (sjtu::invalid_iterator &) { caught++; }
+    a.clear();
+    return caught == 5 && a.empty() && a.lower_bound(5) == a.end();
+}
+
+int main(){
+    srand(20220207);
+    bool (*testList[])() = {
+            testInsertErase, testBounds, testStableOrder, testConversion, testCopyAndExceptions
+    };
+    const char* Messages[] = {
+            "Test 1: Testing insert, find and erase...",
+            "Test 2: Testing lower_bound and upper_bound...",
+            "Test 3: Testing order of equivalent elements...",
+            "Test 4: Testing conversion from and to list...",
+            "Test 5: Testing copies and exceptions..."
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
@@ -0,0 +1,170 @@
+// buffer-based text output of Bint and Matrix against the iostream formatting
+
+#include "class-matrix.hpp"
+#include "class-bint.hpp"
+#include "list.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+std::string randomDigits(int limbs) {
+    std::string s;
+    if (rand() % 3 == 0)
+        s += '-';
+    s += char('1' + rand() % 9);
+    for (int i = 1; i < limbs * 4 - rand() % 4; ++i)
+        s += char('0' + rand() % 10);
+    return s;
+}
+
+double randomDouble() {
+    switch (rand() % 5) {
+        case 0: return (rand() - RAND_MAX / 2) / 1000.0;
+        case 1: return std::ldexp(double(rand()), rand() % 200 - 100);
+        case 2: return -std::ldexp(double(rand()), rand() % 60);
+        case 3: return (rand() % 2 ? 1 : -1) * 0.5e-8 * (rand() % 3);
+        default: return rand() % 7 == 0 ? -0.0 : double(rand() % 100);
+    }
+}
+
+// the per-element iostream formatting the writers replace
+template<typename _Td>
+std::string streamed(const Diamond::Matrix<_Td> &mat) {
+    std::ostringstream stream;
+    stream.precision(8);
+    stream.setf(std::ios::fixed | std::ios::right);
+    stream << '\n';
+    for (size_t i = 0; i < mat.RowSize(); ++i) {
+        for (size_t j = 0; j < mat.ColSize(); ++j)
+            stream << std::setw(15) << mat[i][j];
+        stream << '\n';
+    }
+    return stream.str();
+}
+
+template<typename _Td>
+std::string printed(const _Td &x) {
+    std::ostringstream stream;
+    stream << x;
+    return stream.str();
+}
+
+bool testBint() {
+    for (int round = 0; round < 2000; ++round) {
+        std::string digits = randomDigits(1 + rand() % 80);
+        Util::Bint b(digits);
+        char buffer[400];
+        if (printed(b) != digits || std::string(buffer, b.Format(buffer)) != digits)
+            return false;
+    }
+    std::ostringstream stream;
+    stream << std::setw(8) << Util::Bint(-42) << '|' << std::left << std::setw(6) << Util::Bint(7) << '|' << Util::Bint(0);
+    return stream.str() == "     -42|7     |0" && printed(Util::Bint(-0)) == "0"
+        && printed(Util::Bint(std::string("100000000"))) == "100000000";
+}
+
+bool testWriteAll() {
+    sjtu::list<Util::Bint> myList;
+    std::string expect;
+    for (int i = 0; i < 3000; ++i) {
+        std::string digits = randomDigits(1 + rand() % (i == 1000 ? 20000 : 30));
+        myList.push_back(Util::Bint(digits));
+        expect += digits + ' ';
+    }
+    std::ostringstream stream;
+    Util::WriteAll(stream, myList.cbegin(), myList.cend(), ' ');
+    return stream.str() == expect;
+}
+
+bool testMatrixDouble() {
+    for (int round = 0; round < 50; ++round) {
+        Diamond::Matrix<double> m(1 + rand() % 6, 1 + rand() % 6);
+        for (size_t i = 0; i < m.RowSize(); ++i)
+            for (size_t j = 0; j < m.ColSize(); ++j)
+                m[i][j] = randomDouble();
+        if (printed(m) != streamed(m))
+            return false;
+    }
+    Diamond::Matrix<double> huge(1, 2);
+    huge[0][0] = 1e300, huge[0][1] = -1.7976931348623157e308;
+    return printed(huge) == streamed(huge);
+}
+
+bool testMatrixOther() {
+    Diamond::Matrix<int> a(3, 4);
+    Diamond::Matrix<long long> b(2, 2);
+    Diamond::Matrix<Util::Bint> c(2, 3);
+    for (size_t i = 0; i < 3; ++i)
+        for (size_t j = 0; j < 4; ++j)
+            a[i][j] = rand() - RAND_MAX / 2;
+    b[0][0] = -9223372036854775807LL, b[1][1] = 1234567890123LL;
+    for (size_t i = 0; i < 2; ++i)
+        for (size_t j = 0; j < 3; ++j)
+            c[i][j] = Util::Bint(randomDigits(1 + rand() % 5));
+    return printed(a) == streamed(a) && printed(b) == streamed(b) && printed(c) == streamed(c);
+}
+
+bool testShortestAndBulk() {
+    sjtu::list<Diamond::Matrix<double>> myList;
+    std::string expect;
+    for (int k = 0; k < 200; ++k) {
+        Diamond::Matrix<double> m(4, 4);
+        for (size_t i = 0; i < 4; ++i)
+            for (size_t j = 0; j < 4; ++j)
+                m[i][j] = randomDouble();
+        myList.push_back(m);
+        expect += streamed(m);
+    }
+    std::ostringstream stream;
+    Diamond::WriteMatrices(stream, myList.cbegin(), myList.cend());
+    if (stream.str() != expect)
+        return false;
+    for (int round = 0; round < 5000; ++round) {
+        double x = randomDouble() * std::pow(10.0, rand() % 40 - 20);
+        char buffer[64];
+        std::string text(buffer, Diamond::FormatFloat(buffer, buffer + sizeof(buffer), x, -1));
+        if (std::strtod(text.c_str(), nullptr) != x)
+            return false;
+    }
+    char small[4];
+    try {
+        Diamond::FormatFloat(small, small + sizeof(small), 12345.678, 2);
+    } catch (std::length_error &) {
+        return true;
+    }
+    return false;
+}
+
+int main(){
+    srand(20220207);
+    bool (*testList[])() = {
+            testBint, testWriteAll, testMatrixDouble, testMatrixOther, testShortestAndBulk
+    };
+    const char* Messages[] = {
+            "Test 1: Testing Bint::Format and operator<<...",
+            "Test 2: Testing WriteAll over list<Bint>...",
+            "Test 3: Testing Matrix<double> output...",
+            "Test 4: Testing Matrix output of integers and Bint...",
+            "Test 5: Testing shortest floats and WriteMatrices..."
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
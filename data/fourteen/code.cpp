@@ -0,0 +1,130 @@
+// parallel copy of lists with heavy payloads
+
+#include "class-matrix.hpp"
+#include "class-bint.hpp"
+#include "list.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <string>
+
+template<typename T>
+bool equal(const sjtu::list<T> &x, const sjtu::list<T> &y) {
+    if (x.size() != y.size())
+        return false;
+
+    typename sjtu::list<T>::const_iterator itx = x.cbegin();
+    typename sjtu::list<T>::const_iterator ity = y.cbegin();
+    for (; itx != x.cend() && ity != y.cend(); ++itx, ++ity)
+        if (!(*itx == *ity))
+            return false;
+
+    return true;
+}
+
+std::atomic<int> alive(0), copiesLeft(-1);
+class Fragile {
+public:
+    int key;
+    Fragile(int k) : key(k) { alive++; }
+    Fragile(const Fragile &other) : key(other.key) {
+        if (copiesLeft-- == 0)
+            throw sjtu::runtime_error();
+        alive++;
+    }
+    ~Fragile() { alive--; }
+    bool operator<(const Fragile &rhs) const { return key < rhs.key; }
+    bool operator==(const Fragile &rhs) const { return key == rhs.key; }
+};
+
+bool testMatrices() {
+    sjtu::list<Diamond::Matrix<double>> myList;
+    for (int i = 0; i < 500; ++i) {
+        Diamond::Matrix<double> m(8, 8);
+        for (int r = 0; r < 8; ++r)
+            for (int c = 0; c < 8; ++c)
+                m[r][c] = rand() % 1000 / 10.0;
+        myList.push_back(m);
+    }
+    sjtu::list<Diamond::Matrix<double>> copy(myList, sjtu::parallel_policy(4));
+    sjtu::list<Diamond::Matrix<double>> serial(myList, sjtu::parallel_policy(1));
+    return equal(myList, copy) && equal(myList, serial);
+}
+
+bool testBints() {
+    sjtu::list<Util::Bint> myList;
+    for (int i = 0; i < 1000; ++i) {
+        std::string s(1, char('1' + rand() % 9));
+        for (int j = rand() % 200; j > 0; --j)
+            s += char('0' + rand() % 10);
+        myList.push_back(Util::Bint(s));
+    }
+    sjtu::list<Util::Bint> copy(myList, sjtu::parallel_policy(3));
+    sjtu::list<Util::Bint> automatic(myList, sjtu::parallel_policy());
+    copy.push_back(Util::Bint(1));
+    copy.pop_back();
+    return equal(myList, copy) && equal(myList, automatic);
+}
+
+bool testSmallAndEmpty() {
+    sjtu::list<int> empty;
+    sjtu::list<int> copy(empty, sjtu::parallel_policy(8));
+    sjtu::list<int> small;
+    for (int i = 0; i < 10; ++i)
+        small.push_back(i);
+    sjtu::list<int> smallCopy(small, sjtu::parallel_policy(8));
+    return copy.empty() && equal(small, smallCopy);
+}
+
+bool testThrowingCopy() {
+    {
+        sjtu::list<Fragile> myList;
+        for (int i = 0; i < 2000; ++i)
+            myList.push_back(Fragile(i));
+        int before = alive;
+        for (int threads = 1; threads <= 4; ++threads) {
+            copiesLeft = 1500;
+            try {
+                sjtu::list<Fragile> copy(myList, sjtu::parallel_policy(threads));
+                return false;
+            } catch (sjtu::runtime_error &) {
+            }
+            if (alive != before)
+                return false;
+        }
+        copiesLeft = -1000000;
+        sjtu::list<Fragile> copy(myList, sjtu::parallel_policy(4));
+        if (!equal(myList, copy))
+            return false;
+    }
+    return alive == 0;
+}
+
+int main(){
+    srand(20220207);
+    bool (*testList[])() = {
+            testMatrices, testBints, testSmallAndEmpty, testThrowingCopy
+    };
+    const char* Messages[] = {
+            "Test 1: Testing parallel copy of list<Matrix<double>>...",
+            "Test 2: Testing parallel copy of list<Bint>...",
+            "Test 3: Testing parallel copy of short lists...",
+            "Test 4: Testing a copy constructor that throws..."
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
@@ -0,0 +1,177 @@
+// sort() engines and the strategy chosen for each payload
+
+#include "class-matrix.hpp"
+#include "class-bint.hpp"
+#include "list.hpp"
+#include "utility.hpp"
+
+#include <iostream>
+#include <list>
+
+const int N = 5e4;
+
+template<typename T>
+bool equal(const std::list<T> &x, const sjtu::list<T> &y) {
+    if (x.size() != y.size())
+        return false;
+
+    typename std::list<T>::const_iterator itx = x.cbegin();
+    typename sjtu::list<T>::const_iterator ity = y.cbegin();
+    for (; itx != x.cend() && ity != y.cend(); ++itx, ++ity)
+        if (!(*itx == *ity))
+            return false;
+
+    return true;
+}
+
+int copies = 0;
+class Heavy {
+public:
+    int key;
+    char payload[200];
+    Heavy(int k) : key(k) {}
+    Heavy(const Heavy &other) : key(other.key) { copies++; }
+    Heavy &operator=(const Heavy &other) { key = other.key; copies++; return *this; }
+    bool operator<(const Heavy &rhs) const { return key < rhs.key; }
+    bool operator==(const Heavy &rhs) const { return key == rhs.key; }
+};
+
+bool testRadixInt() {
+    std::list<int> ans;
+    sjtu::list<int> myList;
+    for (int i = 0; i < N; ++i) {
+        int x = rand() - RAND_MAX / 2;
+        ans.push_back(x);
+        myList.push_back(x);
+    }
+    ans.sort(), myList.sort();
+    return equal(ans, myList) && myList.last_sort().strategy == sjtu::sort_strategy::radix
+        && myList.last_sort().size == N;
+}
+
+bool testRadixWide() {
+    std::list<long long> ans;
+    sjtu::list<long long> myList;
+    std::list<unsigned char> ans2;
+    sjtu::list<unsigned char> myList2;
+    for (int i = 0; i < N; ++i) {
+        long long x = (long long)rand() * rand() * (rand() % 2 ? 1 : -1);
+        ans.push_back(x);
+        myList.push_back(x);
+        ans2.push_back(rand() % 256);
+        myList2.push_back(ans2.back());
+    }
+    ans.sort(), myList.sort();
+    ans2.sort(), myList2.sort();
+    return equal(ans, myList) && equal(ans2, myList2)
+        && myList.last_sort().strategy == sjtu::sort_strategy::radix;
+}
+
+bool testSmallArray() {
+    std::list<int> ans;
+    sjtu::list<int> myList;
+    for (int i = 0; i < 100; ++i) {
+        int x = rand() % 50;
+        ans.push_back(x);
+        myList.push_back(x);
+    }
+    ans.sort(), myList.sort();
+    return equal(ans, myList) && myList.last_sort().strategy == sjtu::sort_strategy::array;
+}
+
+bool testMergeHeavy() {
+    std::list<Heavy> ans;
+    sjtu::list<Heavy> myList;
+    for (int i = 0; i < N / 10; ++i) {
+        int x = rand() % 1000;
+        ans.push_back(Heavy(x));
+        myList.push_back(Heavy(x));
+    }
+    ans.sort();
+    copies = 0;
+    myList.sort();
+    return equal(ans, myList) && copies == 0 && myList.last_sort().strategy == sjtu::sort_strategy::merge;
+}
+
+bool testMergeBint() {
+    std::list<Util::Bint> ans;
+    sjtu::list<Util::Bint> myList;
+    for (int i = 0; i < 2000; ++i) {
+        Util::Bint x = Util::Bint(rand() - RAND_MAX / 2) * Util::Bint(rand());
+        ans.push_back(x);
+        myList.push_back(x);
+    }
+    ans.sort(), myList.sort();
+    return equal(ans, myList) && myList.last_sort().strategy == sjtu::sort_strategy::merge;
+}
+
+bool testKeySort() {
+    typedef sjtu::pair<int, int> Pair;
+    sjtu::list<Pair> myList;
+    for (int i = 0; i < N; ++i)
+        myList.push_back(Pair(rand() % 100, i));
+    myList.sort([](const Pair &p) { return p.first; });
+    if (myList.last_sort().strategy != sjtu::sort_strategy::radix)
+        return false;
+    sjtu::list<Pair>::const_iterator it = myList.cbegin(), prev = it;
+    for (++it; it != myList.cend(); ++it, ++prev)
+        if (prev->first > it->first || (prev->first == it->first && prev->second > it->second))
+            return false;
+
+    sjtu::list<Pair> byDouble;
+    for (int i = 0; i < 1000; ++i)
+        byDouble.push_back(Pair(rand() % 10, i));
+    byDouble.sort([](const Pair &p) { return p.first * 0.5; });
+    it = byDouble.cbegin(), prev = it;
+    for (++it; it != byDouble.cend(); ++it, ++prev)
+        if (prev->first > it->first)
+            return false;
+    return true;
+}
+
+bool testTrivialCases() {
+    sjtu::list<int> myList;
+    myList.sort();
+    if (!myList.empty() || myList.last_sort().strategy != sjtu::sort_strategy::none)
+        return false;
+    myList.push_back(1);
+    myList.sort();
+    if (myList.front() != 1)
+        return false;
+    for (int i = 0; i < 1000; ++i)
+        myList.push_back(7);
+    myList.sort();
+    return myList.size() == 1001 && myList.front() == 1 && myList.back() == 7;
+}
+
+int main(){
+    srand(20220207);
+    bool (*testList[])() = {
+            testRadixInt, testRadixWide, testSmallArray, testMergeHeavy, testMergeBint, testKeySort, testTrivialCases
+    };
+    const char* Messages[] = {
+            "Test 1: Testing radix sort on int...",
+            "Test 2: Testing radix sort on long long and unsigned char...",
+            "Test 3: Testing array sort on a short list...",
+            "Test 4: Testing merge sort on heavy payloads without copies...",
+            "Test 5: Testing merge sort on Bint...",
+            "Test 6: Testing sort by key...",
+            "Test 7: Testing empty, single and constant lists..."
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
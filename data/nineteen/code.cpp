@@ -0,0 +1,246 @@
+// map: B+-tree against std::map, bulk loading and bounds
+
+#include "algorithm.hpp"
+#include "list.hpp"
+#include "map.hpp"
+
+#include <iostream>
+#include <map>
+#include <string>
+
+const int N = 1e5;
+
+int alive = 0, copiesLeft = -1;
+class Counted {
+public:
+    int value;
+    Counted() : value(0) { alive++; }
+    Counted(int v) : value(v) { alive++; }
+    Counted(const Counted &other) : value(other.value) {
+        if (copiesLeft >= 0 && copiesLeft-- == 0)
+            throw sjtu::runtime_error();
+        alive++;
+    }
+    Counted &operator=(const Counted &) = default;
+    ~Counted() { alive--; }
+};
+
+template<class K, class V>
+bool equal(const std::map<K, V> &x, const sjtu::map<K, V> &y) {
+    if (x.size() != y.size())
+        return false;
+
+    typename std::map<K, V>::const_iterator itx = x.cbegin();
+    typename sjtu::map<K, V>::const_iterator ity = y.cbegin();
+    for (; itx != x.cend() && ity != y.cend(); ++itx, ++ity)
+        if (itx->first != ity->first || !(itx->second == ity->second))
+            return false;
+
+    return ity == y.cend();
+}
+
+bool testRandomOperations() {
+    std::map<int, int> ans;
+    sjtu::map<int, int> myMap;
+    for (int i = 0; i < N; ++i) {
+        int op = rand() % 10, key = rand() % 20000, value = rand();
+        if (op < 4) {
+            bool inserted = ans.insert({key, value}).second;
+            sjtu::pair<sjtu::map<int, int>::iterator, bool> result = myMap.insert(sjtu::map<int, int>::value_type(key, value));
+            if (result.second != inserted || result.first->first != key || result.first->second != ans[key])
+                return false;
+        } else if (op < 7) {
+            if (ans.erase(key) != myMap.erase(key))
+                return false;
+        } else if (op < 8) {
+            ans[key] ^= value, myMap[key] ^= value;
+        } else if (op < 9) {
+            std::map<int, int>::iterator itx = ans.lower_bound(key);
+            sjtu::map<int, int>::iterator ity = myMap.lower_bound(key);
+            if ((itx == ans.end()) != (ity == myMap.end()))
+                return false;
+            if (itx != ans.end()) {
+                if (ity->first != itx->first)
+                    return false;
+                itx = ans.erase(itx), ity = myMap.erase(ity);
+                if ((itx == ans.end()) != (ity == myMap.end()) || (itx != ans.end() && ity->first != itx->first))
+                    return false;
+            }
+        } else {
+            if (ans.count(key) != myMap.count(key))
+                return false;
+        }
+        if (i % 5000 == 0 && !equal(ans, myMap))
+            return false;
+    }
+    return equal(ans, myMap);
+}
+
+bool testBounds() {
+    static int keys[N / 10];
+    sjtu::list<sjtu::pair<int, int>> sorted;
+    int n = 0;
+    for (int k = rand() % 5; n < N / 10; k += 1 + rand() % 5) {
+        keys[n++] = k;
+        sorted.push_back(sjtu::pair<int, int>(k, -k));
+    }
+    sjtu::map<int, int> myMap;
+    myMap.assign_sorted(sorted.cbegin(), sorted.cend());
+    if (myMap.size() != size_t(n))
+        return false;
+    for (int q = -5; q < keys[n - 1] + 5; ++q) {
+        int *lower = sjtu::lower_bound(keys, keys + n, q), *upper = sjtu::upper_bound(keys, keys + n, q);
+        sjtu::map<int, int>::const_iterator itl = myMap.lower_bound(q), itu = myMap.upper_bound(q);
+        if ((lower == keys + n) != (itl == myMap.cend()) || (lower != keys + n && itl->first != *lower))
+            return false;
+        if ((upper == keys + n) != (itu == myMap.cend()) || (upper != keys + n && itu->first != *upper))
+            return false;
+    }
+    // a backward range scan over the linked leaves
+    sjtu::map<int, int>::const_iterator it = myMap.cend();
+    for (int i = n - 1; i >= 0; --i)
+        if ((--it)->first != keys[i] || it->second != -keys[i])
+            return false;
+    try { --it; } catch (sjtu::invalid_iterator &) { return it == myMap.cbegin(); }
+    return false;
+}
+
+bool testBulkThenModify() {
+    std::map<int, int> ans;
+    sjtu::list<sjtu::pair<int, int>> sorted;
+    for (int i = 0; i < N / 2; ++i) {
+        ans[i * 2] = i;
+        sorted.push_back(sjtu::pair<int, int>(i * 2, i));
+    }
+    sjtu::map<int, int> myMap;
+    myMap[7] = 7;
+    myMap.assign_sorted(sorted.cbegin(), sorted.cend());
+    for (int i = 0; i < N / 2; ++i) {
+        int key = rand() % N;
+        if (rand() % 2)
+            ans.insert({key, key}), myMap.insert(sjtu::map<int, int>::value_type(key, key));
+        else
+            ans.erase(key), myMap.erase(key);
+    }
+    if (!equal(ans, myMap))
+        return false;
+    // erase all but a few, then grow again from the sparse tree
+    for (int i = 0; i < N; ++i)
+        if (i % 997 != 0)
+            ans.erase(i), myMap.erase(i);
+    for (int i = 0; i < N / 10; ++i)
+        ans[i * 7] = i, myMap[i * 7] = i;
+    sjtu::map<int, int> copy(myMap), assigned;
+    assigned = copy;
+    return equal(ans, myMap) && equal(ans, copy) && equal(ans, assigned);
+}
+
+bool testErrors() {
+    sjtu::map<std::string, int> myMap;
+    int caught = 0;
+    try { myMap.at("missing"); } catch (sjtu::index_out_of_bound &) { caught++; }
+    try { *myMap.begin(); } catch (sjtu::invalid_iterator &) { caught++; }
+    try { myMap.erase(myMap.end()); } catch (sjtu::invalid_iterator &) { caught++; }
+    sjtu::pair<std::string, int> bad[3] = {sjtu::pair<std::string, int>(std::string("b"), 1),
+                                           sjtu::pair<std::string, int>(std::string("a"), 2),
+                                           sjtu::pair<std::string, int>(std::string("c"), 3)};
+    myMap["x"] = 1;
+    try { myMap.assign_sorted(bad, bad + 3); } catch (sjtu::runtime_error &) { caught++; }
+    if (caught != 4 || !myMap.empty())
+        return false;
+    myMap.assign_sorted(bad + 1, bad + 3);
+    return myMap.at("a") == 2 && myMap.at("c") == 3 && myMap.size() == 2 && myMap.count("b") == 0;
+}
+
+bool testStringKeys() {
+    // 32-byte keys give nodes of 8 keys and a deep tree
+    std::map<std::string, int> ans;
+    sjtu::map<std::string, int> myMap;
+    for (int i = 0; i < N / 5; ++i) {
+        std::string key = std::to_string(rand() % 5000);
+        if (rand() % 3)
+            ans[key] = i, myMap[key] = i;
+        else if (ans.erase(key) != myMap.erase(key))
+            return false;
+    }
+    std::map<std::string, int>::iterator itx = ans.upper_bound("25");
+    sjtu::map<std::string, int>::iterator ity = myMap.upper_bound("25");
+    for (; itx != ans.end(); ++itx, ++ity)
+        if (ity == myMap.end() || ity->first != itx->first)
+            return false;
+    return ity == myMap.end() && equal(ans, myMap);
+}
+
+bool testOwnership() {
+    {
+        sjtu::map<int, Counted> myMap;
+        for (int i = 0; i < 5000; ++i)
+            myMap[rand() % 3000] = Counted(i);
+        size_t n = myMap.size();
+        sjtu::map<int, Counted> copy(myMap);
+        for (int i = 0; i < 3000; i += 2)
+            copy.erase(i);
+        if (alive != int(n + copy.size()))
+            return false;
+        copy.clear();
+        myMap = copy;
+        if (alive != 0 || !myMap.empty())
+            return false;
+        myMap[1] = Counted(1);
+    }
+    return alive == 0;
+}
+
+bool testThrowingCopy() {
+    {
+        sjtu::map<int, Counted> myMap;
+        for (int i = 0; i < 1000; ++i)
+            myMap[i] = Counted(i);
+        for (int k = 0; k < 1000; k += 37) {
+            copiesLeft = k;
+            bool thrown = false;
+            try {
+                sjtu::map<int, Counted> copy(myMap);
+            } catch (sjtu::runtime_error &) {
+                thrown = true;
+            }
+            copiesLeft = -1;
+            if (!thrown || alive != 1000)
+                return false;
+        }
+    }
+    return alive == 0;
+}
+
+int main(){
+    srand(20220207);
+    bool (*testList[])() = {
+            testRandomOperations, testBounds, testBulkThenModify, testErrors, testStringKeys, testOwnership,
+            testThrowingCopy
+    };
+    const char* Messages[] = {
+            "Test 1: Testing random operations against std::map...",
+            "Test 2: Testing lower_bound and upper_bound against sjtu::lower_bound...",
+            "Test 3: Testing bulk loading followed by updates...",
+            "Test 4: Testing errors and unsorted input...",
+            "Test 5: Testing string keys...",
+            "Test 6: Testing that elements are freed...",
+            "Test 7: Testing a copy that throws..."
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
@@ -0,0 +1,74 @@
+#ifndef UTIL_PARALLEL_HPP
+#define UTIL_PARALLEL_HPP
+
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <exception>
+
+namespace Util {
+
+/**
+ * Runs work(from, to) over [0, count) cut into one range per thread, each
+ * of grain items at least; threads == 0 takes one per hardware thread.
+ * The calling thread does the first range itself. If a thread cannot be
+ * started, the rest of [0, count) is done on the calling thread too.
+ * Every thread is joined before the first exception of a range is
+ * rethrown.
+ */
+template<typename Work>
+void ParallelFor(size_t count, size_t grain, size_t threads, Work work)
+{
+	size_t workers = threads != 0 ? threads : std::thread::hardware_concurrency();
+	if (grain == 0) {
+		grain = 1;
+	}
+	if (workers > count / grain) {
+		workers = count / grain;
+	}
+	if (workers <= 1) {
+		work(0, count);
+		return;
+	}
+
+	std::vector<std::thread> pool;
+	std::vector<std::exception_ptr> errors(workers);
+	pool.reserve(workers - 1);
+	size_t step = (count + workers - 1) / workers;
+	size_t rest = count;
+	for (size_t t = 1; t < workers; ++t) {
+		size_t from = std::min(count, t * step), to = std::min(count, from + step);
+		try {
+			pool.emplace_back([&, t, from, to]() {
+				try {
+					work(from, to);
+				} catch (...) {
+					errors[t] = std::current_exception();
+				}
+			});
+		} catch (...) {
+			// no thread to spare: the ranges from here on run below
+			rest = from;
+			break;
+		}
+	}
+	try {
+		work(0, std::min(count, step));
+		if (rest < count) {
+			work(rest, count);
+		}
+	} catch (...) {
+		errors[0] = std::current_exception();
+	}
+	for (size_t t = 0; t < pool.size(); ++t) {
+		pool[t].join();
+	}
+	for (size_t t = 0; t < workers; ++t) {
+		if (errors[t]) {
+			std::rethrow_exception(errors[t]);
+		}
+	}
+}
+
+}
+#endif
@@ -0,0 +1,198 @@
+// Bint accumulation kernels against the generic Bint operators
+
+#include "class-matrix-bint.hpp"
+#include "list.hpp"
+
+#include <iostream>
+#include <string>
+
+Util::Bint randomBint(int limbs) {
+    std::string s;
+    if (rand() % 3 == 0)
+        s += '-';
+    s += char('1' + rand() % 9);
+    for (int i = 1; i < limbs * 4; ++i)
+        s += char('0' + rand() % 10);
+    return Util::Bint(s);
+}
+
+Diamond::Matrix<Util::Bint> randomMatrix(size_t rows, size_t cols, int limbs) {
+    Diamond::Matrix<Util::Bint> m(rows, cols);
+    for (size_t i = 0; i < rows; ++i)
+        for (size_t j = 0; j < cols; ++j)
+            m[i][j] = randomBint(1 + rand() % limbs);
+    return m;
+}
+
+Diamond::Matrix<Util::Bint> naiveProduct(const Diamond::Matrix<Util::Bint> &a, const Diamond::Matrix<Util::Bint> &b) {
+    Diamond::Matrix<Util::Bint> c(a.RowSize(), b.ColSize(), 0);
+    for (size_t i = 0; i < a.RowSize(); ++i)
+        for (size_t j = 0; j < b.ColSize(); ++j)
+            for (size_t k = 0; k < a.ColSize(); ++k)
+                c[i][j] += a[i][k] * b[k][j];
+    return c;
+}
+
+bool testOperators() {
+    Util::Bint a(5000), b(5000), c(10000), d(1);
+    if (!(a + b == c))
+        return false;
+    if (!(c - d == Util::Bint(9999)))
+        return false;
+    if (!(Util::Bint(-3) * Util::Bint(4) == Util::Bint(-12)))
+        return false;
+    Util::Bint e(7);
+    e += Util::Bint(-10);
+    return e == Util::Bint(-3);
+}
+
+bool testAccumulator() {
+    Util::BintAccumulator acc;
+    for (int round = 0; round < 50; ++round) {
+        acc.Reset();
+        Util::Bint expect(0);
+        for (int i = 0; i < 20; ++i) {
+            Util::Bint x = randomBint(1 + rand() % 6), y = randomBint(1 + rand() % 6);
+            if (rand() % 2) {
+                acc.Add(x);
+                expect += x;
+            } else {
+                acc.AddProduct(x, y);
+                expect += x * y;
+            }
+        }
+        if (!(acc.Result() == expect))
+            return false;
+    }
+    acc.Reset();
+    acc.Add(Util::Bint(12345));
+    acc.Add(Util::Bint(-12345));
+    return acc.Result() == Util::Bint(0);
+}
+
+bool testSmallProduct() {
+    for (int round = 0; round < 20; ++round) {
+        size_t n = 1 + rand() % 5, m = 1 + rand() % 5, k = 1 + rand() % 5;
+        Diamond::Matrix<Util::Bint> a = randomMatrix(n, k, 4), b = randomMatrix(k, m, 4);
+        if (!(a * b == naiveProduct(a, b)))
+            return false;
+    }
+    return true;
+}
+
+bool testLargeProduct() {
+    Diamond::Matrix<Util::Bint> a = randomMatrix(12, 20, 12), b = randomMatrix(20, 9, 12);
+    return a * b == naiveProduct(a, b);
+}
+
+bool testSum() {
+    sjtu::list<Util::Bint> myList;
+    Util::Bint expect(0);
+    if (!(Util::sum(myList.cbegin(), myList.cend()) == expect))
+        return false;
+    for (int i = 0; i < 9000; ++i) {
+        myList.push_back(randomBint(1 + rand() % 8));
+        expect += myList.back();
+    }
+    return Util::sum(myList.cbegin(), myList.cend(), 1) == expect
+        && Util::sum(myList.cbegin(), myList.cend(), 2) == expect
+        && Util::sum(myList.begin(), myList.end()) == expect;
+}
+
+bool testGcd() {
+    for (int a = 0; a < 60; ++a)
+        for (int b = 0; b < 60; ++b) {
+            int x = a, y = b;
+            while (y) { int t = x % y; x = y; y = t; }
+            if (!(Util::gcd(Util::Bint(a), Util::Bint(-b)) == Util::Bint(x)))
+                return false;
+        }
+    for (int round = 0; round < 100; ++round) {
+        Util::Bint x = randomBint(1 + rand() % 40), y = randomBint(1 + rand() % 40), z = randomBint(1 + rand() % 20);
+        if (round % 4 == 0)
+            z = Util::Bint(std::string("2048")) * Util::Bint(std::string("390625"));
+        Util::Bint a = x * z, b = y * z;
+        Util::Bint g = Util::gcd(a, b);
+        if (g < Util::Bint(0) || !(Util::exact_div(g, abs(z)) * abs(z) == g))
+            return false;
+        Util::Bint p = Util::exact_div(a, g), q = Util::exact_div(b, g);
+        if (!(p * g == a) || !(q * g == b) || !(Util::gcd(p, q) == Util::Bint(1)))
+            return false;
+        if (!(Util::exact_div(a, z) == x))
+            return false;
+    }
+    try {
+        Util::exact_div(Util::Bint(1), Util::Bint(0));
+    } catch (std::invalid_argument &) {
+        return true;
+    }
+    return false;
+}
+
+bool testKaratsuba() {
+    for (int round = 0; round < 60; ++round) {
+        Util::Bint a = randomBint(1 + rand() % 300), b = randomBint(1 + rand() % 300);
+        if (round % 10 == 0)
+            b = Util::Bint(0);
+        Util::Bint expect = multiply(a, b, size_t(-1));
+        if (!(multiply(a, b, 4) == expect) || !(multiply(b, a, 5) == expect) || !(a * b == expect))
+            return false;
+    }
+    Util::Bint nines(std::string(4000, '9'));
+    return multiply(nines, nines, 4) == multiply(nines, nines, size_t(-1));
+}
+
+bool testSizeMismatch() {
+    try {
+        Diamond::Matrix<Util::Bint>(2, 3) * Diamond::Matrix<Util::Bint>(2, 3);
+    } catch (std::invalid_argument &) {
+        return true;
+    }
+    return false;
+}
+
+bool testInList() {
+    sjtu::list<Diamond::Matrix<Util::Bint>> myList;
+    Diamond::Matrix<Util::Bint> a = randomMatrix(3, 3, 3);
+    myList.push_back(a);
+    for (int i = 0; i < 5; ++i)
+        myList.push_back(myList.back() * a);
+    Diamond::Matrix<Util::Bint> expect = a;
+    for (int i = 0; i < 5; ++i)
+        expect = naiveProduct(expect, a);
+    return myList.back() == expect;
+}
+
+int main(){
+    srand(20220207);
+    bool (*testList[])() = {
+            testOperators, testAccumulator, testSmallProduct, testLargeProduct, testSizeMismatch, testInList, testSum, testGcd, testKaratsuba
+    };
+    const char* Messages[] = {
+            "Test 1: Testing Bint +, -, * and += ...",
+            "Test 2: Testing BintAccumulator...",
+            "Test 3: Testing Matrix<Bint> product on small shapes...",
+            "Test 4: Testing Matrix<Bint> product on long numbers...",
+            "Test 5: Testing Matrix<Bint> size check...",
+            "Test 6: Testing Matrix<Bint> inside list...",
+            "Test 7: Testing sum() over list<Bint>...",
+            "Test 8: Testing gcd() and exact_div()...",
+            "Test 9: Testing Karatsuba multiply()..."
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
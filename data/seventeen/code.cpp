@@ -0,0 +1,217 @@
+// deferred erase: tombstones, skipping iterators and batched compaction
+
+#include "list.hpp"
+#include "sorted_list.hpp"
+
+#include <iostream>
+#include <list>
+
+const int N = 1e5;
+
+template<typename T>
+bool equal(const std::list<T> &x, const sjtu::list<T> &y) {
+    if (x.size() != y.size())
+        return false;
+
+    typename std::list<T>::const_iterator itx = x.cbegin();
+    typename sjtu::list<T>::const_iterator ity = y.cbegin();
+    for (; itx != x.cend() && ity != y.cend(); ++itx, ++ity)
+        if (!(*itx == *ity))
+            return false;
+
+    return itx == x.cend() && ity == y.cend();
+}
+
+int alive = 0;
+class Counted {
+public:
+    int key;
+    Counted(int k) : key(k) { alive++; }
+    Counted(const Counted &other) : key(other.key) { alive++; }
+    ~Counted() { alive--; }
+    bool operator<(const Counted &rhs) const { return key < rhs.key; }
+    bool operator==(const Counted &rhs) const { return key == rhs.key; }
+};
+
+bool testScan() {
+    std::list<int> ans;
+    sjtu::list<int> myList;
+    myList.set_deferred_erase(true, 1);
+    for (int i = 0; i < N; ++i) {
+        ans.push_back(i);
+        myList.push_back(i);
+    }
+    for (sjtu::list<int>::iterator it = myList.begin(); it != myList.end();) {
+        if (*it % 3 != 1)
+            it = myList.erase(it);
+        else
+            ++it;
+    }
+    ans.remove_if([](int x) { return x % 3 != 1; });
+    if (myList.erased_pending() != N - ans.size() || !equal(ans, myList))
+        return false;
+    std::list<int>::const_iterator itx = ans.cend();
+    sjtu::list<int>::const_iterator ity = myList.cend();
+    while (itx != ans.cbegin()) {
+        --itx, --ity;
+        if (*itx != *ity)
+            return false;
+    }
+    if (ity != myList.cbegin() || myList.front() != 1 || myList.back() != ans.back())
+        return false;
+    myList.compact_erased();
+    return myList.erased_pending() == 0 && equal(ans, myList);
+}
+
+bool testAutoCompact() {
+    std::list<int> ans;
+    sjtu::list<int> myList;
+    myList.set_deferred_erase(true);
+    for (int i = 0; i < N / 10; ++i) {
+        int x = rand();
+        ans.push_back(x);
+        myList.push_back(x);
+    }
+    bool compacted = false;
+    while (!ans.empty()) {
+        std::list<int>::iterator itx = ans.begin();
+        sjtu::list<int>::iterator ity = myList.begin();
+        for (int k = rand() % ans.size() % 50; k > 0; --k)
+            ++itx, ++ity;
+        size_t before = myList.erased_pending();
+        ans.erase(itx), myList.erase(ity);
+        if (myList.erased_pending() != before + 1)
+            compacted = true;
+        if (myList.erased_pending() > 0.25 * (myList.size() + myList.erased_pending()))
+            return false;
+    }
+    return compacted && myList.empty() && myList.erased_pending() == 0 && equal(ans, myList);
+}
+
+bool testRandomOperations() {
+    std::list<int> ans;
+    sjtu::list<int> myList;
+    myList.set_deferred_erase(true, 0.5);
+    for (int i = 0; i < N / 5; ++i) {
+        int op = rand() % 12, x = rand() % 1000;
+        if (op < 3) {
+            ans.push_back(x), myList.push_back(x);
+        } else if (op < 4) {
+            ans.push_front(x), myList.push_front(x);
+        } else if (op < 5 && !ans.empty()) {
+            ans.pop_back(), myList.pop_back();
+        } else if (op < 6 && !ans.empty()) {
+            ans.pop_front(), myList.pop_front();
+        } else if (op < 8) {
+            std::list<int>::iterator itx = ans.begin();
+            sjtu::list<int>::iterator ity = myList.begin();
+            for (int k = rand() % (ans.size() + 1) % 20; k > 0 && itx != ans.end(); --k)
+                ++itx, ++ity;
+            ans.insert(itx, x), myList.insert(ity, x);
+        } else if (op < 11 && !ans.empty()) {
+            std::list<int>::iterator itx = ans.begin();
+            sjtu::list<int>::iterator ity = myList.begin();
+            for (int k = rand() % ans.size() % 20; k > 0; --k)
+                ++itx, ++ity;
+            ans.erase(itx), myList.erase(ity);
+        } else if (rand() % 50 == 0) {
+            ans.sort(), myList.sort();
+            ans.unique(), myList.unique();
+        }
+        if (!ans.empty() && (myList.front() != ans.front() || myList.back() != ans.back()))
+            return false;
+        if (i % 1000 == 0 && !equal(ans, myList))
+            return false;
+    }
+    sjtu::list<int> copy(myList), parallel(myList, sjtu::parallel_policy(2));
+    sjtu::list<int> other;
+    other.push_back(-1);
+    other.merge(copy);
+    ans.push_front(-1);
+    if (!equal(ans, other) || !copy.empty())
+        return false;
+    ans.pop_front();
+    myList.set_deferred_erase(false);
+    return myList.erased_pending() == 0 && equal(ans, myList) && equal(ans, parallel);
+}
+
+bool testInvalidIterators() {
+    sjtu::list<int> myList;
+    myList.set_deferred_erase(true, 1);
+    for (int i = 0; i < 10; ++i)
+        myList.push_back(i);
+    sjtu::list<int>::iterator first = myList.begin(), second = first;
+    ++second;
+    myList.erase(first);
+    int caught = 0;
+    try { *first; } catch (sjtu::invalid_iterator &) { caught++; }
+    try { myList.erase(first); } catch (sjtu::invalid_iterator &) { caught++; }
+    try { myList.insert(first, 5); } catch (sjtu::invalid_iterator &) { caught++; }
+    try { --second; } catch (sjtu::invalid_iterator &) { caught++; }
+    try { myList.set_deferred_erase(true, 0); } catch (sjtu::runtime_error &) { caught++; }
+    if (caught != 5 || *second != 1 || *myList.begin() != 1 || myList.size() != 9)
+        return false;
+    myList.push_front(-1);
+    myList.insert(second, 0);
+    std::list<int> ans = {-1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    return myList.erased_pending() == 0 && equal(ans, myList);
+}
+
+bool testOwnership() {
+    {
+        sjtu::list<Counted> myList;
+        myList.set_deferred_erase(true, 1);
+        for (int i = 0; i < 1000; ++i)
+            myList.push_back(Counted(rand() % 100));
+        for (sjtu::list<Counted>::iterator it = myList.begin(); it != myList.end();) {
+            if (it->key % 2)
+                it = myList.erase(it);
+            else
+                ++it;
+        }
+        if (alive != 1000)
+            return false;
+        size_t k = myList.size();
+        sjtu::list<Counted> copy(myList);
+        if (alive != 1000 + int(k))
+            return false;
+        sjtu::sorted_list<Counted> sorted(std::move(copy));
+        copy.push_back(Counted(1));
+        sorted.splice_into(myList);
+        myList.erase(myList.begin());
+        if (!sorted.empty() || copy.size() != 1 || myList.size() != 2 * k - 1
+            || alive != int(myList.size() + myList.erased_pending() + 1))
+            return false;
+    }
+    return alive == 0;
+}
+
+int main(){
+    srand(20220207);
+    bool (*testList[])() = {
+            testScan, testAutoCompact, testRandomOperations, testInvalidIterators, testOwnership
+    };
+    const char* Messages[] = {
+            "Test 1: Testing a long scan with deferred erase...",
+            "Test 2: Testing compaction at the dead ratio...",
+            "Test 3: Testing random operations against std::list...",
+            "Test 4: Testing iterators to erased elements...",
+            "Test 5: Testing that tombstones are freed..."
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
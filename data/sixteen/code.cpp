@@ -0,0 +1,272 @@
+// sortedness tracking: repeated sort() calls and suffix merges
+
+#include "class-matrix.hpp"
+#include "list.hpp"
+
+#include <iostream>
+#include <list>
+#include <thread>
+#include <vector>
+
+const int N = 5e4;
+
+template<typename T>
+bool equal(const std::list<T> &x, const sjtu::list<T> &y) {
+    if (x.size() != y.size())
+        return false;
+
+    typename std::list<T>::const_iterator itx = x.cbegin();
+    typename sjtu::list<T>::const_iterator ity = y.cbegin();
+    for (; itx != x.cend() && ity != y.cend(); ++itx, ++ity)
+        if (!(*itx == *ity))
+            return false;
+
+    return true;
+}
+
+bool testPresorted() {
+    sjtu::list<int> myList;
+    for (int i = 0; i < N; ++i)
+        myList.push_back(rand());
+    myList.sort();
+    if (myList.last_sort().strategy != sjtu::sort_strategy::radix)
+        return false;
+    myList.sort();
+    if (myList.last_sort().strategy != sjtu::sort_strategy::presorted)
+        return false;
+    int top = myList.back();
+    myList.push_back(top);
+    myList.push_back(top + 1);
+    myList.push_front(-1);
+    myList.pop_back();
+    myList.sort();
+    sjtu::list<int> copy(myList);
+    copy.sort();
+    sjtu::list<int> ordered;
+    for (int i = 0; i < N; ++i)
+        ordered.push_back(i / 3);
+    ordered.sort();
+    return myList.last_sort().strategy == sjtu::sort_strategy::presorted
+        && copy.last_sort().strategy == sjtu::sort_strategy::presorted
+        && ordered.last_sort().strategy == sjtu::sort_strategy::presorted;
+}
+
+bool testSuffixMerge() {
+    std::list<int> ans;
+    sjtu::list<int> myList;
+    for (int i = 0; i < N; ++i) {
+        int x = rand() % 1000;
+        ans.push_back(x);
+        myList.push_back(x);
+    }
+    myList.sort();
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 100; ++i) {
+            int x = rand() % 1000;
+            ans.push_back(x);
+            myList.push_back(x);
+        }
+        ans.sort();
+        myList.sort();
+        if (myList.last_sort().strategy != sjtu::sort_strategy::suffix || !equal(ans, myList))
+            return false;
+    }
+    return true;
+}
+
+bool testInvalidation() {
+    sjtu::list<int> myList;
+    for (int i = 0; i < 100; ++i)
+        myList.push_back(i * 2);
+    sjtu::list<int>::iterator it = myList.begin();
+    ++it, ++it;
+    myList.insert(it, 3);
+    myList.sort();
+    if (myList.last_sort().strategy != sjtu::sort_strategy::presorted)
+        return false;
+    myList.insert(it, 1000);
+    myList.sort();
+    if (myList.last_sort().strategy == sjtu::sort_strategy::presorted || myList.back() != 1000)
+        return false;
+    myList.push_front(5000);
+    myList.sort();
+    if (myList.back() != 5000 || myList.front() != 0)
+        return false;
+    *myList.begin() = 7000;
+    myList.sort();
+    if (myList.back() != 7000 || myList.front() != 2)
+        return false;
+    myList.erase(myList.begin());
+    myList.pop_front();
+    myList.pop_back();
+    myList.sort();
+    return myList.last_sort().strategy == sjtu::sort_strategy::presorted && myList.front() == 4 && myList.back() == 5000;
+}
+
+bool testMergeAndUnique() {
+    sjtu::list<int> a, b;
+    std::list<int> ans;
+    for (int i = 0; i < 1000; ++i) {
+        int x = rand() % 300, y = rand() % 300;
+        a.push_back(x), b.push_back(y);
+        ans.push_back(x), ans.push_back(y);
+    }
+    a.sort(), b.sort();
+    a.merge(b);
+    a.sort();
+    if (a.last_sort().strategy != sjtu::sort_strategy::presorted || !b.empty())
+        return false;
+    a.unique();
+    a.sort();
+    ans.sort();
+    ans.unique();
+    if (a.last_sort().strategy != sjtu::sort_strategy::presorted || !equal(ans, a))
+        return false;
+    a.reverse();
+    a.sort();
+    return a.last_sort().strategy != sjtu::sort_strategy::presorted && equal(ans, a);
+}
+
+bool testRandomOperations() {
+    std::list<int> ans;
+    sjtu::list<int> myList;
+    for (int i = 0; i < N / 5; ++i) {
+        int op = rand() % 10, x = rand() % 5000;
+        if (op < 4) {
+            ans.push_back(x), myList.push_back(x);
+        } else if (op < 5) {
+            ans.push_front(x), myList.push_front(x);
+        } else if (op < 6 && !ans.empty()) {
+            ans.pop_back(), myList.pop_back();
+        } else if (op < 7 && !ans.empty()) {
+            ans.pop_front(), myList.pop_front();
+        } else if (op < 8) {
+            std::list<int>::iterator itx = ans.begin();
+            sjtu::list<int>::iterator ity = myList.begin();
+            for (int k = rand() % (ans.size() + 1); k > 0 && itx != ans.end(); --k)
+                ++itx, ++ity;
+            ans.insert(itx, x), myList.insert(ity, x);
+        } else if (op < 9) {
+            ans.sort(), myList.sort();
+        }
+        if (i % 1000 == 0) {
+            ans.sort(), myList.sort();
+            if (!equal(ans, myList))
+                return false;
+        }
+    }
+    ans.sort(), myList.sort();
+    return equal(ans, myList);
+}
+
+struct NoLess {
+    int value;
+};
+
+bool testWithoutLess() {
+    sjtu::list<Diamond::Matrix<double>> myList;
+    myList.push_back(Diamond::Matrix<double>(2, 2, 1.0));
+    myList.push_front(Diamond::Matrix<double>(1, 1, 2.0));
+    myList.insert(myList.end(), Diamond::Matrix<double>(3, 3, 3.0));
+    sjtu::list<std::vector<NoLess>> vectors, more;
+    vectors.push_back(std::vector<NoLess>(2));
+    vectors.push_front(std::vector<NoLess>(1));
+    more.push_back(std::vector<NoLess>(3));
+    vectors.splice(vectors.end(), more);
+    vectors.insert(vectors.begin(), std::vector<NoLess>());
+    vectors.pop_back();
+    return myList.size() == 3 && myList.back().RowSize() == 3
+        && vectors.size() == 3 && vectors.back().size() == 2 && more.empty();
+}
+
+long long comparisons = 0;
+
+struct Compared {
+    int value;
+    Compared(int value = 0) : value(value) {}
+    bool operator<(const Compared &rhs) const {
+        comparisons++;
+        return value < rhs.value;
+    }
+};
+
+bool testComparisons() {
+    sjtu::list<Compared> myList;
+    comparisons = 0;
+    for (int i = 0; i < 1000; ++i)
+        myList.push_back(Compared(i));
+    if (comparisons != 0)
+        return false;
+    myList.sort();
+    comparisons = 0;
+    long long total = 0;
+    for (sjtu::list<Compared>::const_iterator it = myList.cbegin(); it != myList.cend(); ++it)
+        total += it->value;
+    myList.sort();
+    if (comparisons != 0 || total != 499500 || myList.last_sort().strategy != sjtu::sort_strategy::presorted)
+        return false;
+    myList.push_back(Compared(2000));
+    myList.sort();
+    if (comparisons != 1 || myList.last_sort().strategy != sjtu::sort_strategy::presorted)
+        return false;
+    // an iterator handed out may write at any time, so the order is checked from now on
+    sjtu::list<Compared>::iterator it = myList.begin();
+    comparisons = 0;
+    myList.sort();
+    if (comparisons != 1000 || myList.last_sort().strategy != sjtu::sort_strategy::presorted)
+        return false;
+    it->value = 5000;
+    myList.sort();
+    return myList.back().value == 5000 && myList.front().value == 1;
+}
+
+bool testSharedReaders() {
+    sjtu::list<int> myList;
+    for (int i = 0; i < 1000; ++i)
+        myList.push_back(i);
+    long long sums[2] = {0, 0};
+    auto read = [&](int k) {
+        for (sjtu::list<int>::iterator it = myList.begin(); it != myList.end(); ++it)
+            sums[k] += *it;
+    };
+    std::thread other(read, 1);
+    read(0);
+    other.join();
+    myList.push_back(-1);
+    myList.sort();
+    return sums[0] == 499500 && sums[1] == 499500 && myList.front() == -1 && myList.back() == 999;
+}
+
+int main(){
+    srand(20220207);
+    bool (*testList[])() = {
+            testPresorted, testSuffixMerge, testInvalidation, testMergeAndUnique, testRandomOperations, testWithoutLess,
+            testComparisons, testSharedReaders
+    };
+    const char* Messages[] = {
+            "Test 1: Testing sort() of a sorted list...",
+            "Test 2: Testing sort() of a sorted list with a new suffix...",
+            "Test 3: Testing modifiers that break the order...",
+            "Test 4: Testing merge(), unique() and reverse()...",
+            "Test 5: Testing random operations against std::list...",
+            "Test 6: Testing lists of a type without operator<...",
+            "Test 7: Testing the comparisons sort() makes...",
+            "Test 8: Testing readers sharing a list..."
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
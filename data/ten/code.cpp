@@ -0,0 +1,235 @@
+// hive: slot reuse, skip fields and iterator stability
+
+#include "hive.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+const int N = 5e4;
+
+template<typename T>
+std::vector<T> contents(const sjtu::hive<T> &h) {
+    std::vector<T> v;
+    for (typename sjtu::hive<T>::const_iterator it = h.cbegin(); it != h.cend(); ++it)
+        v.push_back(*it);
+    std::sort(v.begin(), v.end());
+    return v;
+}
+
+int alive = 0;
+class Counted {
+public:
+    int key;
+    Counted(int k) : key(k) { alive++; }
+    Counted(const Counted &other) : key(other.key) { alive++; }
+    ~Counted() { alive--; }
+};
+
+bool testInsertErase() {
+    sjtu::hive<int> h;
+    std::vector<int> ans;
+    std::vector<sjtu::hive<int>::iterator> its;
+    for (int i = 0; i < N; ++i) {
+        if (its.empty() || rand() % 3) {
+            int x = rand();
+            its.push_back(h.insert(x));
+            ans.push_back(x);
+        } else {
+            size_t k = rand() % its.size();
+            ans.erase(std::find(ans.begin(), ans.end(), *its[k]));
+            h.erase(its[k]);
+            its[k] = its.back();
+            its.pop_back();
+        }
+    }
+    std::sort(ans.begin(), ans.end());
+    return h.size() == ans.size() && contents(h) == ans;
+}
+
+bool testStableIterators() {
+    sjtu::hive<int> h;
+    std::vector<sjtu::hive<int>::iterator> its;
+    std::vector<int *> addresses;
+    for (int i = 0; i < 1000; ++i) {
+        its.push_back(h.insert(i));
+        addresses.push_back(&*its.back());
+    }
+    for (int i = 0; i < 1000; i += 3)
+        h.erase(its[i]);
+    for (int i = 0; i < 5000; ++i)
+        h.insert(-i);
+    for (int i = 0; i < 1000; ++i)
+        if (i % 3 && (&*its[i] != addresses[i] || *its[i] != i))
+            return false;
+    return h.size() == 1000 - 334 + 5000;
+}
+
+bool testSlotReuse() {
+    sjtu::hive<int> h;
+    std::vector<sjtu::hive<int>::iterator> its;
+    for (int i = 0; i < 4096; ++i)
+        its.push_back(h.insert(i));
+    size_t capa = h.capacity();
+    for (int i = 0; i < 4096; ++i)
+        if (i % 5 != 0 && i % 7 != 0)
+            h.erase(its[i]);
+    for (int i = 0; i < 4096; ++i)
+        if (i % 5 != 0 && i % 7 != 0)
+            h.insert(-i);
+    return h.capacity() == capa && h.size() == 4096;
+}
+
+bool testBothDirections() {
+    sjtu::hive<int> h;
+    std::vector<sjtu::hive<int>::iterator> its;
+    for (int i = 0; i < N; ++i)
+        its.push_back(h.insert(i));
+    for (int i = 0; i < N; ++i)
+        if (rand() % 4)
+            h.erase(its[i]);
+    std::vector<int> forward, backward;
+    for (sjtu::hive<int>::iterator it = h.begin(); it != h.end(); ++it)
+        forward.push_back(*it);
+    sjtu::hive<int>::iterator it = h.end();
+    while (it != h.begin())
+        backward.push_back(*--it);
+    std::reverse(backward.begin(), backward.end());
+    if (forward != backward || forward.size() != h.size())
+        return false;
+    sjtu::hive<int>::iterator cur = h.begin();
+    while (cur != h.end())
+        cur = h.erase(cur);
+    return h.empty() && h.begin() == h.end() && h.capacity() == 0;
+}
+
+bool testObjects() {
+    {
+        sjtu::hive<Counted> h;
+        std::vector<sjtu::hive<Counted>::iterator> its;
+        for (int i = 0; i < 1000; ++i)
+            its.push_back(h.insert(Counted(i)));
+        for (int i = 0; i < 1000; i += 2)
+            h.erase(its[i]);
+        if (alive != 500)
+            return false;
+        sjtu::hive<Counted> copy(h);
+        if (alive != 1000 || copy.size() != 500)
+            return false;
+        copy = h;
+        copy.insert(Counted(-1));
+        if (alive != 1001)
+            return false;
+    }
+    sjtu::hive<std::string> s;
+    s.insert(std::string(100, 'a'));
+    s.insert("short");
+    s.erase(s.begin());
+    return alive == 0 && s.size() == 1 && (*s.begin() == "short" || *s.begin() == std::string(100, 'a'));
+}
+
+int copiesLeft = -1;
+class Fragile {
+public:
+    int key;
+    Fragile(int k) : key(k) { alive++; }
+    Fragile(const Fragile &other) : key(other.key) {
+        if (copiesLeft == 0) throw std::runtime_error("copy failed");
+        if (copiesLeft > 0) copiesLeft--;
+        alive++;
+    }
+    ~Fragile() { alive--; }
+};
+
+// a throwing copy leaves no half-built slot behind, in a fresh, a reused or a new block
+bool testThrowingCopy() {
+    {
+        sjtu::hive<Fragile> h;
+        std::vector<sjtu::hive<Fragile>::iterator> its;
+        Fragile x(7);
+        int caught = 0;
+        copiesLeft = 0;
+        try { h.insert(x); } catch (std::runtime_error &) { caught++; }
+        if (!h.empty() || h.begin() != h.end() || alive != 1)
+            return false;
+        copiesLeft = -1;
+        for (int i = 0; i < 100; ++i)
+            its.push_back(h.insert(Fragile(i)));
+        copiesLeft = 0;
+        try { h.insert(x); } catch (std::runtime_error &) { caught++; }
+        for (int i = 10; i < 20; ++i)
+            h.erase(its[i]);
+        try { h.insert(x); } catch (std::runtime_error &) { caught++; }
+        try { h.insert(x); } catch (std::runtime_error &) { caught++; }
+        copiesLeft = 50;
+        try { sjtu::hive<Fragile> copy(h); } catch (std::runtime_error &) { caught++; }
+        copiesLeft = -1;
+        if (caught != 5 || h.size() != 90 || alive != 91)
+            return false;
+        size_t seen = 0;
+        for (sjtu::hive<Fragile>::iterator it = h.begin(); it != h.end(); ++it, ++seen)
+            if (it->key >= 10 && it->key < 20)
+                return false;
+        if (seen != 90)
+            return false;
+        // the slots given back are used again
+        for (int i = 0; i < 10; ++i)
+            h.insert(x);
+        if (h.size() != 100 || alive != 101)
+            return false;
+        for (sjtu::hive<Fragile>::iterator it = h.begin(); it != h.end();)
+            it = h.erase(it);
+        if (alive != 1)
+            return false;
+    }
+    return alive == 0;
+}
+
+bool testExceptions() {
+    sjtu::hive<int> h;
+    int caught = 0;
+    try { h.erase(h.begin()); } catch (sjtu::container_is_empty &) { caught++; }
+    h.insert(1);
+    try { h.erase(h.end()); } catch (sjtu::invalid_iterator &) { caught++; }
+    try { *h.end(); } catch (sjtu::invalid_iterator &) { caught++; }
+    try { ++h.end(); } catch (sjtu::invalid_iterator &) { caught++; }
+    try { --h.begin(); } catch (sjtu::invalid_iterator &) { caught++; }
+    sjtu::hive<int> other;
+    other.insert(2);
+    try { h.erase(other.begin()); } catch (sjtu::invalid_iterator &) { caught++; }
+    return caught == 6;
+}
+
+int main(){
+    srand(20220207);
+    bool (*testList[])() = {
+            testInsertErase, testStableIterators, testSlotReuse, testBothDirections, testObjects, testThrowingCopy, testExceptions
+    };
+    const char* Messages[] = {
+            "Test 1: Testing insert and erase...",
+            "Test 2: Testing iterator stability...",
+            "Test 3: Testing erased slot reuse...",
+            "Test 4: Testing forward and backward iteration...",
+            "Test 5: Testing element lifetimes...",
+            "Test 6: Testing a throwing copy...",
+            "Test 7: Testing exceptions..."
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
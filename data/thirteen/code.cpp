@@ -0,0 +1,174 @@
+// apply_edits(): batched positional inserts and erases
+
+#include "list.hpp"
+
+#include <iostream>
+#include <vector>
+
+const int N = 1e5;
+
+class NoDefault {
+public:
+    int value;
+    explicit NoDefault(int v) : value(v) {}
+    bool operator<(const NoDefault &rhs) const { return value < rhs.value; }
+    bool operator==(const NoDefault &rhs) const { return value == rhs.value; }
+};
+
+template<typename T>
+bool equal(const std::vector<T> &x, const sjtu::list<T> &y) {
+    if (x.size() != y.size())
+        return false;
+
+    typename sjtu::list<T>::const_iterator ity = y.cbegin();
+    for (size_t i = 0; i < x.size(); ++i, ++ity)
+        if (!(x[i] == *ity))
+            return false;
+
+    return true;
+}
+
+// the edits applied one original index at a time
+struct Edit {
+    bool erase;
+    size_t position;
+    int value;
+};
+
+std::vector<int> reference(const std::vector<int> &original, const std::vector<Edit> &edits) {
+    std::vector<std::vector<int>> before(original.size() + 1);
+    std::vector<bool> erased(original.size(), false);
+    for (const Edit &e : edits) {
+        if (e.erase)
+            erased[e.position] = true;
+        else
+            before[e.position].push_back(e.value);
+    }
+    std::vector<int> result;
+    for (size_t i = 0; i <= original.size(); ++i) {
+        result.insert(result.end(), before[i].begin(), before[i].end());
+        if (i < original.size() && !erased[i])
+            result.push_back(original[i]);
+    }
+    return result;
+}
+
+bool testRandomBatches() {
+    std::vector<int> ans;
+    sjtu::list<int> myList;
+    for (int round = 0; round < 50; ++round) {
+        std::vector<Edit> edits;
+        std::vector<bool> taken(ans.size(), false);
+        sjtu::list<int>::edit_batch batch;
+        int k = rand() % 200;
+        for (int i = 0; i < k; ++i) {
+            Edit e;
+            e.erase = !ans.empty() && rand() % 2;
+            e.position = rand() % (ans.size() + (e.erase ? 0 : 1));
+            e.value = rand();
+            if (e.erase && taken[e.position])
+                continue;
+            if (e.erase) {
+                taken[e.position] = true;
+                batch.erase(e.position);
+            } else {
+                batch.insert(e.position, e.value);
+            }
+            edits.push_back(e);
+        }
+        myList.apply_edits(batch);
+        ans = reference(ans, edits);
+        if (!batch.empty() || !equal(ans, myList))
+            return false;
+    }
+    return true;
+}
+
+bool testLargeBatch() {
+    sjtu::list<int> myList;
+    std::vector<int> original;
+    for (int i = 0; i < N; ++i) {
+        myList.push_back(i);
+        original.push_back(i);
+    }
+    std::vector<Edit> edits;
+    sjtu::list<int>::edit_batch batch;
+    for (int i = N - 1; i >= 0; i -= 2) {
+        batch.erase(i);
+        batch.insert(i, -i);
+        edits.push_back({true, size_t(i), 0});
+        edits.push_back({false, size_t(i), -i});
+    }
+    myList.apply_edits(batch);
+    return equal(reference(original, edits), myList);
+}
+
+bool testNoDefault() {
+    sjtu::list<NoDefault> myList;
+    for (int i = 0; i < 5; ++i)
+        myList.push_back(NoDefault(i));
+    sjtu::list<NoDefault>::edit_batch batch;
+    batch.insert(5, NoDefault(50));
+    batch.insert(0, NoDefault(-1));
+    batch.erase(2);
+    batch.insert(2, NoDefault(20));
+    batch.insert(2, NoDefault(21));
+    myList.apply_edits(batch);
+    std::vector<NoDefault> ans = {NoDefault(-1), NoDefault(0), NoDefault(1), NoDefault(20), NoDefault(21),
+                                  NoDefault(3), NoDefault(4), NoDefault(50)};
+    return equal(ans, myList);
+}
+
+bool testBadPositions() {
+    sjtu::list<int> myList;
+    for (int i = 0; i < 10; ++i)
+        myList.push_back(i);
+    int caught = 0;
+    sjtu::list<int>::edit_batch batch;
+    batch.insert(3, 100);
+    batch.erase(10);
+    try { myList.apply_edits(batch); } catch (sjtu::index_out_of_bound &) { caught++; }
+    if (myList.size() != 10 || batch.size() != 2)
+        return false;
+    batch.clear();
+    batch.erase(4);
+    batch.insert(11, 100);
+    try { myList.apply_edits(batch); } catch (sjtu::index_out_of_bound &) { caught++; }
+    batch.clear();
+    batch.erase(4);
+    batch.erase(4);
+    try { myList.apply_edits(batch); } catch (sjtu::index_out_of_bound &) { caught++; }
+    batch.clear();
+    myList.apply_edits(batch);
+    std::vector<int> ans = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    return caught == 3 && equal(ans, myList);
+}
+
+int main(){
+    srand(20220207);
+    bool (*testList[])() = {
+            testRandomBatches, testLargeBatch, testNoDefault, testBadPositions
+    };
+    const char* Messages[] = {
+            "Test 1: Testing random batches against one edit at a time...",
+            "Test 2: Testing a batch as long as the list...",
+            "Test 3: Testing values without default constructor...",
+            "Test 4: Testing positions out of range..."
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
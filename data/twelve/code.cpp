@@ -0,0 +1,151 @@
+// combining_list: operations published by many threads
+
+#include "combining_list.hpp"
+#include "list.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+const int THREADS = 4;
+const int N = 20000;
+
+bool testSequential() {
+    sjtu::combining_list<int> shared;
+    sjtu::list<int> ans;
+    for (int i = 0; i < N; ++i) {
+        int op = rand() % 4, x = rand(), got = -1, expect = -1;
+        bool found, expectFound = !ans.empty();
+        switch (op) {
+            case 0: shared.push_back(x); ans.push_back(x); break;
+            case 1: shared.push_front(x); ans.push_front(x); break;
+            case 2:
+                found = shared.pop_back(got);
+                if (expectFound) expect = ans.back(), ans.pop_back();
+                if (found != expectFound || got != expect) return false;
+                break;
+            default:
+                found = shared.pop_front(got);
+                if (expectFound) expect = ans.front(), ans.pop_front();
+                if (found != expectFound || got != expect) return false;
+        }
+    }
+    return shared.size() == ans.size();
+}
+
+bool testConcurrentPush() {
+    sjtu::combining_list<int> shared;
+    std::vector<std::thread> pool;
+    for (int t = 0; t < THREADS; ++t)
+        pool.emplace_back([&shared, t]() {
+            for (int i = 0; i < N; ++i) {
+                if (i % 2) shared.push_back(t * N + i);
+                else shared.push_front(t * N + i);
+            }
+        });
+    for (int t = 0; t < THREADS; ++t)
+        pool[t].join();
+    std::vector<int> seen;
+    for (sjtu::list<int>::const_iterator it = shared.unsafe_list().cbegin(); it != shared.unsafe_list().cend(); ++it)
+        seen.push_back(*it);
+    std::sort(seen.begin(), seen.end());
+    for (int i = 0; i < THREADS * N; ++i)
+        if (seen[i] != i)
+            return false;
+    return true;
+}
+
+bool testConcurrentMixed() {
+    sjtu::combining_list<int> shared;
+    std::vector<std::thread> pool;
+    std::vector<std::vector<int>> popped(THREADS);
+    for (int t = 0; t < THREADS; ++t)
+        pool.emplace_back([&shared, &popped, t]() {
+            for (int i = 0; i < N; ++i) {
+                shared.push_back(t * N + i);
+                int x;
+                if (i % 3 == 0 && shared.pop_front(x))
+                    popped[t].push_back(x);
+            }
+        });
+    for (int t = 0; t < THREADS; ++t)
+        pool[t].join();
+    std::vector<int> seen;
+    for (int t = 0; t < THREADS; ++t)
+        seen.insert(seen.end(), popped[t].begin(), popped[t].end());
+    int x;
+    while (shared.pop_back(x))
+        seen.push_back(x);
+    std::sort(seen.begin(), seen.end());
+    if (seen.size() != size_t(THREADS * N))
+        return false;
+    for (int i = 0; i < THREADS * N; ++i)
+        if (seen[i] != i)
+            return false;
+    return shared.size() == 0;
+}
+
+bool testApply() {
+    sjtu::combining_list<int> shared;
+    std::vector<std::thread> pool;
+    for (int t = 0; t < THREADS; ++t)
+        pool.emplace_back([&shared, t]() {
+            for (int i = 0; i < 500; ++i) {
+                int x = (i * 7919 + t * 104729) % 10007;
+                shared.apply([x](sjtu::list<int> &items) {
+                    sjtu::list<int>::iterator it = items.begin();
+                    while (it != items.end() && *it < x)
+                        ++it;
+                    items.insert(it, x);
+                });
+            }
+        });
+    for (int t = 0; t < THREADS; ++t)
+        pool[t].join();
+    sjtu::list<int> &items = shared.unsafe_list();
+    if (items.size() != size_t(THREADS * 500))
+        return false;
+    int last = -1;
+    for (sjtu::list<int>::const_iterator it = items.cbegin(); it != items.cend(); ++it) {
+        if (*it < last)
+            return false;
+        last = *it;
+    }
+    try {
+        shared.apply([](sjtu::list<int> &) { throw std::runtime_error("from the combiner"); });
+    } catch (std::runtime_error &) {
+        return shared.size() == size_t(THREADS * 500);
+    }
+    return false;
+}
+
+int main(){
+    srand(20220207);
+    bool (*testList[])() = {
+            testSequential, testConcurrentPush, testConcurrentMixed, testApply
+    };
+    const char* Messages[] = {
+            "Test 1: Testing operations against list...",
+            "Test 2: Testing concurrent push_back and push_front...",
+            "Test 3: Testing concurrent push_back and pop_front...",
+            "Test 4: Testing apply and its exceptions..."
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
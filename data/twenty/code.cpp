@@ -0,0 +1,211 @@
+// unordered_map: Swiss table against std::unordered_map
+
+#include "class-bint.hpp"
+#include "unordered_map.hpp"
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+const int N = 1e5;
+
+int alive = 0;
+class Counted {
+public:
+    int value;
+    Counted() : value(0) { alive++; }
+    Counted(int v) : value(v) { alive++; }
+    Counted(const Counted &other) : value(other.value) { alive++; }
+    Counted &operator=(const Counted &) = default;
+    ~Counted() { alive--; }
+};
+
+// hashes std::string and C strings alike, for lookups without a temporary string
+struct StringHash {
+    typedef void is_transparent;
+    size_t operator()(const std::string &s) const { return std::hash<std::string>()(s); }
+    size_t operator()(const char *s) const { return std::hash<std::string>()(std::string(s)); }
+};
+struct StringEqual {
+    typedef void is_transparent;
+    bool operator()(const std::string &a, const std::string &b) const { return a == b; }
+    bool operator()(const std::string &a, const char *b) const { return a == b; }
+};
+
+// a hash that counts its calls in the counter it was built with
+int *hashCounter = nullptr;
+struct CountingHash {
+    int *calls = hashCounter;
+    size_t operator()(int k) const { ++*calls; return std::hash<int>()(k); }
+};
+
+template<class K, class V, class H, class E>
+bool equal(const std::unordered_map<K, V> &x, const sjtu::unordered_map<K, V, H, E> &y) {
+    if (x.size() != y.size())
+        return false;
+    size_t seen = 0;
+    for (typename sjtu::unordered_map<K, V, H, E>::const_iterator it = y.cbegin(); it != y.cend(); ++it, ++seen) {
+        typename std::unordered_map<K, V>::const_iterator found = x.find(it->first);
+        if (found == x.end() || !(found->second == it->second))
+            return false;
+    }
+    return seen == x.size();
+}
+
+bool testRandomOperations() {
+    std::unordered_map<int, int> ans;
+    sjtu::unordered_map<int, int> myMap;
+    for (int i = 0; i < N; ++i) {
+        int op = rand() % 10, key = rand() % 30000, value = rand();
+        if (op < 4) {
+            bool inserted = ans.insert({key, value}).second;
+            sjtu::pair<sjtu::unordered_map<int, int>::iterator, bool> result = myMap.insert(sjtu::unordered_map<int, int>::value_type(key, value));
+            if (result.second != inserted || result.first->first != key || result.first->second != ans[key])
+                return false;
+        } else if (op < 7) {
+            if (ans.erase(key) != myMap.erase(key))
+                return false;
+        } else if (op < 8) {
+            ans[key] ^= value, myMap[key] ^= value;
+        } else {
+            std::unordered_map<int, int>::iterator itx = ans.find(key);
+            sjtu::unordered_map<int, int>::iterator ity = myMap.find(key);
+            if ((itx == ans.end()) != (ity == myMap.end()) || (itx != ans.end() && ity->second != itx->second))
+                return false;
+            if (itx != ans.end() && op == 9)
+                ans.erase(itx), myMap.erase(ity);
+        }
+        if (i % 5000 == 0 && !equal(ans, myMap))
+            return false;
+    }
+    return equal(ans, myMap);
+}
+
+bool testChurnAndReserve() {
+    // a sliding window of keys: tombstones must be reclaimed instead of growing the table
+    sjtu::unordered_map<long long, int> myMap;
+    for (long long k = 0; k < N; ++k) {
+        myMap[k] = int(k);
+        if (k >= 1000 && myMap.erase(k - 1000) != 1)
+            return false;
+    }
+    if (myMap.size() != 1000 || myMap.bucket_count() > 4096)
+        return false;
+    sjtu::unordered_map<int, int> reserved;
+    reserved.reserve(N);
+    size_t buckets = reserved.bucket_count();
+    for (int i = 0; i < N; ++i)
+        reserved[i * 7] = i;
+    if (reserved.bucket_count() != buckets || reserved.size() != size_t(N))
+        return false;
+    for (sjtu::unordered_map<int, int>::iterator it = reserved.begin(); it != reserved.end();)
+        it = it->first % 2 ? reserved.erase(it) : ++it;
+    for (int i = 0; i < N; ++i)
+        if (reserved.count(i * 7) != size_t(i % 2 == 0))
+            return false;
+    reserved.clear();
+    return reserved.empty() && reserved.begin() == reserved.end() && reserved.bucket_count() == buckets;
+}
+
+bool testBintKeys() {
+    std::unordered_map<Util::Bint, int> ans;
+    sjtu::unordered_map<Util::Bint, int> myMap;
+    for (int i = 0; i < 3000; ++i) {
+        std::string digits(1, char('1' + rand() % 9));
+        for (int j = rand() % 30; j > 0; --j)
+            digits += char('0' + rand() % 10);
+        Util::Bint key(rand() % 4 ? digits : "-" + digits);
+        if (rand() % 3)
+            ans[key] = i, myMap[key] = i;
+        else if (ans.erase(key) != myMap.erase(key))
+            return false;
+    }
+    return equal(ans, myMap) && myMap.count(Util::Bint(12345) * Util::Bint(-1)) == ans.count(Util::Bint(-12345));
+}
+
+bool testHeterogeneous() {
+    sjtu::unordered_map<std::string, int, StringHash, StringEqual> myMap;
+    std::unordered_map<std::string, int> ans;
+    for (int i = 0; i < 2000; ++i) {
+        std::string key = "key" + std::to_string(i);
+        myMap[key] = i, ans[key] = i;
+    }
+    if (myMap.find("key42")->second != 42 || myMap.count("key2000") != 0 || myMap.find("nope") != myMap.end())
+        return false;
+    if (myMap.erase("key7") != 1 || myMap.erase("key7") != 0)
+        return false;
+    ans.erase("key7");
+    const sjtu::unordered_map<std::string, int, StringHash, StringEqual> copy(myMap);
+    int caught = 0;
+    try { copy.at("key7"); } catch (sjtu::index_out_of_bound &) { caught++; }
+    try { *myMap.end(); } catch (sjtu::invalid_iterator &) { caught++; }
+    try { myMap.erase(myMap.end()); } catch (sjtu::invalid_iterator &) { caught++; }
+    return caught == 3 && copy.find("key1999")->second == 1999 && equal(ans, myMap) && equal(ans, copy);
+}
+
+bool testOwnership() {
+    {
+        sjtu::unordered_map<int, Counted> myMap;
+        for (int i = 0; i < 5000; ++i)
+            myMap[rand() % 3000] = Counted(i);
+        size_t n = myMap.size();
+        sjtu::unordered_map<int, Counted> copy(myMap), assigned;
+        for (int i = 0; i < 3000; i += 2)
+            copy.erase(i);
+        assigned[1] = Counted(1);
+        assigned = copy;
+        if (alive != int(n + 2 * copy.size()))
+            return false;
+        copy.clear();
+    }
+    return alive == 0;
+}
+
+// an assigned map hashes with the functors of its source, as a copy does
+bool testAssignedFunctors() {
+    int sourceCalls = 0, targetCalls = 0;
+    hashCounter = &sourceCalls;
+    sjtu::unordered_map<int, int, CountingHash> source;
+    for (int i = 0; i < 100; ++i)
+        source[i] = i;
+    hashCounter = &targetCalls;
+    sjtu::unordered_map<int, int, CountingHash> target;
+    target[-1] = -1;
+    target = source;
+    sourceCalls = targetCalls = 0;
+    for (int i = 0; i < 100; ++i)
+        if (target.find(i) == target.end())
+            return false;
+    return sourceCalls == 100 && targetCalls == 0 && target.count(-1) == 0;
+}
+
+int main(){
+    srand(20220207);
+    bool (*testList[])() = {
+            testRandomOperations, testChurnAndReserve, testBintKeys, testHeterogeneous, testOwnership, testAssignedFunctors
+    };
+    const char* Messages[] = {
+            "Test 1: Testing random operations against std::unordered_map...",
+            "Test 2: Testing erase churn and reserve()...",
+            "Test 3: Testing Bint keys...",
+            "Test 4: Testing lookups by C string...",
+            "Test 5: Testing that elements are freed...",
+            "Test 6: Testing that assignment copies the functors..."
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
@@ -0,0 +1,216 @@
+// channel: coroutines passing values through bounded channels on one executor
+
+#include "channel.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// counts the allocations, to check that passing values allocates nothing
+size_t allocations = 0;
+void *operator new(size_t size) {
+    allocations++;
+    void *p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+int alive = 0;
+class Counted {
+public:
+    int value;
+    Counted(int v) : value(v) { alive++; }
+    Counted(const Counted &other) : value(other.value) { alive++; }
+    Counted(Counted &&other) : value(other.value) { alive++; }
+    Counted &operator=(Counted &&other) { value = other.value; return *this; }
+    ~Counted() { alive--; }
+};
+
+sjtu::task produce(sjtu::channel<int> &out, int from, int to, bool closeAfter) {
+    for (int i = from; i < to; ++i)
+        co_await out.send(i);
+    if (closeAfter)
+        out.close();
+}
+
+sjtu::task collect(sjtu::channel<int> &in, std::vector<int> &into) {
+    while (std::optional<int> x = co_await in.recv())
+        into.push_back(*x);
+}
+
+sjtu::task square(sjtu::channel<int> &in, sjtu::channel<int> &out) {
+    while (std::optional<int> x = co_await in.recv())
+        co_await out.send(*x * *x);
+    out.close();
+}
+
+bool testProducerConsumer() {
+    for (size_t capacity : {0, 1, 4, 100}) {
+        sjtu::executor ex;
+        sjtu::channel<int> ch(ex, capacity);
+        std::vector<int> got;
+        got.reserve(10000);
+        ex.spawn(collect(ch, got));
+        ex.spawn(produce(ch, 0, 10000, true));
+        ex.run();
+        if (ex.pending() != 0 || got.size() != 10000 || ch.capacity() != capacity)
+            return false;
+        for (int i = 0; i < 10000; ++i)
+            if (got[i] != i)
+                return false;
+    }
+    return true;
+}
+
+bool testPipeline() {
+    sjtu::executor ex;
+    sjtu::channel<int> numbers(ex, 8), squares(ex, 2);
+    std::vector<int> got;
+    got.reserve(3000);
+    ex.spawn(collect(squares, got));
+    ex.spawn(square(numbers, squares));
+    // three producers fan in; each one's values keep their order
+    ex.spawn(produce(numbers, 0, 1000, false));
+    ex.spawn(produce(numbers, 1000, 2000, false));
+    ex.spawn(produce(numbers, 2000, 3000, false));
+    ex.run();
+    if (ex.pending() != 2)
+        return false;
+    numbers.close();
+    ex.run();
+    if (ex.pending() != 0 || got.size() != 3000)
+        return false;
+    int last[3] = {-1, -1, -1};
+    long long sum = 0;
+    for (size_t i = 0; i < got.size(); ++i) {
+        int root = 0;
+        while ((root + 1) * (root + 1) <= got[i])
+            root++;
+        if (root <= last[root / 1000])
+            return false;
+        last[root / 1000] = root;
+        sum += root;
+    }
+    return sum == 2999LL * 3000 / 2;
+}
+
+bool testNoAllocations() {
+    sjtu::executor ex;
+    sjtu::channel<int> ch(ex, 16);
+    std::vector<int> got;
+    got.reserve(100000);
+    ex.spawn(collect(ch, got));
+    ex.spawn(produce(ch, 0, 100000, true));
+    // the first resumptions size the ready queue; after that nothing is allocated
+    size_t before = allocations;
+    ex.run();
+    return got.size() == 100000 && allocations - before <= 4;
+}
+
+sjtu::task sendAll(sjtu::channel<std::string> &ch, int n, int &sent) {
+    for (int i = 0; i < n; ++i) {
+        bool ok = co_await ch.send(std::to_string(i));
+        sent += ok;
+    }
+}
+
+sjtu::task receiveOnce(sjtu::channel<std::string> &ch, int &empty) {
+    std::optional<std::string> got = co_await ch.recv();
+    empty += !got;
+}
+
+bool testClose() {
+    sjtu::executor ex;
+    sjtu::channel<std::string> ch(ex, 3);
+    int sent = 0, empty = 0;
+    ex.spawn(sendAll(ch, 10, sent));
+    ex.run();
+    // three buffered, one sender waiting; closing fails the waiting send and the rest
+    if (sent != 3 || ch.size() != 3 || ex.pending() != 1)
+        return false;
+    ch.close();
+    ex.run();
+    if (sent != 3 || ex.pending() != 0 || !ch.is_closed())
+        return false;
+    std::string s;
+    int drained = 0;
+    while (ch.try_recv(s))
+        drained += s == std::to_string(drained);
+    ex.spawn(receiveOnce(ch, empty));
+    ex.run();
+    // receivers waiting on an open channel are woken by close()
+    sjtu::channel<std::string> other(ex, 1);
+    ex.spawn(receiveOnce(other, empty));
+    ex.spawn(receiveOnce(other, empty));
+    ex.run();
+    if (ex.pending() != 2 || !other.try_send("x"))
+        return false;
+    ex.run();
+    other.close();
+    ex.run();
+    return drained == 3 && empty == 2 && ex.pending() == 0 && !ch.try_send("late");
+}
+
+sjtu::task fail(sjtu::channel<Counted> &ch) {
+    co_await ch.send(Counted(1));
+    throw std::runtime_error("stage failed");
+}
+
+sjtu::task stuck(sjtu::channel<Counted> &ch) {
+    Counted local(2);
+    co_await ch.send(Counted(3));
+    co_await ch.send(Counted(4));
+}
+
+bool testErrorsAndCleanup() {
+    int caught = 0;
+    {
+        sjtu::executor ex;
+        sjtu::channel<Counted> ch(ex, 1);
+        ex.spawn(fail(ch));
+        ex.spawn(stuck(ch));
+        try { ex.run(); } catch (std::runtime_error &) { caught++; }
+        // the failed task is gone; the other one still runs and then waits forever
+        ex.run();
+        if (ex.pending() != 1 || ch.size() != 1)
+            return false;
+    }
+    return caught == 1 && alive == 0;
+}
+
+int main(){
+    srand(20220207);
+    bool (*testList[])() = {
+            testProducerConsumer, testPipeline, testNoAllocations, testClose, testErrorsAndCleanup
+    };
+    const char* Messages[] = {
+            "Test 1: Testing a producer and a consumer...",
+            "Test 2: Testing a pipeline with fan-in...",
+            "Test 3: Testing that passing values allocates nothing...",
+            "Test 4: Testing close()...",
+            "Test 5: Testing exceptions and waiting tasks..."
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
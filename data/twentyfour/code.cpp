@@ -0,0 +1,182 @@
+// sharded_log: per-thread shards collected by splicing, ordered by stamps
+
+#include "sharded_log.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+std::atomic<int> copies(0), alive(0);
+class Event {
+public:
+    int thread, seq;
+    Event(int t, int s) : thread(t), seq(s) { alive++; }
+    Event(const Event &other) : thread(other.thread), seq(other.seq) { alive++, copies++; }
+    ~Event() { alive--; }
+};
+
+template<class F>
+void runThreads(int threads, F body) {
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t)
+        pool.emplace_back(body, t);
+    for (size_t t = 0; t < pool.size(); ++t)
+        pool[t].join();
+}
+
+bool testSingleThread() {
+    sjtu::sharded_log<int> log(4);
+    if (log.shard_count() != 4 || log.is_stamped() || !log.collect().empty())
+        return false;
+    for (int i = 0; i < 1000; ++i)
+        log.append(i);
+    if (log.size() != 1000)
+        return false;
+    sjtu::list<int> all;
+    all.push_back(-1);
+    log.collect_into(all);
+    int expect = -1;
+    for (sjtu::list<int>::iterator it = all.begin(); it != all.end(); ++it, ++expect)
+        if (*it != expect)
+            return false;
+    int caught = 0;
+    try { log.collect_ordered(); } catch (sjtu::runtime_error &) { caught++; }
+    sjtu::sharded_log<int> automatic;
+    return caught == 1 && expect == 1000 && log.size() == 0 && automatic.shard_count() >= 1;
+}
+
+bool testCollectWhileAppending() {
+    // every thread's events come out once each and in its own order, across flushes
+    const int threads = 6, perThread = 20000;
+    sjtu::sharded_log<Event> log(4);
+    std::atomic<int> finished(0);
+    std::vector<int> next(threads, 0);
+    bool okay = true;
+    int copiesBefore = copies;
+    std::thread reader([&]() {
+        while (true) {
+            bool last = finished == threads;
+            sjtu::list<Event> flushed = log.collect();
+            for (sjtu::list<Event>::iterator it = flushed.begin(); it != flushed.end(); ++it)
+                okay = okay && it->seq == next[it->thread]++;
+            if (last)
+                break;
+            std::this_thread::yield();
+        }
+    });
+    runThreads(threads, [&](int t) {
+        for (int i = 0; i < perThread; ++i)
+            log.append(Event(t, i));
+        finished++;
+    });
+    reader.join();
+    for (int t = 0; t < threads; ++t)
+        okay = okay && next[t] == perThread;
+    return okay && copies == copiesBefore + threads * perThread && alive == 0;
+}
+
+bool testOrderedCollect() {
+    // the threads take turns, so the order of the appends is known: 0, 1, 2, ...
+    const int threads = 4, total = 2000;
+    sjtu::sharded_log<int> log(threads, true);
+    std::atomic<int> turn(0);
+    runThreads(threads, [&](int t) {
+        for (int i = t; i < total; i += threads) {
+            while (turn != i)
+                std::this_thread::yield();
+            log.append(i);
+            turn++;
+        }
+    });
+    sjtu::list<int> ordered = log.collect_ordered();
+    int expect = 0;
+    for (sjtu::list<int>::iterator it = ordered.begin(); it != ordered.end(); ++it, ++expect)
+        if (*it != expect)
+            return false;
+    // collecting clears the stamps along with the elements
+    log.append(7), log.append(8);
+    sjtu::list<int> again = log.collect_ordered();
+    return expect == total && ordered.size() == size_t(total) && again.size() == 2
+           && again.front() == 7 && again.back() == 8 && log.collect_ordered().empty();
+}
+
+bool testOrderedWhileAppending() {
+    // stamps ascend within every thread, so each thread's events stay in order
+    const int threads = 8, perThread = 5000;
+    sjtu::sharded_log<Event> log(3, true);
+    runThreads(threads, [&](int t) {
+        for (int i = 0; i < perThread; ++i)
+            log.append(Event(t, i));
+    });
+    std::vector<int> next(threads, 0);
+    sjtu::list<Event> all = log.collect_ordered();
+    for (sjtu::list<Event>::iterator it = all.begin(); it != all.end(); ++it)
+        if (it->seq != next[it->thread]++)
+            return false;
+    return all.size() == size_t(threads * perThread);
+}
+
+bool testOrderedFlushes() {
+    // appenders take turns while a reader keeps collecting: the flushes joined
+    // together must be 0, 1, 2, ... with nothing held back to a later flush
+    const int appenders = 3, total = 20000;
+    sjtu::sharded_log<int> log(appenders + 1, true);
+    std::atomic<int> turn(0);
+    std::vector<int> seen;
+    auto flush = [&]() {
+        sjtu::list<int> part = log.collect_ordered();
+        for (sjtu::list<int>::iterator it = part.begin(); it != part.end(); ++it)
+            seen.push_back(*it);
+    };
+    runThreads(appenders + 1, [&](int t) {
+        if (t == appenders) {
+            while (turn < total)
+                flush();
+            return;
+        }
+        for (int i = t; i < total; i += appenders) {
+            while (turn != i)
+                std::this_thread::yield();
+            log.append(i);
+            turn++;
+        }
+    });
+    flush();
+    if (seen.size() != size_t(total))
+        return false;
+    for (int i = 0; i < total; ++i)
+        if (seen[i] != i)
+            return false;
+    return true;
+}
+
+int main(){
+    srand(20220207);
+    bool (*testList[])() = {
+            testSingleThread, testCollectWhileAppending, testOrderedCollect, testOrderedWhileAppending, testOrderedFlushes
+    };
+    const char* Messages[] = {
+            "Test 1: Testing append() and collect() in one thread...",
+            "Test 2: Testing collect() while threads append...",
+            "Test 3: Testing collect_ordered()...",
+            "Test 4: Testing collect_ordered() with shared shards...",
+            "Test 5: Testing collect_ordered() while threads append..."
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
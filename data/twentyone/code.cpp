@@ -0,0 +1,202 @@
+// join: sort-merge, hash, partitioned hash, semi- and anti-joins against nested loops
+
+#include "join.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+typedef sjtu::pair<int, int> Row;
+typedef sjtu::pair<int, std::string> NamedRow;
+
+template<class K, class V>
+void fill(sjtu::list<sjtu::pair<K, V>> &rows, std::vector<std::pair<K, V>> &copy, int n, int keys, V (*value)(int)) {
+    for (int i = 0; i < n; ++i) {
+        K key = rand() % keys;
+        V v = value(i);
+        rows.push_back(sjtu::pair<K, V>(key, v));
+        copy.push_back(std::make_pair(key, v));
+    }
+}
+
+int plain(int i) { return i; }
+std::string named(int i) { return "v" + std::to_string(i); }
+
+template<class K, class V1, class V2>
+std::vector<std::pair<V1, V2>> nestedLoops(const std::vector<std::pair<K, V1>> &left, const std::vector<std::pair<K, V2>> &right) {
+    std::vector<std::pair<V1, V2>> out;
+    for (size_t i = 0; i < left.size(); ++i)
+        for (size_t j = 0; j < right.size(); ++j)
+            if (left[i].first == right[j].first)
+                out.push_back(std::make_pair(left[i].second, right[j].second));
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+template<class V1, class V2>
+std::vector<std::pair<V1, V2>> collect(const sjtu::list<sjtu::pair<V1, V2>> &rows, bool sorted = true) {
+    std::vector<std::pair<V1, V2>> out;
+    for (typename sjtu::list<sjtu::pair<V1, V2>>::const_iterator it = rows.cbegin(); it != rows.cend(); ++it)
+        out.push_back(std::make_pair((*it).first, (*it).second));
+    if (sorted)
+        std::sort(out.begin(), out.end());
+    return out;
+}
+
+bool testSortMerge() {
+    for (int round = 0; round < 5; ++round) {
+        sjtu::list<Row> left;
+        sjtu::list<NamedRow> right;
+        std::vector<std::pair<int, int>> l;
+        std::vector<std::pair<int, std::string>> r;
+        fill(left, l, 300 + rand() % 300, 50 + round * 40, plain);
+        fill(right, r, 200 + rand() % 300, 50 + round * 40, named);
+        sjtu::list<sjtu::pair<int, std::string>> out = sjtu::sort_merge_join(left, right);
+        if (collect(out) != nestedLoops(l, r) || out.size() != nestedLoops(l, r).size())
+            return false;
+        // the inputs are left sorted by key, stably
+        std::stable_sort(l.begin(), l.end(), [](const std::pair<int, int> &a, const std::pair<int, int> &b) { return a.first < b.first; });
+        if (collect(left, false) != l)
+            return false;
+        // sorted inputs go straight to the merge pass, and the result follows key order
+        sjtu::list<sjtu::pair<int, std::string>> again = sjtu::sort_merge_join(left, right);
+        if (collect(again, false) != collect(out, false))
+            return false;
+    }
+    sjtu::list<Row> empty, some;
+    some.push_back(Row(1, 1));
+    return sjtu::sort_merge_join(empty, some).empty() && sjtu::sort_merge_join(some, empty).empty();
+}
+
+bool testHash() {
+    for (int round = 0; round < 6; ++round) {
+        sjtu::list<Row> left;
+        sjtu::list<NamedRow> right;
+        std::vector<std::pair<int, int>> l;
+        std::vector<std::pair<int, std::string>> r;
+        // alternate which side is smaller so both build sides are exercised
+        int small = 50 + rand() % 100, big = 500 + rand() % 500;
+        fill(left, l, round % 2 ? small : big, 120, plain);
+        fill(right, r, round % 2 ? big : small, 120, named);
+        sjtu::list<sjtu::pair<int, std::string>> out = sjtu::hash_join(left, right);
+        if (collect(out) != nestedLoops(l, r))
+            return false;
+    }
+    sjtu::list<Row> empty, some;
+    some.push_back(Row(1, 1));
+    return sjtu::hash_join(empty, some).empty() && sjtu::hash_join(some, empty).empty();
+}
+
+bool testParallelHash() {
+    sjtu::list<Row> left, right;
+    std::vector<std::pair<int, int>> l, r;
+    fill(left, l, 20000, 15000, plain);
+    fill(right, r, 8000, 15000, plain);
+    std::vector<std::pair<int, int>> serial = collect(sjtu::hash_join(left, right));
+    for (size_t threads = 1; threads <= 4; ++threads) {
+        sjtu::list<Row> out = sjtu::hash_join(left, right, sjtu::parallel_policy(threads));
+        if (collect(out) != serial)
+            return false;
+    }
+    // tiny inputs fall back to the serial join
+    sjtu::list<Row> a, b;
+    a.push_back(Row(3, 1)), b.push_back(Row(3, 2)), b.push_back(Row(4, 3));
+    sjtu::list<Row> tiny = sjtu::hash_join(a, b, sjtu::parallel_policy(8));
+    return tiny.size() == 1 && tiny.front().first == 1 && tiny.front().second == 2;
+}
+
+bool testSemiAnti() {
+    for (int round = 0; round < 5; ++round) {
+        sjtu::list<Row> semi, anti;
+        sjtu::list<NamedRow> right;
+        std::vector<std::pair<int, int>> l, unused;
+        std::vector<std::pair<int, std::string>> r;
+        fill(semi, l, 1000, 400, plain);
+        fill(right, r, 150, 400, named);
+        for (size_t i = 0; i < l.size(); ++i)
+            anti.push_back(Row(l[i].first, l[i].second));
+        // remember the nodes, to check that the kept ones are not copies
+        std::vector<const Row *> nodes;
+        for (sjtu::list<Row>::const_iterator it = semi.cbegin(); it != semi.cend(); ++it)
+            nodes.push_back(&*it);
+        sjtu::semi_join(semi, right);
+        sjtu::anti_join(anti, right);
+        std::vector<std::pair<int, int>> kept, dropped;
+        std::vector<const Row *> keptNodes;
+        for (size_t i = 0; i < l.size(); ++i) {
+            bool found = false;
+            for (size_t j = 0; j < r.size() && !found; ++j)
+                found = l[i].first == r[j].first;
+            (found ? kept : dropped).push_back(l[i]);
+            if (found)
+                keptNodes.push_back(nodes[i]);
+        }
+        if (collect(semi, false) != kept || collect(anti, false) != dropped)
+            return false;
+        size_t at = 0;
+        for (sjtu::list<Row>::const_iterator it = semi.cbegin(); it != semi.cend(); ++it, ++at)
+            if (&*it != keptNodes[at])
+                return false;
+    }
+    return true;
+}
+
+bool testSplice() {
+    sjtu::list<int> a, b, c;
+    for (int i = 0; i < 5; ++i)
+        a.push_back(i), b.push_back(i + 5), c.push_back(-1 - i);
+    const int *moved = &b.front();
+    a.splice(a.end(), b);
+    if (a.size() != 10 || !b.empty() || &*(++++++++++a.begin()) != moved)
+        return false;
+    a.sort();
+    sjtu::list<int> tail;
+    tail.push_back(10), tail.push_back(11);
+    a.splice(a.end(), tail);
+    a.sort();
+    if (a.last_sort().strategy != sjtu::sort_strategy::presorted)
+        return false;
+    a.splice(++a.begin(), c);
+    a.splice(a.begin(), a);
+    int expect[] = {0, -1, -2, -3, -4, -5, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+    int at = 0;
+    for (sjtu::list<int>::iterator it = a.begin(); it != a.end(); ++it, ++at)
+        if (*it != expect[at])
+            return false;
+    b.push_back(1);
+    int caught = 0;
+    try { a.splice(b.begin(), c); } catch (sjtu::invalid_iterator &) { caught++; }
+    return caught == 1 && at == 17 && b.size() == 1;
+}
+
+int main(){
+    srand(20220207);
+    bool (*testList[])() = {
+            testSortMerge, testHash, testParallelHash, testSemiAnti, testSplice
+    };
+    const char* Messages[] = {
+            "Test 1: Testing sort-merge join...",
+            "Test 2: Testing hash join...",
+            "Test 3: Testing partitioned hash join...",
+            "Test 4: Testing semi-join and anti-join...",
+            "Test 5: Testing splice()..."
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
@@ -0,0 +1,286 @@
+// Matrix factorizations: blocked LU with Det / Solve / Inverse, and Bareiss for exact cells
+
+#include "class-matrix-bint.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <string>
+
+using Diamond::Matrix;
+using Util::Bint;
+
+Matrix<double> randomMatrix(size_t rows, size_t cols) {
+    Matrix<double> m(rows, cols);
+    for (size_t i = 0; i < rows; ++i)
+        for (size_t j = 0; j < cols; ++j)
+            m[i][j] = (rand() % 20001 - 10000) / 1000.0;
+    return m;
+}
+
+Matrix<long long> randomIntMatrix(size_t n, int range) {
+    Matrix<long long> m(n, n);
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j)
+            m[i][j] = rand() % (2 * range + 1) - range;
+    return m;
+}
+
+Bint randomBint(size_t digits) {
+    std::string s(1, char('1' + rand() % 9));
+    for (size_t i = 1; i < digits; ++i)
+        s += char('0' + rand() % 10);
+    Bint b(s);
+    return rand() % 2 ? -b : b;
+}
+
+Matrix<Bint> randomBintMatrix(size_t n, size_t digits) {
+    Matrix<Bint> m(n, n);
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j)
+            m[i][j] = randomBint(digits);
+    return m;
+}
+
+double maxDiff(const Matrix<double> &a, const Matrix<double> &b) {
+    double d = 0;
+    for (size_t i = 0; i < a.RowSize(); ++i)
+        for (size_t j = 0; j < a.ColSize(); ++j)
+            d = std::max(d, std::fabs(a[i][j] - b[i][j]));
+    return d;
+}
+
+// P a against L U for every panel width and thread count
+bool testLU() {
+    const size_t sizes[] = {1, 2, 5, 50, 130};
+    const size_t blocks[] = {1, 7, 48, 200};
+    for (size_t n : sizes) {
+        Matrix<double> a = randomMatrix(n, n);
+        for (size_t block : blocks) {
+            for (size_t threads = 1; threads <= 3; threads += 2) {
+                Diamond::LUFactors<double> f = Diamond::LUDecompose(a, block, threads);
+                if (f.singular || f.perm.size() != n)
+                    return false;
+                Matrix<double> l(n, n, 0), u(n, n, 0), pa(n, n);
+                int sign = 1;
+                std::vector<bool> seen(n, false);
+                for (size_t i = 0; i < n; ++i) {
+                    for (size_t j = 0; j < n; ++j) {
+                        if (j < i) l[i][j] = f.lu[i][j];
+                        else u[i][j] = f.lu[i][j];
+                        pa[i][j] = a[f.perm[i]][j];
+                    }
+                    l[i][i] = 1;
+                    if (seen[f.perm[i]])
+                        return false;
+                    seen[f.perm[i]] = true;
+                    // partial pivoting keeps every multiplier at most 1
+                    for (size_t j = 0; j < i; ++j)
+                        if (std::fabs(f.lu[i][j]) > 1)
+                            return false;
+                }
+                for (size_t i = 0; i < n; ++i)
+                    for (size_t j = i + 1; j < n; ++j)
+                        if (f.perm[i] > f.perm[j]) sign = -sign;
+                if (sign != f.sign || maxDiff(l * u, pa) > 1e-9 * n)
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool testSolveInverse() {
+    for (size_t n : {1, 3, 64, 120}) {
+        Matrix<double> a = randomMatrix(n, n), b = randomMatrix(n, 7);
+        Matrix<double> x = Diamond::Solve(a, b);
+        if (maxDiff(a * x, b) > 1e-8)
+            return false;
+        Matrix<double> wide = randomMatrix(n, 70);
+        Matrix<double> xt = Diamond::Solve(Diamond::LUDecompose(a, 16, 4), wide, 4);
+        if (maxDiff(a * xt, wide) > 1e-8)
+            return false;
+        Matrix<double> inv = Diamond::Inverse(a);
+        if (maxDiff(a * inv, Diamond::I<double>(n)) > 1e-8 || maxDiff(inv * a, Diamond::I<double>(n)) > 1e-8)
+            return false;
+    }
+    return true;
+}
+
+bool testDet() {
+    // triangular: the product of the diagonal
+    Matrix<double> t = randomMatrix(20, 20);
+    double expect = 1;
+    for (size_t i = 0; i < 20; ++i) {
+        for (size_t j = 0; j < i; ++j)
+            t[i][j] = 0;
+        t[i][i] = 1 + i % 3;
+        expect *= t[i][i];
+    }
+    if (std::fabs(Diamond::Det(t) - expect) > 1e-9 * expect)
+        return false;
+    // a reversal of 5 rows is an even permutation, of 6 rows an odd one
+    for (size_t n = 5; n <= 6; ++n) {
+        Matrix<double> p(n, n, 0);
+        for (size_t i = 0; i < n; ++i)
+            p[i][n - 1 - i] = 1;
+        if (Diamond::Det(p) != (n == 5 ? 1 : -1))
+            return false;
+    }
+    Matrix<double> a = randomMatrix(30, 30), b = randomMatrix(30, 30);
+    double da = Diamond::Det(a), db = Diamond::Det(b), dab = Diamond::Det(a * b);
+    if (std::fabs(dab - da * db) > 1e-9 * std::fabs(da * db))
+        return false;
+    if (Diamond::Det(Matrix<double>(0, 0)) != 1)
+        return false;
+    return true;
+}
+
+bool testSingularAndErrors() {
+    Matrix<double> a = randomMatrix(40, 40);
+    for (size_t i = 0; i < 40; ++i)
+        a[i][17] = 0;
+    if (Diamond::Det(a) != 0 || !Diamond::LUDecompose(a).singular)
+        return false;
+    Matrix<double> d = randomMatrix(10, 10);
+    for (size_t j = 0; j < 10; ++j)
+        d[7][j] = d[2][j];
+    if (Diamond::Det(d) != 0)
+        return false;
+    int thrown = 0;
+    try { Diamond::Inverse(a); } catch (std::domain_error &) { thrown++; }
+    try { Diamond::Solve(d, randomMatrix(10, 1)); } catch (std::domain_error &) { thrown++; }
+    try { Diamond::LUDecompose(randomMatrix(3, 4)); } catch (std::invalid_argument &) { thrown++; }
+    try { Diamond::LUDecompose(randomMatrix(3, 3), 0); } catch (std::invalid_argument &) { thrown++; }
+    try { Diamond::Solve(randomMatrix(3, 3), randomMatrix(4, 1)); } catch (std::invalid_argument &) { thrown++; }
+    try { Diamond::Det(randomIntMatrix(3, 3) * Matrix<long long>(3, 2, 1)); } catch (std::invalid_argument &) { thrown++; }
+    long long det;
+    Matrix<long long> z(4, 4, 2);
+    try { Diamond::BareissSolve(z, Matrix<long long>(4, 1, 1), det); } catch (std::domain_error &) { thrown++; }
+    return thrown == 7;
+}
+
+bool testBareissIntegers() {
+    for (int round = 0; round < 50; ++round) {
+        Matrix<long long> a = randomIntMatrix(1 + round % 7, 9);
+        Matrix<double> ad(a.RowSize(), a.ColSize());
+        for (size_t i = 0; i < a.RowSize(); ++i)
+            for (size_t j = 0; j < a.ColSize(); ++j)
+                ad[i][j] = a[i][j];
+        if (Diamond::Det(a) != std::llround(Diamond::Det(ad)))
+            return false;
+    }
+    for (int round = 0; round < 20; ++round) {
+        Matrix<long long> a = randomIntMatrix(5, 5), b = randomIntMatrix(5, 5);
+        if (Diamond::Det(a * b) != Diamond::Det(a) * Diamond::Det(b))
+            return false;
+    }
+    // zero leading pivots need row swaps
+    Matrix<long long> s(3, 3, 0);
+    s[0][2] = 2; s[1][0] = 3; s[2][1] = 5;
+    if (Diamond::Det(s) != 30)
+        return false;
+    s[1][0] = 0;
+    if (Diamond::Det(s) != 0)
+        return false;
+    // unimodular, so the adjugate is the inverse up to its sign
+    Matrix<long long> u(3, 3, 0);
+    u[0][0] = 2; u[0][1] = 3; u[0][2] = 1;
+    u[1][0] = 1; u[1][1] = 2; u[1][2] = 1;
+    u[2][0] = 1; u[2][1] = 1; u[2][2] = 1;
+    long long det;
+    Matrix<long long> adj = Diamond::Adjugate(u, det);
+    if (det != 1 || !(u * adj == Diamond::I<long long>(3)))
+        return false;
+    // a zero leading pivot swaps rows, which flips the sign of the last pivot
+    Matrix<long long> p(2, 2, 1);
+    p[0][0] = 0;
+    adj = Diamond::Adjugate(p, det);
+    if (det != -1 || !(p * adj == det * Diamond::I<long long>(2)))
+        return false;
+    for (int round = 0; round < 20; ++round) {
+        Matrix<long long> a = randomIntMatrix(4, 5), b = randomIntMatrix(4, 5);
+        a[0][0] = 0;
+        if (a[0][1] == 0)
+            a[0][1] = 3;
+        if (Diamond::Det(a) == 0)
+            continue;
+        Matrix<long long> y = Diamond::BareissSolve(a, b, det);
+        if (det != Diamond::Det(a) || !(a * y == det * b))
+            return false;
+        adj = Diamond::Adjugate(a, det);
+        if (!(a * adj == det * Diamond::I<long long>(4)))
+            return false;
+    }
+    return true;
+}
+
+bool testBareissBint() {
+    for (size_t n : {1, 4, 12, 30}) {
+        size_t digits = n < 30 ? 15 : 3;
+        Matrix<Bint> a = randomBintMatrix(n, digits), b = randomBintMatrix(n, digits);
+        Bint da = Diamond::Det(a), db = Diamond::Det(b);
+        if (!(Diamond::Det(a * b) == da * db))
+            return false;
+        Matrix<Bint> rhs = randomBintMatrix(n, digits);
+        Bint det;
+        Matrix<Bint> y = Diamond::BareissSolve(a, rhs, det);
+        if (!(det == da) || !(a * y == det * rhs))
+            return false;
+        Bint det3;
+        if (!(Diamond::BareissSolve(a, rhs, det3, 3) == y) || !(det3 == det))
+            return false;
+        Matrix<Bint> adj = Diamond::Adjugate(a, det);
+        if (!(a * adj == det * Diamond::I<Bint>(n)))
+            return false;
+    }
+    // a Bint matrix whose leading pivot is zero
+    Matrix<Bint> s(2, 2, 0);
+    s[0][1] = Bint(std::string("123456789012345678901234567890"));
+    s[1][0] = Bint(7);
+    s[1][1] = Bint(11);
+    if (!(Diamond::Det(s) == -(Bint(7) * s[0][1])))
+        return false;
+    for (size_t n : {3, 8}) {
+        Matrix<Bint> a = randomBintMatrix(n, 12), rhs = randomBintMatrix(n, 12);
+        a[0][0] = 0;
+        Bint det;
+        Matrix<Bint> y = Diamond::BareissSolve(a, rhs, det);
+        if (!(det == Diamond::Det(a)) || !(a * y == det * rhs))
+            return false;
+        Matrix<Bint> adj = Diamond::Adjugate(a, det);
+        if (!(a * adj == det * Diamond::I<Bint>(n)))
+            return false;
+    }
+    return true;
+}
+
+int main(){
+    srand(20220207);
+    bool (*testList[])() = {
+            testLU, testSolveInverse, testDet, testSingularAndErrors, testBareissIntegers, testBareissBint
+    };
+    const char* Messages[] = {
+            "Test 1: Testing blocked LU factors...",
+            "Test 2: Testing Solve and Inverse...",
+            "Test 3: Testing floating point determinants...",
+            "Test 4: Testing singular and malformed input...",
+            "Test 5: Testing Bareiss on integers...",
+            "Test 6: Testing Bareiss on Bint...",
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
@@ -0,0 +1,135 @@
+// learned_index and interpolation search: the same answers as sjtu::lower_bound / upper_bound
+
+#include "algorithm.hpp"
+#include "learned_index.hpp"
+
+#include <climits>
+#include <iostream>
+#include <vector>
+
+// checks every search against sjtu::lower_bound / upper_bound for a query
+template<class T>
+bool sameAnswers(const std::vector<T> &keys, const sjtu::learned_index<T> &index, const T &q) {
+    const T *b = keys.data(), *e = keys.data() + keys.size();
+    T *lower = sjtu::lower_bound(b, e, q), *upper = sjtu::upper_bound(b, e, q);
+    return index.lower_bound(q) == lower && index.upper_bound(q) == upper
+           && sjtu::interpolation_lower_bound(b, e, q) == lower && sjtu::interpolation_upper_bound(b, e, q) == upper;
+}
+
+template<class T>
+bool check(const std::vector<T> &keys, size_t maxError, const std::vector<T> &queries) {
+    sjtu::learned_index<T> index(keys.data(), keys.data() + keys.size(), maxError);
+    if (index.size() != keys.size() || index.max_error() != maxError)
+        return false;
+    for (size_t i = 0; i < keys.size(); ++i)
+        if (!sameAnswers(keys, index, keys[i]))
+            return false;
+    for (size_t i = 0; i < queries.size(); ++i)
+        if (!sameAnswers(keys, index, queries[i]))
+            return false;
+    return true;
+}
+
+template<class T>
+std::vector<T> sorted(std::vector<T> keys) {
+    if (!keys.empty())
+        sjtu::sort<T>(keys.data(), keys.data() + keys.size(), [](const T &a, const T &b) { return a < b; });
+    return keys;
+}
+
+long long random64() {
+    return (long long)((unsigned long long)rand() << 33 ^ (unsigned long long)rand() << 12 ^ rand());
+}
+
+bool testUniform() {
+    std::vector<int> keys, queries;
+    for (int i = 0; i < 50000; ++i)
+        keys.push_back(rand() % 1000000000), queries.push_back(rand() % 1000000000);
+    keys = sorted(keys);
+    queries.push_back(-1), queries.push_back(INT_MIN), queries.push_back(INT_MAX);
+    sjtu::learned_index<int> index(keys.data(), keys.data() + keys.size(), 16);
+    // evenly spread keys need few segments
+    return index.spline_points() < keys.size() / 10 && check(keys, 0, queries) && check(keys, 16, queries)
+           && check(keys, 256, queries);
+}
+
+bool testSkewed() {
+    // squares and a cluster far out: the spline needs many segments, interpolation many bisections
+    std::vector<long long> keys, queries;
+    for (long long i = 0; i < 30000; ++i)
+        keys.push_back(i * i * (i % 3 + 1));
+    for (int i = 0; i < 2000; ++i)
+        keys.push_back(LLONG_MAX / 2 + rand() % 5000);
+    keys = sorted(keys);
+    for (int i = 0; i < 30000; ++i)
+        queries.push_back(random64() % (LLONG_MAX / 2 + 10000));
+    queries.push_back(LLONG_MIN), queries.push_back(LLONG_MAX), queries.push_back(LLONG_MAX / 2 + 2500);
+    return check(keys, 4, queries) && check(keys, 64, queries);
+}
+
+bool testDuplicates() {
+    // long runs of equal keys: absent keys between runs and upper bounds need the widened search
+    std::vector<int> keys, queries;
+    for (int run = 0; run < 300; ++run) {
+        int key = run * 10 - 1500, length = run % 7 == 0 ? 2000 : rand() % 20 + 1;
+        for (int i = 0; i < length; ++i)
+            keys.push_back(key);
+    }
+    for (int q = -1600; q < 1600; ++q)
+        queries.push_back(q);
+    return check(keys, 2, queries) && check(keys, 32, queries);
+}
+
+bool testUnsignedAndNegative() {
+    std::vector<unsigned long long> big, bigQueries;
+    for (int i = 0; i < 20000; ++i)
+        big.push_back((unsigned long long)random64() * 2654435761ULL), bigQueries.push_back((unsigned long long)random64() * 3);
+    big = sorted(big);
+    bigQueries.push_back(0), bigQueries.push_back(ULLONG_MAX);
+    std::vector<short> small, smallQueries;
+    for (int i = 0; i < 5000; ++i)
+        small.push_back(short(rand() % 65536 - 32768));
+    small = sorted(small);
+    for (int q = -32768; q < 32768; q += 7)
+        smallQueries.push_back(short(q));
+    return check(big, 8, bigQueries) && check(small, 8, smallQueries);
+}
+
+bool testTiny() {
+    std::vector<int> empty, one(1, 42), same(100, 7), queries;
+    for (int q = -3; q < 50; ++q)
+        queries.push_back(q);
+    sjtu::learned_index<int> none(empty.data(), empty.data());
+    return none.lower_bound(5) == empty.data() && none.upper_bound(5) == empty.data() && none.spline_points() == 0
+           && check(one, 0, queries) && check(same, 0, queries) && check(same, 3, queries);
+}
+
+int main(){
+    srand(20220207);
+    bool (*testList[])() = {
+            testUniform, testSkewed, testDuplicates, testUnsignedAndNegative, testTiny
+    };
+    const char* Messages[] = {
+            "Test 1: Testing uniform keys...",
+            "Test 2: Testing skewed keys...",
+            "Test 3: Testing runs of equal keys...",
+            "Test 4: Testing unsigned, negative and narrow keys...",
+            "Test 5: Testing empty and tiny arrays..."
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
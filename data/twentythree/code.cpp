@@ -0,0 +1,225 @@
+// concurrent_skiplist: against std::map, then from many threads at once
+
+#include "concurrent_skiplist.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+const int N = 1e5;
+
+std::atomic<int> alive(0);
+class Counted {
+public:
+    int value;
+    Counted(int v) : value(v) { alive++; }
+    Counted(const Counted &other) : value(other.value) { alive++; }
+    ~Counted() { alive--; }
+};
+
+template<class F>
+void runThreads(int threads, F body) {
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t)
+        pool.emplace_back(body, t);
+    for (size_t t = 0; t < pool.size(); ++t)
+        pool[t].join();
+}
+
+template<class K, class V>
+bool equal(const std::map<K, V> &x, const sjtu::concurrent_skiplist<K, V> &y) {
+    if (x.size() != y.size())
+        return false;
+    typename std::map<K, V>::const_iterator itx = x.begin();
+    for (typename sjtu::concurrent_skiplist<K, V>::const_iterator it = y.cbegin(); it != y.cend(); ++it, ++itx)
+        if (itx == x.end() || itx->first != it->first || itx->second != it->second)
+            return false;
+    return itx == x.end();
+}
+
+bool testRandomOperations() {
+    std::map<int, int> ans;
+    sjtu::concurrent_skiplist<int, int> myMap;
+    for (int i = 0; i < N; ++i) {
+        int op = rand() % 10, key = rand() % 20000, value = rand();
+        if (op < 4) {
+            if (ans.insert({key, value}).second != myMap.insert(key, value))
+                return false;
+        } else if (op < 7) {
+            if ((ans.erase(key) == 1) != myMap.erase(key))
+                return false;
+        } else if (op < 8) {
+            sjtu::concurrent_skiplist<int, int>::const_iterator it = myMap.find(key);
+            std::map<int, int>::iterator itx = ans.find(key);
+            if ((itx == ans.end()) != (it == myMap.end()) || (itx != ans.end() && it->second != itx->second))
+                return false;
+            if (myMap.count(key) != ans.count(key))
+                return false;
+        } else if (op < 9) {
+            std::map<int, int>::iterator lx = ans.lower_bound(key), ux = ans.upper_bound(key);
+            sjtu::concurrent_skiplist<int, int>::const_iterator l = myMap.lower_bound(key), u = myMap.upper_bound(key);
+            if ((lx == ans.end()) != (l == myMap.end()) || (lx != ans.end() && lx->first != l->first))
+                return false;
+            if ((ux == ans.end()) != (u == myMap.end()) || (ux != ans.end() && ux->first != u->first))
+                return false;
+        } else {
+            long long sum = 0, expect = 0;
+            myMap.scan(key, key + 500, [&sum](const sjtu::pair<const int, int> &item) { sum += item.first; });
+            for (std::map<int, int>::iterator it = ans.lower_bound(key); it != ans.end() && it->first < key + 500; ++it)
+                expect += it->first;
+            if (sum != expect)
+                return false;
+        }
+        if (i % 20000 == 0 && !equal(ans, myMap))
+            return false;
+    }
+    int caught = 0;
+    try { myMap.at(-1); } catch (sjtu::index_out_of_bound &) { caught++; }
+    try { ++myMap.end(); } catch (sjtu::invalid_iterator &) { caught++; }
+    try { *myMap.end(); } catch (sjtu::invalid_iterator &) { caught++; }
+    return caught == 3 && equal(ans, myMap);
+}
+
+bool testDisjointThreads() {
+    // each thread owns the keys equal to it modulo the thread count
+    const int threads = 8, perThread = 4000;
+    sjtu::concurrent_skiplist<int, int> myMap;
+    runThreads(threads, [&myMap](int t) {
+        for (int i = 0; i < perThread; ++i)
+            myMap.insert(i * threads + t, t);
+        for (int i = 0; i < perThread; i += 2)
+            myMap.erase(i * threads + t);
+    });
+    std::map<int, int> ans;
+    for (int t = 0; t < threads; ++t)
+        for (int i = 1; i < perThread; i += 2)
+            ans[i * threads + t] = t;
+    return equal(ans, myMap);
+}
+
+bool testContendedKeys() {
+    // every thread inserts and erases the same few keys; the successful
+    // inserts minus erases of a key must leave it present exactly 0 or 1 times
+    const int threads = 8, keys = 16, ops = 20000;
+    sjtu::concurrent_skiplist<int, int> myMap;
+    std::atomic<int> net[keys];
+    for (int k = 0; k < keys; ++k)
+        net[k] = 0;
+    std::atomic<bool> ordered(true);
+    runThreads(threads, [&](int t) {
+        unsigned int seed = 1234 + t;
+        for (int i = 0; i < ops; ++i) {
+            seed = seed * 1103515245 + 12345;
+            int key = (seed >> 16) % keys, op = (seed >> 8) % 3;
+            if (op == 0) {
+                net[key] += myMap.insert(key, t);
+            } else if (op == 1) {
+                net[key] -= myMap.erase(key);
+            } else {
+                int last = -1;
+                myMap.scan(0, keys, [&](const sjtu::pair<const int, int> &item) {
+                    if (item.first <= last)
+                        ordered = false;
+                    last = item.first;
+                });
+            }
+        }
+    });
+    size_t present = 0;
+    for (int k = 0; k < keys; ++k) {
+        if (net[k] != int(myMap.count(k)))
+            return false;
+        present += myMap.count(k);
+    }
+    size_t walked = 0;
+    for (sjtu::concurrent_skiplist<int, int>::const_iterator it = myMap.begin(); it != myMap.end(); ++it)
+        walked++;
+    return ordered && present == myMap.size() && walked == present;
+}
+
+bool testReadersDuringWrites() {
+    // readers always find the keys nobody touches, and iterate in key order
+    const int writers = 4, readers = 4, stable = 2000;
+    sjtu::concurrent_skiplist<int, std::string> myMap;
+    for (int k = 0; k < stable; ++k)
+        myMap.insert(2 * k, std::to_string(2 * k));
+    std::atomic<int> writersLeft(writers);
+    std::atomic<bool> okay(true);
+    runThreads(writers + readers, [&](int t) {
+        if (t < writers) {
+            for (int round = 0; round < 4; ++round) {
+                for (int k = t; k < stable; k += writers)
+                    myMap.insert(2 * k + 1, "odd");
+                for (int k = t; k < stable; k += writers)
+                    myMap.erase(2 * k + 1);
+            }
+            writersLeft--;
+            return;
+        }
+        do {
+            for (int k = t; k < stable; k += 7) {
+                sjtu::concurrent_skiplist<int, std::string>::const_iterator it = myMap.find(2 * k);
+                if (it == myMap.end() || it->second != std::to_string(2 * k))
+                    okay = false;
+            }
+            int last = -1, evens = 0;
+            for (sjtu::concurrent_skiplist<int, std::string>::const_iterator it = myMap.begin(); it != myMap.end(); ++it) {
+                if (it->first <= last)
+                    okay = false;
+                evens += it->first % 2 == 0;
+                last = it->first;
+            }
+            if (evens != stable)
+                okay = false;
+        } while (writersLeft > 0);
+    });
+    return okay && myMap.size() == size_t(stable);
+}
+
+bool testOwnership() {
+    {
+        sjtu::concurrent_skiplist<int, Counted> myMap;
+        runThreads(4, [&myMap](int t) {
+            for (int i = 0; i < 5000; ++i) {
+                myMap.insert(i % 700, Counted(t));
+                myMap.erase((i * 7) % 700);
+            }
+        });
+        if (alive < int(myMap.size()))
+            return false;
+    }
+    return alive == 0;
+}
+
+int main(){
+    srand(20220207);
+    bool (*testList[])() = {
+            testRandomOperations, testDisjointThreads, testContendedKeys, testReadersDuringWrites, testOwnership
+    };
+    const char* Messages[] = {
+            "Test 1: Testing random operations against std::map...",
+            "Test 2: Testing threads on disjoint keys...",
+            "Test 3: Testing threads on the same keys...",
+            "Test 4: Testing readers while writers run...",
+            "Test 5: Testing that erased elements are freed..."
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
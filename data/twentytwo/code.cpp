@@ -0,0 +1,154 @@
+// append_list: producers append whole segments while a consumer drains
+
+#include "append_list.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+std::atomic<int> copies(0), alive(0);
+class Tagged {
+public:
+    int producer, seq;
+    Tagged(int p, int s) : producer(p), seq(s) { alive++; }
+    Tagged(const Tagged &other) : producer(other.producer), seq(other.seq) { alive++, copies++; }
+    ~Tagged() { alive--; }
+};
+
+bool testSingleThread() {
+    sjtu::append_list<int> shared;
+    if (!shared.empty() || !shared.drain_all().empty())
+        return false;
+    int next = 0;
+    for (int round = 0; round < 50; ++round) {
+        sjtu::list<int> segment;
+        for (int i = rand() % 20; i > 0; --i)
+            segment.push_back(next++);
+        const int *first = segment.empty() ? nullptr : &segment.front();
+        shared.append(segment);
+        if (!segment.empty() || (first != nullptr && shared.empty()))
+            return false;
+    }
+    sjtu::list<int> all;
+    all.push_back(-1);
+    shared.drain_into(all);
+    if (!shared.empty() || all.size() != size_t(next + 1) || all.front() != -1 || all.back() != next - 1)
+        return false;
+    int expect = -1;
+    for (sjtu::list<int>::iterator it = all.begin(); it != all.end(); ++it, ++expect)
+        if (*it != expect)
+            return false;
+    // the prev links are stitched too
+    for (sjtu::list<int>::iterator it = all.end(); it != all.begin();)
+        if (*--it != --expect)
+            return false;
+    return expect == -1;
+}
+
+bool testDeferredSegment() {
+    // dead nodes of a deferred-erase segment are not carried over
+    sjtu::append_list<int> shared;
+    sjtu::list<int> segment;
+    segment.set_deferred_erase(true, 1.0);
+    for (int i = 0; i < 10; ++i)
+        segment.push_back(i);
+    for (sjtu::list<int>::iterator it = segment.begin(); it != segment.end();)
+        it = *it % 3 ? segment.erase(it) : ++it;
+    shared.append(segment);
+    sjtu::list<int> all = shared.drain_all();
+    int expect[] = {0, 3, 6, 9}, at = 0;
+    for (sjtu::list<int>::iterator it = all.begin(); it != all.end(); ++it, ++at)
+        if (*it != expect[at])
+            return false;
+    segment.push_back(42);
+    return at == 4 && all.size() == 4 && segment.size() == 1 && segment.front() == 42;
+}
+
+bool testConcurrent() {
+    const int producers = 4, segments = 500;
+    sjtu::append_list<Tagged> shared;
+    std::atomic<int> finished(0);
+    // each element is copied once, by push_back into its segment, and never after
+    int copiesBefore = copies;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&shared, &finished, p]() {
+            int seq = 0;
+            for (int k = 0; k < segments; ++k) {
+                sjtu::list<Tagged> segment;
+                for (int i = k % 7 + 1; i > 0; --i)
+                    segment.push_back(Tagged(p, seq++));
+                shared.append(segment);
+            }
+            finished++;
+        });
+    }
+    // drain while the producers run; every producer's elements must come out in order
+    std::vector<int> seen(producers, 0);
+    bool okay = true;
+    size_t total = 0;
+    while (true) {
+        bool last = finished == producers;
+        sjtu::list<Tagged> got = shared.drain_all();
+        total += got.size();
+        for (sjtu::list<Tagged>::iterator it = got.begin(); it != got.end(); ++it)
+            okay = okay && it->seq == seen[it->producer]++;
+        if (last)
+            break;
+        std::this_thread::yield();
+    }
+    for (size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+    size_t expected = 0;
+    for (int k = 0; k < segments; ++k)
+        expected += k % 7 + 1;
+    return okay && shared.empty() && total == producers * expected && copies == copiesBefore + int(total);
+}
+
+bool testOwnership() {
+    {
+        sjtu::append_list<Tagged> shared;
+        for (int k = 0; k < 10; ++k) {
+            sjtu::list<Tagged> segment;
+            segment.push_back(Tagged(0, k)), segment.push_back(Tagged(1, k));
+            shared.append(segment);
+        }
+        sjtu::list<Tagged> half = shared.drain_all();
+        sjtu::list<Tagged> segment;
+        segment.push_back(Tagged(2, 0));
+        shared.append(segment);
+        if (half.size() != 20 || alive != 21)
+            return false;
+    }
+    return alive == 0;
+}
+
+int main(){
+    srand(20220207);
+    bool (*testList[])() = {
+            testSingleThread, testDeferredSegment, testConcurrent, testOwnership
+    };
+    const char* Messages[] = {
+            "Test 1: Testing append() and drain_into() in one thread...",
+            "Test 2: Testing segments with erased elements...",
+            "Test 3: Testing producers appending while a consumer drains...",
+            "Test 4: Testing that undrained elements are freed..."
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
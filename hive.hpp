@@ -0,0 +1,494 @@
+#ifndef SJTU_HIVE_HPP
+#define SJTU_HIVE_HPP
+
+#include "exceptions.hpp"
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace sjtu {
+
+/**
+ * an unordered container like plf::colony / std::hive
+ * elements live in blocks of growing capacity and never move, so iterators
+ * stay valid across insert and erase of other elements.
+ * erased slots are marked in a skip field, so iteration jumps over a run of
+ * erased slots in one step, and they are reused by later inserts.
+ */
+template<typename T>
+class hive {
+public:
+    class const_iterator;
+    class iterator;
+
+protected:
+    typedef unsigned short index_type;
+    static const index_type no_slot = 0xFFFF;
+    /**
+     * the first block holds min_block elements, every new block as many as
+     * the hive already holds, up to max_block (skip values must fit index_type)
+     */
+    static const size_t min_block = 8;
+    static const size_t max_block = 8192;
+
+    /**
+     * free links of an erased run, kept in the first slot of the run
+     */
+    struct free_links {
+        index_type prev;
+        index_type next;
+    };
+    struct slot {
+        alignas(T) alignas(free_links) unsigned char bytes[sizeof(T) > sizeof(free_links) ? sizeof(T) : sizeof(free_links)];
+
+        T *value() {
+            return reinterpret_cast<T *>(bytes);
+        }
+        free_links *links() {
+            return reinterpret_cast<free_links *>(bytes);
+        }
+    };
+    /**
+     * skip[i] is 0 for a live slot; for a run of erased slots the first and the
+     * last slot of the run hold its length. skip[high] is always 0.
+     * slots at or above high have never been used.
+     */
+    class block {
+    public:
+        slot *slots;
+        index_type *skip;
+        size_t capacity;
+        size_t high;
+        size_t count;
+        index_type free_head;
+        block *prev, *next;
+        block *prev_free, *next_free;
+
+        block(size_t capa) : slots(new slot[capa]), skip(new index_type[capa + 1]()), capacity(capa),
+                             high(0), count(0), free_head(no_slot), prev(nullptr), next(nullptr),
+                             prev_free(nullptr), next_free(nullptr) {}
+        ~block() {
+            delete [] slots;
+            delete [] skip;
+        }
+        /**
+         * first live slot at or after i (high if none)
+         */
+        size_t skip_forward(size_t i) const {
+            return i + skip[i];
+        }
+        void push_run(index_type start) {
+            slots[start].links()->prev = no_slot;
+            slots[start].links()->next = free_head;
+            if (free_head != no_slot) slots[free_head].links()->prev = start;
+            free_head = start;
+        }
+        void remove_run(index_type start) {
+            free_links *l = slots[start].links();
+            if (l->prev != no_slot) slots[l->prev].links()->next = l->next;
+            else free_head = l->next;
+            if (l->next != no_slot) slots[l->next].links()->prev = l->prev;
+        }
+    };
+
+    block *first;
+    block *last;
+    block *free_blocks;
+    size_t element_count;
+    size_t total_capacity;
+
+    void link_free(block *b) {
+        b->prev_free = nullptr;
+        b->next_free = free_blocks;
+        if (free_blocks != nullptr) free_blocks->prev_free = b;
+        free_blocks = b;
+    }
+    void unlink_free(block *b) {
+        if (b->prev_free != nullptr) b->prev_free->next_free = b->next_free;
+        else free_blocks = b->next_free;
+        if (b->next_free != nullptr) b->next_free->prev_free = b->prev_free;
+        b->prev_free = b->next_free = nullptr;
+    }
+    /**
+     * a slot to construct the next element in: an erased one if any,
+     * otherwise the next unused slot of the last block, otherwise a new block
+     */
+    std::pair<block *, size_t> acquire_slot() {
+        if (free_blocks != nullptr) {
+            block *b = free_blocks;
+            size_t start = b->free_head;
+            size_t run = b->skip[start];
+            b->remove_run(start);
+            b->skip[start] = 0;
+            if (run > 1) {
+                b->skip[start + 1] = b->skip[start + run - 1] = run - 1;
+                b->push_run(start + 1);
+            }
+            if (b->free_head == no_slot) unlink_free(b);
+            return std::pair<block *, size_t>(b, start);
+        }
+        if (last == nullptr || last->high == last->capacity) {
+            size_t capa = element_count < min_block ? min_block : element_count;
+            if (capa > max_block) capa = max_block;
+            block *b = new block(capa);
+            b->prev = last;
+            if (last != nullptr) last->next = b;
+            else first = b;
+            last = b;
+            total_capacity += capa;
+        }
+        return std::pair<block *, size_t>(last, last->high++);
+    }
+    /**
+     * marks slot i of b erased, merging it with the erased runs around it
+     */
+    void release_slot(block *b, size_t i) {
+        bool had_free = b->free_head != no_slot;
+        size_t left = i > 0 ? b->skip[i - 1] : 0;
+        size_t right = b->skip[i + 1];
+        if (left == 0 && right == 0) {
+            b->skip[i] = 1;
+            b->push_run(i);
+        } else if (right == 0) {
+            b->skip[i - left] = b->skip[i] = left + 1;
+        } else if (left == 0) {
+            b->remove_run(i + 1);
+            b->skip[i] = b->skip[i + right] = right + 1;
+            b->push_run(i);
+        } else {
+            b->remove_run(i + 1);
+            b->skip[i - left] = b->skip[i + right] = left + right + 1;
+        }
+        if (!had_free) link_free(b);
+    }
+    /**
+     * gives back a slot of acquire_slot() whose element could not be constructed:
+     * an erased slot is erased again, a never used one unused again
+     */
+    void abandon_slot(block *b, size_t i, bool reused) {
+        if (reused) {
+            release_slot(b, i);
+        } else if (b->count == 0) {
+            drop_block(b);
+        } else {
+            --b->high;
+        }
+    }
+    /**
+     * the element is built in its slot before the slot counts as live, so a
+     * throwing constructor leaves the hive as it was
+     */
+    template<class V>
+    iterator construct(V &&value) {
+        bool reused = free_blocks != nullptr;
+        std::pair<block *, size_t> pos = acquire_slot();
+        try {
+            new (pos.first->slots[pos.second].value()) T(std::forward<V>(value));
+        } catch (...) {
+            abandon_slot(pos.first, pos.second, reused);
+            throw;
+        }
+        ++pos.first->count;
+        ++element_count;
+        return iterator(pos.first, pos.second, this);
+    }
+    void drop_block(block *b) {
+        if (b->free_head != no_slot) unlink_free(b);
+        if (b->prev != nullptr) b->prev->next = b->next;
+        else first = b->next;
+        if (b->next != nullptr) b->next->prev = b->prev;
+        else last = b->prev;
+        total_capacity -= b->capacity;
+        delete b;
+    }
+    /**
+     * position of the element after slot i of b, or (nullptr, 0) for the end
+     */
+    static std::pair<block *, size_t> next_of(block *b, size_t i) {
+        i = b->skip_forward(i + 1);
+        if (i < b->high) return std::pair<block *, size_t>(b, i);
+        b = b->next;
+        if (b == nullptr) return std::pair<block *, size_t>(nullptr, 0);
+        return std::pair<block *, size_t>(b, b->skip_forward(0));
+    }
+    /**
+     * position of the element before slot i of b (b == nullptr for the end),
+     * or (nullptr, 0) when there is none
+     */
+    std::pair<block *, size_t> prev_of(block *b, size_t i) const {
+        if (b == nullptr) {
+            b = last;
+            if (b == nullptr) return std::pair<block *, size_t>(nullptr, 0);
+            i = b->high;
+        }
+        while (true) {
+            if (i > 0) {
+                size_t j = i - 1;
+                if (b->skip[j] <= j) return std::pair<block *, size_t>(b, j - b->skip[j]);
+            }
+            b = b->prev;
+            if (b == nullptr) return std::pair<block *, size_t>(nullptr, 0);
+            i = b->high;
+        }
+    }
+
+public:
+    class iterator {
+    private:
+        block *blk;
+        size_t index;
+        const hive *container;
+
+    public:
+        friend class hive<T>;
+        friend class const_iterator;
+        iterator() : blk(nullptr), index(0), container(nullptr) {}
+        iterator(block *b, size_t i, const hive *c) : blk(b), index(i), container(c) {}
+
+        /**
+         * iter++
+         */
+        iterator operator++(int) {
+            iterator temp = *this;
+            ++*this;
+            return temp;
+        }
+        /**
+         * ++iter
+         */
+        iterator & operator++() {
+            if (container == nullptr || blk == nullptr) {
+                throw invalid_iterator();
+            }
+            std::pair<block *, size_t> pos = next_of(blk, index);
+            blk = pos.first, index = pos.second;
+            return *this;
+        }
+        /**
+         * iter--
+         */
+        iterator operator--(int) {
+            iterator temp = *this;
+            --*this;
+            return temp;
+        }
+        /**
+         * --iter
+         */
+        iterator & operator--() {
+            if (container == nullptr) {
+                throw invalid_iterator();
+            }
+            std::pair<block *, size_t> pos = container->prev_of(blk, index);
+            if (pos.first == nullptr) {
+                throw invalid_iterator();
+            }
+            blk = pos.first, index = pos.second;
+            return *this;
+        }
+        T & operator *() const {
+            if (blk == nullptr) {
+                throw invalid_iterator();
+            }
+            return *blk->slots[index].value();
+        }
+        T * operator ->() const {
+            if (blk == nullptr) {
+                throw invalid_iterator();
+            }
+            return blk->slots[index].value();
+        }
+        bool operator==(const iterator &rhs) const {
+            return blk == rhs.blk && index == rhs.index;
+        }
+        bool operator==(const const_iterator &rhs) const {
+            return blk == rhs.blk && index == rhs.index;
+        }
+        bool operator!=(const iterator &rhs) const {
+            return !(*this == rhs);
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return !(*this == rhs);
+        }
+    };
+    class const_iterator {
+    private:
+        block *blk;
+        size_t index;
+        const hive *container;
+
+    public:
+        friend class hive<T>;
+        friend class iterator;
+        const_iterator() : blk(nullptr), index(0), container(nullptr) {}
+        const_iterator(block *b, size_t i, const hive *c) : blk(b), index(i), container(c) {}
+        const_iterator(const iterator &it) : blk(it.blk), index(it.index), container(it.container) {}
+
+        /**
+         * iter++
+         */
+        const_iterator operator++(int) {
+            const_iterator temp = *this;
+            ++*this;
+            return temp;
+        }
+        /**
+         * ++iter
+         */
+        const_iterator & operator++() {
+            if (container == nullptr || blk == nullptr) {
+                throw invalid_iterator();
+            }
+            std::pair<block *, size_t> pos = next_of(blk, index);
+            blk = pos.first, index = pos.second;
+            return *this;
+        }
+        /**
+         * iter--
+         */
+        const_iterator operator--(int) {
+            const_iterator temp = *this;
+            --*this;
+            return temp;
+        }
+        /**
+         * --iter
+         */
+        const_iterator & operator--() {
+            if (container == nullptr) {
+                throw invalid_iterator();
+            }
+            std::pair<block *, size_t> pos = container->prev_of(blk, index);
+            if (pos.first == nullptr) {
+                throw invalid_iterator();
+            }
+            blk = pos.first, index = pos.second;
+            return *this;
+        }
+        const T & operator *() const {
+            if (blk == nullptr) {
+                throw invalid_iterator();
+            }
+            return *blk->slots[index].value();
+        }
+        const T * operator ->() const {
+            if (blk == nullptr) {
+                throw invalid_iterator();
+            }
+            return blk->slots[index].value();
+        }
+        bool operator==(const const_iterator &rhs) const {
+            return blk == rhs.blk && index == rhs.index;
+        }
+        bool operator==(const iterator &rhs) const {
+            return blk == rhs.blk && index == rhs.index;
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return !(*this == rhs);
+        }
+        bool operator!=(const iterator &rhs) const {
+            return !(*this == rhs);
+        }
+    };
+
+    hive() : first(nullptr), last(nullptr), free_blocks(nullptr), element_count(0), total_capacity(0) {}
+    hive(const hive &other) : first(nullptr), last(nullptr), free_blocks(nullptr), element_count(0), total_capacity(0) {
+        try {
+            for (const_iterator it = other.cbegin(); it != other.cend(); ++it) {
+                insert(*it);
+            }
+        } catch (...) {
+            clear();
+            throw;
+        }
+    }
+    ~hive() {
+        clear();
+    }
+    hive &operator=(const hive &other) {
+        if (this == &other) return *this;
+        clear();
+        for (const_iterator it = other.cbegin(); it != other.cend(); ++it) {
+            insert(*it);
+        }
+        return *this;
+    }
+
+    iterator begin() {
+        return first == nullptr ? end() : iterator(first, first->skip_forward(0), this);
+    }
+    const_iterator cbegin() const {
+        return first == nullptr ? cend() : const_iterator(first, first->skip_forward(0), this);
+    }
+    iterator end() {
+        return iterator(nullptr, 0, this);
+    }
+    const_iterator cend() const {
+        return const_iterator(nullptr, 0, this);
+    }
+    bool empty() const {
+        return element_count == 0;
+    }
+    size_t size() const {
+        return element_count;
+    }
+    /**
+     * number of slots allocated, live or erased
+     */
+    size_t capacity() const {
+        return total_capacity;
+    }
+
+    /**
+     * destroys every element and frees every block
+     */
+    void clear() {
+        for (iterator it = begin(); it != end(); ++it) {
+            it->~T();
+        }
+        while (first != nullptr) {
+            block *b = first;
+            first = first->next;
+            delete b;
+        }
+        last = free_blocks = nullptr;
+        element_count = total_capacity = 0;
+    }
+    /**
+     * adds value at an unspecified position, reusing an erased slot if any
+     * return an iterator pointing to the inserted value
+     */
+    iterator insert(const T &value) {
+        return construct(value);
+    }
+    iterator insert(T &&value) {
+        return construct(std::move(value));
+    }
+    /**
+     * remove the element at pos (the end() iterator is invalid)
+     * returns an iterator pointing to the following element or end()
+     * no other iterator is invalidated
+     * throw if the container is empty, the iterator is invalid
+     */
+    iterator erase(iterator pos) {
+        if (empty()) throw container_is_empty();
+        if (pos.container != this || pos.blk == nullptr) throw invalid_iterator();
+
+        block *b = pos.blk;
+        std::pair<block *, size_t> after = next_of(b, pos.index);
+        b->slots[pos.index].value()->~T();
+        --b->count;
+        --element_count;
+        if (b->count == 0) {
+            drop_block(b);
+        } else {
+            release_slot(b, pos.index);
+        }
+        return iterator(after.first, after.second, this);
+    }
+};
+
+}
+
+#endif //SJTU_HIVE_HPP
@@ -0,0 +1,316 @@
+#ifndef SJTU_JOIN_HPP
+#define SJTU_JOIN_HPP
+
+#include "exceptions.hpp"
+#include "list.hpp"
+#include "unordered_map.hpp"
+#include "utility.hpp"
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <thread>
+
+namespace sjtu {
+
+/**
+ * equi-joins of two relations stored as list<pair<K, V>>, matched on first
+ * the joins produce list<pair<V1, V2>> with one element per matching pair of rows;
+ * semi_join and anti_join filter the left relation in place.
+ * keys need operator< for the sort-merge join and Hash / operator== for the others.
+ */
+namespace join_detail {
+
+template<class K, class V>
+struct first_of {
+    const K &operator()(const pair<K, V> &row) const {
+        return row.first;
+    }
+};
+
+template<class K, class V>
+bool sorted_by_key(const list<pair<K, V>> &rows) {
+    typename list<pair<K, V>>::const_iterator it = rows.cbegin(), prev = it;
+    if (it == rows.cend()) return true;
+    for (++it; it != rows.cend(); ++it, ++prev) {
+        if ((*it).first < (*prev).first) return false;
+    }
+    return true;
+}
+
+/**
+ * the rows of a relation as an array of pointers
+ */
+template<class K, class V>
+const pair<K, V> **rows_of(const list<pair<K, V>> &rows) {
+    const pair<K, V> **out = new const pair<K, V>*[rows.size() + 1];
+    size_t i = 0;
+    for (typename list<pair<K, V>>::const_iterator it = rows.cbegin(); it != rows.cend(); ++it) {
+        out[i++] = &*it;
+    }
+    return out;
+}
+
+/**
+ * hash join of two arrays of rows: a table is built on build and probed by probe
+ * emit(build row, probe row) is called in the order of probe, and for one probe row
+ * in the order of build
+ */
+template<class K, class VB, class VP, class Hash, class Emit>
+void hash_join_rows(const pair<K, VB> **build, size_t nb, const pair<K, VP> **probe, size_t np, Emit emit) {
+    if (nb == 0 || np == 0) return;
+    static const size_t none = size_t(-1);
+    size_t *next = new size_t[nb];
+    try {
+        // chains of equal keys, threaded through next in the order of build
+        unordered_map<K, size_t, Hash> heads;
+        heads.reserve(nb);
+        for (size_t i = nb; i-- > 0;) {
+            pair<typename unordered_map<K, size_t, Hash>::iterator, bool> slot =
+                heads.insert(typename unordered_map<K, size_t, Hash>::value_type(build[i]->first, i));
+            next[i] = slot.second ? none : slot.first->second;
+            slot.first->second = i;
+        }
+        for (size_t j = 0; j < np; ++j) {
+            typename unordered_map<K, size_t, Hash>::iterator found = heads.find(probe[j]->first);
+            if (found == heads.end()) continue;
+            for (size_t i = found->second; i != none; i = next[i]) {
+                emit(*build[i], *probe[j]);
+            }
+        }
+    } catch (...) {
+        delete [] next;
+        throw;
+    }
+    delete [] next;
+}
+
+/**
+ * hash join of left and right rows into out, built on the smaller side
+ */
+template<class K, class V1, class V2, class Hash>
+void hash_join_into(const pair<K, V1> **left, size_t nl, const pair<K, V2> **right, size_t nr, list<pair<V1, V2>> &out) {
+    if (nr <= nl) {
+        hash_join_rows<K, V2, V1, Hash>(right, nr, left, nl, [&out](const pair<K, V2> &r, const pair<K, V1> &l) {
+            out.push_back(pair<V1, V2>(l.second, r.second));
+        });
+    } else {
+        hash_join_rows<K, V1, V2, Hash>(left, nl, right, nr, [&out](const pair<K, V1> &l, const pair<K, V2> &r) {
+            out.push_back(pair<V1, V2>(l.second, r.second));
+        });
+    }
+}
+
+/**
+ * the keys of rows, for semi_join and anti_join
+ */
+template<class K, class V, class Hash>
+void collect_keys(const list<pair<K, V>> &rows, unordered_map<K, bool, Hash> &keys) {
+    keys.reserve(rows.size());
+    for (typename list<pair<K, V>>::const_iterator it = rows.cbegin(); it != rows.cend(); ++it) {
+        keys.insert(typename unordered_map<K, bool, Hash>::value_type((*it).first, true));
+    }
+}
+
+template<class K, class V, class Hash>
+void keep_if_matched(list<pair<K, V>> &left, const unordered_map<K, bool, Hash> &keys, bool matched) {
+    for (typename list<pair<K, V>>::iterator it = left.begin(); it != left.end();) {
+        if ((keys.count(it->first) != 0) != matched) {
+            it = left.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+}
+
+/**
+ * sort-merge join: both relations are sorted by key with list::sort(key), unless a
+ * linear check finds them sorted already, and then joined in one merge-style pass
+ * the inputs are left sorted by key (equal keys keep their order); the result is in
+ * ascending key order, and for one key in the order of left, then of right
+ */
+template<class K, class V1, class V2>
+list<pair<V1, V2>> sort_merge_join(list<pair<K, V1>> &left, list<pair<K, V2>> &right) {
+    if (!join_detail::sorted_by_key(left)) {
+        left.sort(join_detail::first_of<K, V1>());
+    }
+    if (!join_detail::sorted_by_key(right)) {
+        right.sort(join_detail::first_of<K, V2>());
+    }
+    list<pair<V1, V2>> out;
+    typename list<pair<K, V1>>::const_iterator l = left.cbegin();
+    typename list<pair<K, V2>>::const_iterator r = right.cbegin();
+    while (l != left.cend() && r != right.cend()) {
+        if ((*l).first < (*r).first) {
+            ++l;
+        } else if ((*r).first < (*l).first) {
+            ++r;
+        } else {
+            // the run of the key in right is joined with every left row of the key
+            typename list<pair<K, V2>>::const_iterator run_end = r;
+            while (run_end != right.cend() && !((*r).first < (*run_end).first)) {
+                ++run_end;
+            }
+            const K &key = (*r).first;
+            for (; l != left.cend() && !(key < (*l).first); ++l) {
+                for (typename list<pair<K, V2>>::const_iterator k = r; k != run_end; ++k) {
+                    out.push_back(pair<V1, V2>((*l).second, (*k).second));
+                }
+            }
+            r = run_end;
+        }
+    }
+    return out;
+}
+
+/**
+ * hash join: a table is built on the smaller relation and probed with the other
+ * the result follows the order of the probed relation
+ */
+template<class K, class V1, class V2, class Hash = std::hash<K>>
+list<pair<V1, V2>> hash_join(const list<pair<K, V1>> &left, const list<pair<K, V2>> &right) {
+    list<pair<V1, V2>> out;
+    const pair<K, V1> **l = join_detail::rows_of(left);
+    const pair<K, V2> **r = nullptr;
+    try {
+        r = join_detail::rows_of(right);
+        join_detail::hash_join_into<K, V1, V2, Hash>(l, left.size(), r, right.size(), out);
+    } catch (...) {
+        delete [] l;
+        delete [] r;
+        throw;
+    }
+    delete [] l;
+    delete [] r;
+    return out;
+}
+
+/**
+ * partitioned hash join: the rows of both relations are split by hash into one
+ * partition per thread, each thread joins a partition into a list of its own, and
+ * the lists are spliced together in partition order
+ * an exception thrown by a thread is rethrown after all of them have finished
+ */
+template<class K, class V1, class V2, class Hash = std::hash<K>>
+list<pair<V1, V2>> hash_join(const list<pair<K, V1>> &left, const list<pair<K, V2>> &right, parallel_policy policy) {
+    static const size_t grain = 1024;
+    size_t nl = left.size(), nr = right.size();
+    size_t parts = policy.threads != 0 ? policy.threads : std::thread::hardware_concurrency();
+    if (parts > (nl + nr) / grain) {
+        parts = (nl + nr) / grain;
+    }
+    if (parts <= 1) {
+        return hash_join<K, V1, V2, Hash>(left, right);
+    }
+
+    Hash hasher;
+    auto part_of = [&hasher, parts](const K &key) {
+        unsigned long long h = (unsigned long long)hasher(key) * 0xFF51AFD7ED558CCDULL;
+        return size_t((h >> 32) % parts);
+    };
+    const pair<K, V1> **l = join_detail::rows_of(left);
+    const pair<K, V2> **r = nullptr, **lp = nullptr, **rp = nullptr;
+    size_t *lbegin = nullptr, *rbegin = nullptr, *lpart = nullptr, *rpart = nullptr;
+    list<pair<V1, V2>> *results = nullptr;
+    std::exception_ptr *errors = nullptr;
+    list<pair<V1, V2>> out;
+    try {
+        r = join_detail::rows_of(right);
+        // counting sort of the rows by partition
+        lpart = new size_t[nl + 1];
+        rpart = new size_t[nr + 1];
+        lbegin = new size_t[parts + 1]();
+        rbegin = new size_t[parts + 1]();
+        for (size_t i = 0; i < nl; ++i) {
+            lpart[i] = part_of(l[i]->first);
+            lbegin[lpart[i] + 1]++;
+        }
+        for (size_t i = 0; i < nr; ++i) {
+            rpart[i] = part_of(r[i]->first);
+            rbegin[rpart[i] + 1]++;
+        }
+        for (size_t p = 0; p < parts; ++p) {
+            lbegin[p + 1] += lbegin[p];
+            rbegin[p + 1] += rbegin[p];
+        }
+        lp = new const pair<K, V1>*[nl + 1];
+        rp = new const pair<K, V2>*[nr + 1];
+        {
+            size_t *at = new size_t[parts];
+            for (size_t p = 0; p < parts; ++p) at[p] = lbegin[p];
+            for (size_t i = 0; i < nl; ++i) lp[at[lpart[i]]++] = l[i];
+            for (size_t p = 0; p < parts; ++p) at[p] = rbegin[p];
+            for (size_t i = 0; i < nr; ++i) rp[at[rpart[i]]++] = r[i];
+            delete [] at;
+        }
+
+        results = new list<pair<V1, V2>>[parts];
+        errors = new std::exception_ptr[parts];
+        auto work = [&](size_t p) {
+            try {
+                join_detail::hash_join_into<K, V1, V2, Hash>(lp + lbegin[p], lbegin[p + 1] - lbegin[p],
+                                                             rp + rbegin[p], rbegin[p + 1] - rbegin[p], results[p]);
+            } catch (...) {
+                errors[p] = std::current_exception();
+            }
+        };
+        std::thread *pool = new std::thread[parts - 1];
+        for (size_t p = 1; p < parts; ++p) {
+            try {
+                pool[p - 1] = std::thread(work, p);
+            } catch (...) {
+                // no thread to spare: join that partition here
+                work(p);
+            }
+        }
+        work(0);
+        for (size_t p = 1; p < parts; ++p) {
+            if (pool[p - 1].joinable()) {
+                pool[p - 1].join();
+            }
+        }
+        delete [] pool;
+        for (size_t p = 0; p < parts; ++p) {
+            if (errors[p]) std::rethrow_exception(errors[p]);
+        }
+        for (size_t p = 0; p < parts; ++p) {
+            out.splice(out.end(), results[p]);
+        }
+    } catch (...) {
+        delete [] l; delete [] r; delete [] lp; delete [] rp;
+        delete [] lpart; delete [] rpart; delete [] lbegin; delete [] rbegin;
+        delete [] results; delete [] errors;
+        throw;
+    }
+    delete [] l; delete [] r; delete [] lp; delete [] rp;
+    delete [] lpart; delete [] rpart; delete [] lbegin; delete [] rbegin;
+    delete [] results; delete [] errors;
+    return out;
+}
+
+/**
+ * semi-join: keep the rows of left whose key occurs in right, drop the others
+ * nothing is copied; the kept nodes stay in place and in order
+ */
+template<class K, class V1, class V2, class Hash = std::hash<K>>
+void semi_join(list<pair<K, V1>> &left, const list<pair<K, V2>> &right) {
+    unordered_map<K, bool, Hash> keys;
+    join_detail::collect_keys(right, keys);
+    join_detail::keep_if_matched(left, keys, true);
+}
+
+/**
+ * anti-join: drop the rows of left whose key occurs in right
+ */
+template<class K, class V1, class V2, class Hash = std::hash<K>>
+void anti_join(list<pair<K, V1>> &left, const list<pair<K, V2>> &right) {
+    unordered_map<K, bool, Hash> keys;
+    join_detail::collect_keys(right, keys);
+    join_detail::keep_if_matched(left, keys, false);
+}
+
+}
+
+#endif //SJTU_JOIN_HPP
@@ -0,0 +1,224 @@
+#ifndef SJTU_LEARNED_INDEX_HPP
+#define SJTU_LEARNED_INDEX_HPP
+
+#include <cstddef>
+#include <type_traits>
+
+namespace sjtu {
+
+/**
+ * a learned index over a sorted array of integer keys, in the manner of RadixSpline
+ * built once, it fits a piecewise-linear spline through (key, position) of the
+ * distinct keys so that every key is predicted within max_error positions of its
+ * first occurrence, and a radix table on the high bits of the key narrows down
+ * the spline segment of a query.
+ * a lookup predicts a position and searches max_error positions around it; where
+ * the answer lies outside that window (a key absent between two long runs of
+ * equal keys, an upper_bound past a run) the window is widened by galloping, so
+ * the results are always exactly those of sjtu::lower_bound / upper_bound.
+ * the index keeps a pointer to the array, which must stay alive and unchanged.
+ */
+template<class T>
+class learned_index {
+    static_assert(std::is_integral<T>::value, "learned_index needs integer keys");
+
+protected:
+    const T *data;
+    size_t n;
+    size_t max_err;
+    /**
+     * the spline points: spline_keys are distinct keys of the array, spline_pos
+     * the positions of their first occurrences
+     */
+    T *spline_keys;
+    size_t *spline_pos;
+    size_t spline_count;
+    /**
+     * radix[b] is the first spline point whose key has the prefix b or above,
+     * where the prefix of a key is (key - data[0]) >> shift
+     */
+    size_t *radix;
+    size_t radix_size;
+    size_t shift;
+
+    static unsigned long long offset(const T &key, const T &low) {
+        return (unsigned long long)key - (unsigned long long)low;
+    }
+    /**
+     * the greedy spline corridor: from the last spline point, keep the slopes that
+     * pass within max_error of every key seen since, and start a new segment at
+     * the previous key once a key leaves that cone
+     */
+    void fit_spline() {
+        T *keys = new T[n];
+        size_t *pos = nullptr;
+        size_t m = 0;
+        try {
+            pos = new size_t[n];
+            for (size_t i = 0; i < n; ++i) {
+                if (i == 0 || data[i - 1] < data[i]) {
+                    keys[m] = data[i];
+                    pos[m++] = i;
+                }
+            }
+            spline_keys = new T[m];
+            spline_pos = new size_t[m];
+        } catch (...) {
+            delete [] keys;
+            delete [] pos;
+            throw;
+        }
+        spline_count = 0;
+        spline_keys[spline_count] = keys[0];
+        spline_pos[spline_count++] = pos[0];
+        size_t base = 0;
+        double upper = 0, lower = 0, err = double(max_err);
+        for (size_t j = 1; j < m; ++j) {
+            double dx = double(offset(keys[j], keys[base]));
+            double dy = double(pos[j]) - double(pos[base]);
+            if (j > base + 1 && (dy > upper * dx || dy < lower * dx)) {
+                base = j - 1;
+                spline_keys[spline_count] = keys[base];
+                spline_pos[spline_count++] = pos[base];
+                dx = double(offset(keys[j], keys[base]));
+                dy = double(pos[j]) - double(pos[base]);
+                upper = (dy + err) / dx;
+                lower = (dy - err) / dx;
+            } else if (j == base + 1) {
+                upper = (dy + err) / dx;
+                lower = (dy - err) / dx;
+            } else {
+                if ((dy + err) / dx < upper) upper = (dy + err) / dx;
+                if ((dy - err) / dx > lower) lower = (dy - err) / dx;
+            }
+        }
+        if (m > 1) {
+            spline_keys[spline_count] = keys[m - 1];
+            spline_pos[spline_count++] = pos[m - 1];
+        }
+        delete [] keys;
+        delete [] pos;
+    }
+    void build_radix(size_t radix_bits) {
+        unsigned long long range = offset(data[n - 1], data[0]);
+        size_t bits = 0;
+        while (bits < 64 && (range >> bits) != 0) {
+            bits++;
+        }
+        shift = bits > radix_bits ? bits - radix_bits : 0;
+        radix_size = size_t(range >> shift) + 2;
+        radix = new size_t[radix_size];
+        size_t b = 0;
+        for (size_t i = 0; i < spline_count; ++i) {
+            size_t prefix = size_t(offset(spline_keys[i], data[0]) >> shift);
+            while (b <= prefix) {
+                radix[b++] = i;
+            }
+        }
+        while (b < radix_size) {
+            radix[b++] = spline_count;
+        }
+    }
+    /**
+     * where the spline puts key, for data[0] <= key <= data[n - 1]
+     */
+    size_t predict(const T &key) const {
+        unsigned long long u = offset(key, data[0]);
+        size_t prefix = size_t(u >> shift);
+        // the last spline point not above key is in [radix[prefix] - 1, radix[prefix + 1])
+        size_t l = radix[prefix] > 0 ? radix[prefix] - 1 : 0, r = radix[prefix + 1];
+        if (r > spline_count - 1) r = spline_count - 1;
+        while (l < r) {
+            size_t mid = (l + r + 1) / 2;
+            if (key < spline_keys[mid]) r = mid - 1; else l = mid;
+        }
+        if (l + 1 >= spline_count) return spline_pos[l];
+        double dx = double(offset(spline_keys[l + 1], spline_keys[l]));
+        double dy = double(spline_pos[l + 1]) - double(spline_pos[l]);
+        return spline_pos[l] + size_t(double(offset(key, spline_keys[l])) * dy / dx + 0.5);
+    }
+    /**
+     * the first position whose key does not go before key, searched around guess
+     */
+    size_t search(const T &key, size_t guess, bool upper) const {
+        auto before = [&key, upper](const T &x) { return upper ? !(key < x) : x < key; };
+        size_t lo = guess > max_err ? guess - max_err : 0;
+        size_t hi = n - guess > max_err + 1 ? guess + max_err + 1 : n;
+        size_t step = max_err + 1;
+        // widen until data[lo - 1] goes before the answer and data[hi] does not
+        while (lo > 0 && !before(data[lo - 1])) {
+            hi = lo - 1;
+            lo = lo > step ? lo - step : 0;
+            step *= 2;
+        }
+        while (hi < n && before(data[hi])) {
+            lo = hi + 1;
+            hi = n - hi > step ? hi + step : n;
+            step *= 2;
+        }
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (before(data[mid])) lo = mid + 1; else hi = mid;
+        }
+        return lo;
+    }
+    size_t bound(const T &key, bool upper) const {
+        if (n == 0 || key < data[0]) return 0;
+        if (upper ? !(key < data[n - 1]) : data[n - 1] < key) return n;
+        size_t guess = predict(key);
+        return search(key, guess < n ? guess : n - 1, upper);
+    }
+
+public:
+    /**
+     * index the sorted array [begin, end)
+     * radix_bits sets the size of the radix table, 2^radix_bits entries at most
+     */
+    learned_index(const T *begin, const T *end, size_t max_error = 32, size_t radix_bits = 18)
+            : data(begin), n(end - begin), max_err(max_error), spline_keys(nullptr), spline_pos(nullptr),
+              spline_count(0), radix(nullptr), radix_size(0), shift(0) {
+        if (n == 0) return;
+        try {
+            fit_spline();
+            build_radix(radix_bits);
+        } catch (...) {
+            delete [] spline_keys;
+            delete [] spline_pos;
+            delete [] radix;
+            throw;
+        }
+    }
+    learned_index(const learned_index &) = delete;
+    learned_index &operator=(const learned_index &) = delete;
+    ~learned_index() {
+        delete [] spline_keys;
+        delete [] spline_pos;
+        delete [] radix;
+    }
+
+    /**
+     * the first element not less than key / greater than key, end if there is none
+     */
+    T *lower_bound(const T &key) const {
+        return const_cast<T *>(data + bound(key, false));
+    }
+    T *upper_bound(const T &key) const {
+        return const_cast<T *>(data + bound(key, true));
+    }
+    size_t size() const {
+        return n;
+    }
+    size_t max_error() const {
+        return max_err;
+    }
+    /**
+     * the number of spline points, one more than the number of segments
+     */
+    size_t spline_points() const {
+        return spline_count;
+    }
+};
+
+}
+
+#endif //SJTU_LEARNED_INDEX_HPP
@@ -4,16 +4,63 @@
 #include "exceptions.hpp"
 #include "algorithm.hpp"
 
+#include <atomic>
 #include <climits>
 #include <cstddef>
+#include <exception>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
 
 namespace sjtu {
+/**
+ * the engines list::sort() may use
+ * array: copy to an array, quicksort, copy back
+ * merge: merge sort relinking the nodes
+ * radix: distribute integer keys by bytes, then relink the nodes
+ * presorted: the list was known to be sorted, nothing was done
+ * suffix: only the part after the known sorted prefix was sorted, then merged in
+ */
+enum class sort_strategy {
+    none, array, merge, radix, presorted, suffix
+};
+/**
+ * what the last sort() of a list did
+ */
+struct sort_stats {
+    sort_strategy strategy = sort_strategy::none;
+    size_t size = 0;
+};
+/**
+ * asks for the parallel version of an operation
+ * threads == 0 uses every hardware thread
+ */
+struct parallel_policy {
+    size_t threads;
+    explicit parallel_policy(size_t n = 0) : threads(n) {}
+};
+
+template<typename T>
+class sorted_list;
+template<typename T>
+class append_list;
+template<typename T>
+class sharded_log;
+
 /**
  * a data container like std::list
  * allocate random memory addresses for data and they are doubly-linked in a list.
  */
 template<typename T>
 class list {
+    /**
+     * takes and gives back whole chains of nodes
+     */
+    friend class sorted_list<T>;
+    friend class append_list<T>;
+    friend class sharded_log<T>;
+
 public:
     class const_iterator;
     class iterator;
@@ -24,9 +71,10 @@ protected:
         T data;
         node *prev;
         node *next;
+        bool dead;  // erased in deferred mode, still linked until compact_erased()
 
-        node() : prev(nullptr), next(nullptr) {}
-        node(const T &value) : data(value), prev(nullptr), next(nullptr) {}
+        node() : prev(nullptr), next(nullptr), dead(false) {}
+        node(const T &value) : data(value), prev(nullptr), next(nullptr), dead(false) {}
         ~node() {}
     };
 
@@ -58,6 +106,367 @@ protected:
         return pos;
     }
 
+    /**
+     * deferred erase: erase() only marks the node dead and leaves the links alone,
+     * iterators step over dead nodes and compact_erased() unlinks them all in one sweep,
+     * by itself once they make up more than max_dead_ratio of the nodes
+     * list_size counts the live elements only
+     */
+    bool defer_erase = false;
+    double max_dead_ratio = 0.25;
+    size_t dead_count = 0;
+
+    /**
+     * the first live node from cur on (the tail sentinel if there is none)
+     */
+    template<class Node>
+    static Node *skip_dead(Node *cur) {
+        while (cur->dead) {
+            cur = cur->next;
+        }
+        return cur;
+    }
+    /**
+     * the last live node before cur (the head sentinel if there is none)
+     */
+    template<class Node>
+    static Node *live_prev(Node *cur) {
+        cur = cur->prev;
+        while (cur->dead) {
+            cur = cur->prev;
+        }
+        return cur;
+    }
+    /**
+     * free the dead nodes right before pos, so that pos->prev is live or head
+     * the modifiers call it where they link, and only ever compare live neighbours
+     */
+    void reap_before(node *pos) {
+        while (dead_count > 0 && pos->prev->dead) {
+            node *cur = pos->prev;
+            cur->prev->next = pos;
+            pos->prev = cur->prev;
+            delete cur;
+            dead_count--;
+        }
+    }
+
+    /**
+     * payloads larger than this are never copied by sort()
+     */
+    static const size_t heavy_payload_size = 64;
+    /**
+     * integer keys are distributed by radix from this many elements on
+     */
+    static const size_t radix_sort_threshold = 256;
+    /**
+     * the parallel copy gives each thread this many elements at least
+     */
+    static const size_t parallel_copy_grain = 64;
+
+    sort_stats sort_info;
+    /**
+     * the first sorted_prefix elements are known to be in ascending order of operator<
+     * the modifiers keep it up at O(1) cost and never compare elements: what is appended
+     * is left for sort() to check, and a change they cannot place resets it
+     */
+    size_t sorted_prefix = 0;
+    /**
+     * writes through an iterator are not seen, so sorted_prefix is only trusted until
+     * begin() or end() hands out an iterator (not a const_iterator); as such an iterator
+     * stays valid, the list never trusts it again and sort() checks the order instead
+     * atomic since readers may call begin() on a shared list at the same time
+     */
+    mutable std::atomic<bool> order_tracked{true};
+
+    void forget_order() const {
+        if (order_tracked.load(std::memory_order_relaxed)) {
+            order_tracked.store(false, std::memory_order_relaxed);
+        }
+    }
+    /**
+     * the number of leading elements known to be sorted
+     */
+    size_t known_sorted() const {
+        return order_tracked.load(std::memory_order_relaxed) ? sorted_prefix : 0;
+    }
+    /**
+     * extend the known sorted prefix over the elements after it, comparing each with
+     * the one before; last is set to the last element of the prefix (head if it is empty)
+     * assumes there are no dead nodes
+     */
+    size_t sorted_run(node *&last) const {
+        size_t run = known_sorted();
+        node *cur = tail;
+        for (size_t i = run; i < list_size; ++i) {
+            cur = cur->prev;
+        }
+        last = cur->prev;
+        while (cur != tail && (last == head || !(cur->data < last->data))) {
+            last = cur;
+            cur = cur->next;
+            run++;
+        }
+        return run;
+    }
+
+    /**
+     * the cost model of sort():
+     * integer keys (other than bool) go to radix distribution once n is large enough,
+     * payloads that are big, not trivially copyable or not assignable are relinked by merge sort,
+     * everything else is copied to an array and quicksorted.
+     */
+    typedef std::integral_constant<bool, std::is_copy_assignable<T>::value && std::is_move_assignable<T>::value> array_sortable;
+
+    template<class Key>
+    static sort_strategy choose_sort_strategy(size_t n) {
+        if (std::is_integral<Key>::value && !std::is_same<Key, bool>::value && n >= radix_sort_threshold) {
+            return sort_strategy::radix;
+        }
+        if (!array_sortable::value || !std::is_trivially_copyable<T>::value || sizeof(T) > heavy_payload_size) {
+            return sort_strategy::merge;
+        }
+        return sort_strategy::array;
+    }
+
+    template<class Key>
+    void sort_by(Key key) {
+        typedef typename std::decay<decltype(key(std::declval<const T &>()))>::type key_type;
+        size_t n = size();
+        sort_info.size = n;
+        if (n <= 1) {
+            sort_info.strategy = sort_strategy::none;
+            return;
+        }
+        sort_info.strategy = choose_sort_strategy<key_type>(n);
+        switch (sort_info.strategy) {
+            case sort_strategy::radix:
+                radix_sort(key, std::integral_constant<bool, std::is_integral<key_type>::value && !std::is_same<key_type, bool>::value>());
+                break;
+            case sort_strategy::merge:
+                merge_sort(key);
+                break;
+            default:
+                array_sort(key, array_sortable());
+                break;
+        }
+    }
+
+    /**
+     * copy the elements to an array, quicksort it with sjtu::sort and copy them back
+     */
+    template<class Key>
+    void array_sort(Key &key, std::false_type) {
+        merge_sort(key);
+    }
+    template<class Key>
+    void array_sort(Key &key, std::true_type) {
+        size_t n = size();
+        // Allocate raw memory for array
+        void *raw_memory = ::operator new(n * sizeof(T));
+        T *arr = static_cast<T*>(raw_memory);
+
+        // Copy elements to array using placement new
+        size_t i = 0;
+        for (node *cur = head->next; cur != tail; cur = cur->next) {
+            new (&arr[i]) T(cur->data);
+            i++;
+        }
+
+        // Use provided sort function with operator< of the key
+        std::function<bool(const T&, const T&)> cmp = [&key](const T &a, const T &b) { return key(a) < key(b); };
+        sjtu::sort(arr, arr + n, cmp);
+
+        // Copy back to list and destroy array elements
+        i = 0;
+        for (node *cur = head->next; cur != tail; cur = cur->next) {
+            cur->data = arr[i];
+            arr[i].~T();
+            i++;
+        }
+
+        // Free raw memory
+        ::operator delete(raw_memory);
+    }
+
+    /**
+     * merge two null-terminated runs linked by next, a before b
+     * an element of b goes first only if it is strictly less, so the merge is stable
+     */
+    template<class Key>
+    static node *merge_runs(node *a, node *b, Key &key) {
+        node *result = nullptr;
+        node **link = &result;
+        while (a != nullptr && b != nullptr) {
+            if (key(b->data) < key(a->data)) {
+                *link = b;
+                b = b->next;
+            } else {
+                *link = a;
+                a = a->next;
+            }
+            link = &((*link)->next);
+        }
+        *link = (a != nullptr) ? a : b;
+        return result;
+    }
+
+    /**
+     * relink the nodes in order from first (null-terminated by next) between head and tail
+     */
+    void relink_chain(node *first) {
+        node *prev = head;
+        for (node *cur = first; cur != nullptr; cur = cur->next) {
+            cur->prev = prev;
+            prev->next = cur;
+            prev = cur;
+        }
+        prev->next = tail;
+        tail->prev = prev;
+    }
+
+    /**
+     * bottom-up merge sort on the nodes themselves, no element is copied or moved
+     * bins[i] holds a sorted run of 2^i nodes that precede everything still unsorted
+     */
+    template<class Key>
+    void merge_sort(Key &key) {
+        tail->prev->next = nullptr;
+        relink_chain(sort_chain(head->next, key));
+    }
+    /**
+     * merge sort of a null-terminated chain linked by next, returning the sorted chain
+     */
+    template<class Key>
+    static node *sort_chain(node *rest, Key &key) {
+        node *bins[64] = {};
+        while (rest != nullptr) {
+            node *run = rest;
+            rest = rest->next;
+            run->next = nullptr;
+            size_t i = 0;
+            for (; bins[i] != nullptr; ++i) {
+                run = merge_runs(bins[i], run, key);
+                bins[i] = nullptr;
+            }
+            bins[i] = run;
+        }
+        node *result = nullptr;
+        for (size_t i = 0; i < 64; ++i) {
+            if (bins[i] != nullptr) {
+                result = (result == nullptr) ? bins[i] : merge_runs(bins[i], result, key);
+            }
+        }
+        return result;
+    }
+    /**
+     * sort the elements after last, the end of the sorted prefix, and merge them into it
+     */
+    void sort_suffix(node *last) {
+        identity_key key;
+        tail->prev->next = nullptr;
+        node *suffix = sort_chain(last->next, key);
+        last->next = nullptr;
+        relink_chain(merge_runs(head->next, suffix, key));
+    }
+
+    /**
+     * the key sort() uses: the element itself
+     */
+    struct identity_key {
+        const T &operator()(const T &value) const {
+            return value;
+        }
+    };
+
+    /**
+     * LSD radix passes over records with an unsigned field bits, a byte at a time
+     * bytes in which all records agree are skipped; from ends up holding the sorted records
+     */
+    template<class Record>
+    static void radix_passes(Record *&from, Record *&to, size_t n) {
+        for (size_t shift = 0; shift < sizeof(from[0].bits) * 8; shift += 8) {
+            size_t count[257] = {};
+            for (size_t i = 0; i < n; ++i) {
+                count[((from[i].bits >> shift) & 0xff) + 1]++;
+            }
+            if (count[((from[0].bits >> shift) & 0xff) + 1] == n) {
+                continue;
+            }
+            for (size_t b = 1; b <= 256; ++b) {
+                count[b] += count[b - 1];
+            }
+            for (size_t i = 0; i < n; ++i) {
+                to[count[(from[i].bits >> shift) & 0xff]++] = from[i];
+            }
+            Record *tmp = from;
+            from = to;
+            to = tmp;
+        }
+    }
+
+    /**
+     * radix sort of integer keys
+     * when the elements are their own keys the values are sorted and written back in place,
+     * otherwise (key, node) records are sorted and the nodes relinked without copying elements
+     */
+    template<class Key>
+    void radix_sort(Key &key, std::true_type) {
+        radix_sort_integers(key, std::integral_constant<bool, std::is_same<Key, identity_key>::value>());
+    }
+    template<class Key>
+    void radix_sort_integers(Key &, std::true_type) {
+        typedef typename std::make_unsigned<T>::type bits_type;
+        const bits_type bias = std::is_signed<T>::value ? bits_type(bits_type(1) << (sizeof(bits_type) * 8 - 1)) : bits_type(0);
+        struct record {
+            bits_type bits;
+        };
+        size_t n = size();
+        record *from = new record[n];
+        record *to = new record[n];
+        size_t i = 0;
+        for (node *cur = head->next; cur != tail; cur = cur->next, ++i) {
+            from[i].bits = bits_type(static_cast<bits_type>(cur->data) ^ bias);
+        }
+        radix_passes(from, to, n);
+        i = 0;
+        for (node *cur = head->next; cur != tail; cur = cur->next, ++i) {
+            cur->data = static_cast<T>(bits_type(from[i].bits ^ bias));
+        }
+        delete [] from;
+        delete [] to;
+    }
+    template<class Key>
+    void radix_sort_integers(Key &key, std::false_type) {
+        typedef typename std::decay<decltype(key(std::declval<const T &>()))>::type key_type;
+        typedef typename std::make_unsigned<key_type>::type bits_type;
+        const bits_type bias = std::is_signed<key_type>::value ? bits_type(bits_type(1) << (sizeof(bits_type) * 8 - 1)) : bits_type(0);
+        struct record {
+            bits_type bits;
+            node *ptr;
+        };
+        size_t n = size();
+        record *from = new record[n];
+        record *to = new record[n];
+        size_t i = 0;
+        for (node *cur = head->next; cur != tail; cur = cur->next, ++i) {
+            from[i].bits = bits_type(static_cast<bits_type>(key(cur->data)) ^ bias);
+            from[i].ptr = cur;
+        }
+        radix_passes(from, to, n);
+        for (i = 0; i + 1 < n; ++i) {
+            from[i].ptr->next = from[i + 1].ptr;
+        }
+        from[n - 1].ptr->next = nullptr;
+        relink_chain(from[0].ptr);
+        delete [] from;
+        delete [] to;
+    }
+    template<class Key>
+    void radix_sort(Key &key, std::false_type) {
+        merge_sort(key);
+    }
+
 public:
     class const_iterator;
     class iterator {
@@ -79,7 +488,7 @@ public:
                 throw invalid_iterator();
             }
             iterator temp = *this;
-            current = current->next;
+            current = skip_dead(current->next);
             return temp;
         }
         /**
@@ -89,28 +498,28 @@ public:
             if (current == nullptr || current == container->tail) {
                 throw invalid_iterator();
             }
-            current = current->next;
+            current = skip_dead(current->next);
             return *this;
         }
         /**
          * iter--
          */
         iterator operator--(int) {
-            if (current == nullptr || current == container->head->next) {
+            if (current == nullptr || live_prev(current) == container->head) {
                 throw invalid_iterator();
             }
             iterator temp = *this;
-            current = current->prev;
+            current = live_prev(current);
             return temp;
         }
         /**
          * --iter
          */
         iterator & operator--() {
-            if (current == nullptr || current == container->head->next) {
+            if (current == nullptr || live_prev(current) == container->head) {
                 throw invalid_iterator();
             }
-            current = current->prev;
+            current = live_prev(current);
             return *this;
         }
         /**
@@ -118,7 +527,7 @@ public:
          * remember to throw if iterator is invalid
          */
         T & operator *() const {
-            if (current == nullptr || current == container->head || current == container->tail) {
+            if (current == nullptr || current == container->head || current == container->tail || current->dead) {
                 throw invalid_iterator();
             }
             return current->data;
@@ -128,7 +537,7 @@ public:
          * remember to throw if iterator is invalid
          */
         T * operator ->() const {
-            if (current == nullptr || current == container->head || current == container->tail) {
+            if (current == nullptr || current == container->head || current == container->tail || current->dead) {
                 throw invalid_iterator();
             }
             return &(current->data);
@@ -177,7 +586,7 @@ public:
                 throw invalid_iterator();
             }
             const_iterator temp = *this;
-            current = current->next;
+            current = skip_dead(current->next);
             return temp;
         }
         /**
@@ -187,28 +596,28 @@ public:
             if (current == nullptr || current == container->tail) {
                 throw invalid_iterator();
             }
-            current = current->next;
+            current = skip_dead(current->next);
             return *this;
         }
         /**
          * iter--
          */
         const_iterator operator--(int) {
-            if (current == nullptr || current == container->head->next) {
+            if (current == nullptr || live_prev(current) == container->head) {
                 throw invalid_iterator();
             }
             const_iterator temp = *this;
-            current = current->prev;
+            current = live_prev(current);
             return temp;
         }
         /**
          * --iter
          */
         const_iterator & operator--() {
-            if (current == nullptr || current == container->head->next) {
+            if (current == nullptr || live_prev(current) == container->head) {
                 throw invalid_iterator();
             }
-            current = current->prev;
+            current = live_prev(current);
             return *this;
         }
         /**
@@ -216,7 +625,7 @@ public:
          * remember to throw if iterator is invalid
          */
         const T & operator *() const {
-            if (current == nullptr || current == container->head || current == container->tail) {
+            if (current == nullptr || current == container->head || current == container->tail || current->dead) {
                 throw invalid_iterator();
             }
             return current->data;
@@ -226,7 +635,7 @@ public:
          * remember to throw if iterator is invalid
          */
         const T * operator ->() const {
-            if (current == nullptr || current == container->head || current == container->tail) {
+            if (current == nullptr || current == container->head || current == container->tail || current->dead) {
                 throw invalid_iterator();
             }
             return &(current->data);
@@ -250,6 +659,79 @@ public:
             return current != rhs.current;
         }
     };
+    /**
+     * a batch of positional edits for apply_edits()
+     * positions count the elements of the list before the batch is applied:
+     * insert(p, value) puts value before the element at p (p == size() appends),
+     * erase(p) removes the element at p.
+     * the nodes of the inserted values are allocated when the edits are recorded,
+     * so applying the batch allocates nothing.
+     */
+    class edit_batch {
+    private:
+        friend class list<T>;
+        struct record {
+            size_t position;
+            size_t order;
+            node *item;  // nullptr for an erase
+        };
+        record *records;
+        size_t count;
+        size_t capacity;
+
+        void push(size_t position, node *item) {
+            if (count == capacity) {
+                size_t new_capacity = capacity == 0 ? 16 : capacity * 2;
+                record *grown = new record[new_capacity];
+                for (size_t i = 0; i < count; ++i) {
+                    grown[i] = records[i];
+                }
+                delete [] records;
+                records = grown;
+                capacity = new_capacity;
+            }
+            records[count].position = position;
+            records[count].order = count;
+            records[count].item = item;
+            count++;
+        }
+
+    public:
+        edit_batch() : records(nullptr), count(0), capacity(0) {}
+        edit_batch(const edit_batch &) = delete;
+        edit_batch &operator=(const edit_batch &) = delete;
+        ~edit_batch() {
+            clear();
+            delete [] records;
+        }
+        void insert(size_t position, const T &value) {
+            node *item = new node(value);
+            try {
+                push(position, item);
+            } catch (...) {
+                delete item;
+                throw;
+            }
+        }
+        void erase(size_t position) {
+            push(position, nullptr);
+        }
+        size_t size() const {
+            return count;
+        }
+        bool empty() const {
+            return count == 0;
+        }
+        /**
+         * drops the recorded edits
+         */
+        void clear() {
+            for (size_t i = 0; i < count; ++i) {
+                delete records[i].item;
+            }
+            count = 0;
+        }
+    };
     /**
      * TODO Constructs
      * Atleast two: default constructor, copy constructor
@@ -262,6 +744,7 @@ public:
         head->next = tail;
         tail->prev = head;
         tail->next = nullptr;
+        head->dead = tail->dead = false;
         list_size = 0;
     }
     list(const list &other) {
@@ -272,11 +755,125 @@ public:
         head->next = tail;
         tail->prev = head;
         tail->next = nullptr;
+        head->dead = tail->dead = false;
         list_size = 0;
 
         for (const_iterator it = other.cbegin(); it != other.cend(); ++it) {
             push_back(*it);
         }
+        sorted_prefix = other.known_sorted();
+    }
+    /**
+     * copy other with the payload copies spread over threads
+     * the node storage is allocated up front, the payloads are copy-constructed into it
+     * in parallel and the nodes are then linked in order;
+     * if anything throws, every copy made so far is destroyed, all memory is freed
+     * and the exception is rethrown
+     */
+    list(const list &other, parallel_policy policy) {
+        head = tail = nullptr;
+        list_size = 0;
+        size_t n = other.size(), allocated = 0, workers = 1, step = n;
+        const node **from = nullptr;
+        node **to = nullptr;
+        size_t *built = nullptr;
+        std::exception_ptr *errors = nullptr;
+        std::thread *pool = nullptr;
+        try {
+            head = static_cast<node*>(::operator new(sizeof(node)));
+            tail = static_cast<node*>(::operator new(sizeof(node)));
+            head->prev = nullptr;
+            head->next = tail;
+            tail->prev = head;
+            tail->next = nullptr;
+            head->dead = tail->dead = false;
+            if (n == 0) return;
+
+            from = new const node*[n];
+            to = new node*[n];
+            size_t i = 0;
+            for (const node *cur = skip_dead(other.head->next); cur != other.tail; cur = skip_dead(cur->next)) {
+                from[i++] = cur;
+            }
+            // one thread allocates, so the workers do not contend for the allocator
+            for (; allocated < n; ++allocated) {
+                to[allocated] = static_cast<node*>(::operator new(sizeof(node)));
+            }
+
+            workers = policy.threads != 0 ? policy.threads : std::thread::hardware_concurrency();
+            if (workers > n / parallel_copy_grain) {
+                workers = n / parallel_copy_grain;
+            }
+            if (workers == 0) {
+                workers = 1;
+            }
+            step = (n + workers - 1) / workers;
+            std::atomic<bool> failed(false);
+            errors = new std::exception_ptr[workers];
+            built = new size_t[workers]();
+            auto work = [&](size_t t, size_t begin, size_t end) {
+                try {
+                    for (size_t k = begin; k < end && !failed.load(std::memory_order_relaxed); ++k) {
+                        new (to[k]) node(from[k]->data);
+                        built[t]++;
+                    }
+                } catch (...) {
+                    errors[t] = std::current_exception();
+                    failed.store(true, std::memory_order_relaxed);
+                }
+            };
+            if (workers == 1) {
+                work(0, 0, n);
+            } else {
+                pool = new std::thread[workers - 1];
+                for (size_t t = 1; t < workers; ++t) {
+                    size_t begin = t * step, end = begin + step < n ? begin + step : n;
+                    try {
+                        pool[t - 1] = std::thread(work, t, begin, end);
+                    } catch (...) {
+                        // no thread to spare: copy that share here
+                        work(t, begin, end);
+                    }
+                }
+                work(0, 0, step);
+                for (size_t t = 1; t < workers; ++t) {
+                    if (pool[t - 1].joinable()) {
+                        pool[t - 1].join();
+                    }
+                }
+            }
+            for (size_t t = 0; t < workers; ++t) {
+                if (errors[t]) {
+                    std::rethrow_exception(errors[t]);
+                }
+            }
+        } catch (...) {
+            // the share of node k is k / step, and the first built[] of each share hold copies
+            for (size_t k = 0; k < allocated; ++k) {
+                if (built != nullptr && k % step < built[k / step]) {
+                    delete to[k];
+                } else {
+                    ::operator delete(to[k]);
+                }
+            }
+            delete [] pool;
+            delete [] built;
+            delete [] errors;
+            delete [] to;
+            delete [] from;
+            ::operator delete(head);
+            ::operator delete(tail);
+            throw;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            insert(tail, to[i]);
+        }
+        delete [] pool;
+        delete [] built;
+        delete [] errors;
+        delete [] to;
+        delete [] from;
+        sorted_prefix = other.known_sorted();
     }
     /**
      * TODO Destructor
@@ -296,6 +893,7 @@ public:
         for (const_iterator it = other.cbegin(); it != other.cend(); ++it) {
             push_back(*it);
         }
+        sorted_prefix = other.known_sorted();
         return *this;
     }
     /**
@@ -304,25 +902,27 @@ public:
      */
     const T & front() const {
         if (empty()) throw container_is_empty();
-        return head->next->data;
+        return skip_dead(head->next)->data;
     }
     const T & back() const {
         if (empty()) throw container_is_empty();
-        return tail->prev->data;
+        return live_prev(tail)->data;
     }
     /**
      * returns an iterator to the beginning.
      */
     iterator begin() {
-        return iterator(head->next, this);
+        forget_order();
+        return iterator(skip_dead(head->next), this);
     }
     const_iterator cbegin() const {
-        return const_iterator(head->next, this);
+        return const_iterator(skip_dead(head->next), this);
     }
     /**
      * returns an iterator to the end.
      */
     iterator end() {
+        forget_order();
         return iterator(tail, this);
     }
     const_iterator cend() const {
@@ -345,6 +945,7 @@ public:
      * clears the contents
      */
     virtual void clear() {
+        compact_erased();
         while (!empty()) {
             pop_front();
         }
@@ -355,11 +956,16 @@ public:
      * throw if the iterator is invalid
      */
     virtual iterator insert(iterator pos, const T &value) {
-        if (pos.container != this) throw invalid_iterator();
+        if (pos.container != this || pos.current->dead) throw invalid_iterator();
 
-        node *new_node = new node(value);
         node *pos_node = pos.current;
+        reap_before(pos_node);
+        node *new_node = new node(value);
 
+        // an append is left for sort() to check; elsewhere the prefix may be broken
+        if (pos_node != tail) {
+            sorted_prefix = 0;
+        }
         insert(pos_node, new_node);
         return iterator(new_node, this);
     }
@@ -367,16 +973,32 @@ public:
      * remove the element at pos (the end() iterator is invalid)
      * returns an iterator pointing to the following element, if pos pointing to the last element, end() will be returned.
      * throw if the container is empty, the iterator is invalid
+     * in deferred mode the node is only marked dead, see set_deferred_erase()
      */
     virtual iterator erase(iterator pos) {
         if (empty()) throw container_is_empty();
-        if (pos.container != this || pos == end()) throw invalid_iterator();
+        if (pos.container != this || pos == end() || pos.current->dead) throw invalid_iterator();
 
         node *pos_node = pos.current;
-        node *next_node = pos_node->next;
+        node *next_node = skip_dead(pos_node->next);
 
-        erase(pos_node);
-        delete pos_node;
+        // an erase keeps a sorted run sorted; it is known to hit the prefix at its ends
+        if (sorted_prefix == list_size || (sorted_prefix > 0 && pos_node == head->next)) {
+            sorted_prefix--;
+        } else if (sorted_prefix != 0) {
+            sorted_prefix = 0;
+        }
+        if (defer_erase) {
+            pos_node->dead = true;
+            list_size--;
+            dead_count++;
+            if (dead_count > max_dead_ratio * (list_size + dead_count)) {
+                compact_erased();
+            }
+        } else {
+            erase(pos_node);
+            delete pos_node;
+        }
 
         return iterator(next_node, this);
     }
@@ -384,8 +1006,8 @@ public:
      * adds an element to the end
      */
     void push_back(const T &value) {
-        node *new_node = new node(value);
-        insert(tail, new_node);
+        reap_before(tail);
+        insert(tail, new node(value));
     }
     /**
      * removes the last element
@@ -393,7 +1015,11 @@ public:
      */
     void pop_back() {
         if (empty()) throw container_is_empty();
+        reap_before(tail);
         node *last_node = tail->prev;
+        if (sorted_prefix == list_size) {
+            sorted_prefix--;
+        }
         erase(last_node);
         delete last_node;
     }
@@ -401,8 +1027,9 @@ public:
      * inserts an element to the beginning.
      */
     void push_front(const T &value) {
-        node *new_node = new node(value);
-        insert(head->next, new_node);
+        reap_before(skip_dead(head->next));
+        insert(head->next, new node(value));
+        sorted_prefix = 1;
     }
     /**
      * removes the first element.
@@ -410,42 +1037,104 @@ public:
      */
     void pop_front() {
         if (empty()) throw container_is_empty();
-        node *first_node = head->next;
+        node *first_node = skip_dead(head->next);
+        reap_before(first_node);
+        if (sorted_prefix > 0) {
+            sorted_prefix--;
+        }
         erase(first_node);
         delete first_node;
     }
     /**
      * sort the values in ascending order with operator< of T
+     * the engine is picked by choose_sort_strategy(), see last_sort()
+     * the sorted prefix is first extended over the elements after it; a list found
+     * sorted is left alone, and when at least half of it is sorted, only the rest is
+     * sorted and merged in
      */
     void sort() {
-        if (size() <= 1) return;
-
-        // Allocate raw memory for array
+        compact_erased();
         size_t n = size();
-        void *raw_memory = ::operator new(n * sizeof(T));
-        T *arr = static_cast<T*>(raw_memory);
-
-        // Copy elements to array using placement new
-        size_t i = 0;
-        for (iterator it = begin(); it != end(); ++it) {
-            new (&arr[i]) T(*it);
-            i++;
+        node *last = head;
+        size_t run = n > 1 ? sorted_run(last) : 0;
+        if (n > 1 && run == n) {
+            sort_info.size = n;
+            sort_info.strategy = sort_strategy::presorted;
+        } else if (n > 1 && run >= n - run) {
+            sort_info.size = n;
+            sort_info.strategy = sort_strategy::suffix;
+            sort_suffix(last);
+        } else {
+            sort_by(identity_key());
         }
-
-        // Use provided sort function with operator<
-        std::function<bool(const T&, const T&)> cmp = [](const T &a, const T &b) { return a < b; };
-        sjtu::sort(arr, arr + n, cmp);
-
-        // Copy back to list and destroy array elements
-        i = 0;
-        for (iterator it = begin(); it != end(); ++it) {
-            *it = arr[i];
-            arr[i].~T();
-            i++;
+        sorted_prefix = n;
+    }
+    /**
+     * sort the values in ascending order of key(value) with operator< of the key
+     * equivalent elements keep their order unless the array engine is chosen
+     */
+    template<class Key>
+    void sort(Key key) {
+        compact_erased();
+        sort_by(key);
+        sorted_prefix = size() <= 1 ? size() : 0;
+    }
+    /**
+     * switch deferred erase on or off
+     * while it is on, erase() marks the node dead in O(1) without touching its neighbours,
+     * and the dead nodes are compacted once they are more than max_dead_ratio of all nodes;
+     * a ratio of 1 leaves compaction to compact_erased(). switching it off compacts.
+     * throw runtime_error unless 0 < max_dead_ratio <= 1
+     */
+    void set_deferred_erase(bool enabled, double ratio = 0.25) {
+        if (!(ratio > 0 && ratio <= 1)) throw runtime_error();
+        defer_erase = enabled;
+        max_dead_ratio = ratio;
+        if (!enabled) {
+            compact_erased();
         }
-
-        // Free raw memory
-        ::operator delete(raw_memory);
+    }
+    bool deferred_erase() const {
+        return defer_erase;
+    }
+    /**
+     * the number of erased elements whose nodes are still linked
+     */
+    size_t erased_pending() const {
+        return dead_count;
+    }
+    /**
+     * unlink and free every dead node in one forward sweep
+     * links are only written where a run of dead nodes is closed
+     * iterators to live elements stay valid
+     */
+    void compact_erased() {
+        if (dead_count == 0) return;
+        node *last = head;
+        for (node *cur = head->next; cur != tail;) {
+            node *next = cur->next;
+            if (cur->dead) {
+                delete cur;
+            } else {
+                if (last->next != cur) {
+                    last->next = cur;
+                    cur->prev = last;
+                }
+                last = cur;
+            }
+            cur = next;
+        }
+        if (last->next != tail) {
+            last->next = tail;
+            tail->prev = last;
+        }
+        dead_count = 0;
+    }
+    /**
+     * the engine and size of the last sort() of this list
+     */
+    const sort_stats &last_sort() const {
+        return sort_info;
     }
     /**
      * merge two sorted lists into one (both in ascending order)
@@ -458,6 +1147,9 @@ public:
     void merge(list &other) {
         if (this == &other) return;
 
+        compact_erased();
+        other.compact_erased();
+        bool both_sorted = known_sorted() == list_size && other.known_sorted() == other.list_size;
         node *this_ptr = head->next;
         node *other_ptr = other.head->next;
 
@@ -485,6 +1177,45 @@ public:
             insert(tail, other_ptr);
             other_ptr = next_other;
         }
+        sorted_prefix = both_sorted ? list_size : 0;
+        other.sorted_prefix = 0;
+        // iterators into other now reach these nodes
+        if (!other.order_tracked.load(std::memory_order_relaxed)) {
+            forget_order();
+        }
+    }
+    /**
+     * move all elements of other before pos in O(1), other becomes empty
+     * no elements are copied or moved
+     * throw if the iterator is invalid
+     */
+    void splice(iterator pos, list &other) {
+        if (pos.container != this || pos.current->dead) throw invalid_iterator();
+        if (this == &other) return;
+        other.compact_erased();
+        if (other.empty()) return;
+
+        node *pos_node = pos.current;
+        reap_before(pos_node);
+        node *first = other.head->next, *last = other.tail->prev;
+        // appending keeps the prefix and leaves the new elements for sort() to check
+        if (pos_node->prev == head) {
+            sorted_prefix = other.known_sorted();
+        } else if (pos_node != tail) {
+            sorted_prefix = 0;
+        }
+        if (!other.order_tracked.load(std::memory_order_relaxed)) {
+            forget_order();
+        }
+        first->prev = pos_node->prev;
+        pos_node->prev->next = first;
+        last->next = pos_node;
+        pos_node->prev = last;
+        list_size += other.list_size;
+        other.head->next = other.tail;
+        other.tail->prev = other.head;
+        other.list_size = 0;
+        other.sorted_prefix = 0;
     }
     /**
      * reverse the order of the elements
@@ -505,6 +1236,7 @@ public:
         node *temp = head;
         head = tail;
         tail = temp;
+        sorted_prefix = 0;
     }
     /**
      * remove all consecutive duplicate elements from the container
@@ -514,11 +1246,14 @@ public:
     void unique() {
         if (size() <= 1) return;
 
-        iterator it = begin();
+        // dropping elements keeps a sorted list sorted
+        bool was_sorted = sorted_prefix == list_size;
+        // not begin() and end(), which would stop trusting the prefix
+        iterator it(skip_dead(head->next), this), last(tail, this);
         iterator next_it = it;
         ++next_it;
 
-        while (next_it != end()) {
+        while (next_it != last) {
             if (*it == *next_it) {
                 next_it = erase(next_it);
             } else {
@@ -526,6 +1261,58 @@ public:
                 ++next_it;
             }
         }
+        sorted_prefix = was_sorted ? list_size : 0;
+    }
+    /**
+     * apply a batch of edits in one forward pass, O(n + k log k) for k edits
+     * the edits are ordered by position; at the same position the inserts come
+     * first, in the order they were recorded, then the erase
+     * the batch is empty afterwards, its nodes belong to the list
+     * throw index_out_of_bound if a position is past the end or erased twice,
+     * in which case neither the list nor the batch is changed
+     */
+    void apply_edits(edit_batch &batch) {
+        typedef typename edit_batch::record record;
+        size_t k = batch.count;
+        if (k == 0) return;
+
+        compact_erased();
+        record *edits = batch.records;
+        std::function<bool(const record &, const record &)> cmp = [](const record &a, const record &b) {
+            if (a.position != b.position) return a.position < b.position;
+            if ((a.item == nullptr) != (b.item == nullptr)) return a.item != nullptr;
+            return a.order < b.order;
+        };
+        sjtu::sort(edits, edits + k, cmp);
+        for (size_t i = 0; i < k; ++i) {
+            if (edits[i].item == nullptr) {
+                if (edits[i].position >= list_size || (i > 0 && edits[i - 1].item == nullptr && edits[i - 1].position == edits[i].position)) {
+                    throw index_out_of_bound();
+                }
+            } else if (edits[i].position > list_size) {
+                throw index_out_of_bound();
+            }
+        }
+
+        node *cur = head->next;
+        size_t index = 0;
+        for (size_t i = 0; i < k; ++i) {
+            while (index < edits[i].position) {
+                cur = cur->next;
+                index++;
+            }
+            if (edits[i].item != nullptr) {
+                insert(cur, edits[i].item);
+            } else {
+                node *next = cur->next;
+                erase(cur);
+                delete cur;
+                cur = next;
+                index++;
+            }
+        }
+        batch.count = 0;
+        sorted_prefix = 0;
     }
 };
 
@@ -0,0 +1,694 @@
+#ifndef SJTU_MAP_HPP
+#define SJTU_MAP_HPP
+
+#include "exceptions.hpp"
+#include "utility.hpp"
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace sjtu {
+
+/**
+ * an ordered map like std::map, kept in a B+-tree
+ * every node starts on a cache line and holds its keys in one packed array of
+ * about node_bytes, so a search step reads a few adjacent lines; the elements
+ * live out of line and are reached from the leaves, which are linked in order
+ * for range scans.
+ * deletion is relaxed: nodes are never merged or rebalanced, a node is freed
+ * when it becomes empty, so all leaves stay at the same depth.
+ * insert and erase invalidate iterators; find and the bounds compare keys with
+ * operator< of Key only.
+ */
+template<class Key, class T>
+class map {
+public:
+    typedef pair<const Key, T> value_type;
+    class const_iterator;
+    class iterator;
+
+protected:
+    /**
+     * the key array of a node is sized to this many bytes (four cache lines)
+     */
+    static const size_t node_bytes = 256;
+    static const size_t capacity = node_bytes / sizeof(Key) > 4 ? node_bytes / sizeof(Key) : 4;
+
+    struct alignas(64) node {
+        bool is_leaf;
+        size_t count;  // number of keys
+        alignas(Key) unsigned char key_bytes[capacity * sizeof(Key)];
+
+        explicit node(bool leaf) : is_leaf(leaf), count(0) {}
+        Key *keys() {
+            return reinterpret_cast<Key *>(key_bytes);
+        }
+        const Key *keys() const {
+            return reinterpret_cast<const Key *>(key_bytes);
+        }
+    };
+    /**
+     * all keys under children[i] are less than keys[i], which is not greater
+     * than any key under children[i + 1]
+     */
+    struct inner : node {
+        node *children[capacity + 1];
+
+        inner() : node(false) {}
+    };
+    struct leaf : node {
+        value_type *items[capacity];
+        leaf *prev;
+        leaf *next;
+
+        leaf() : node(true), prev(nullptr), next(nullptr) {}
+    };
+
+    node *root;
+    leaf *first_leaf;
+    leaf *last_leaf;
+    size_t map_size;
+
+    /**
+     * open a gap at pos in an array of n keys; the slot at pos is left raw
+     */
+    static void shift_right(Key *keys, size_t n, size_t pos) {
+        for (size_t i = n; i > pos; --i) {
+            new (&keys[i]) Key(std::move(keys[i - 1]));
+            keys[i - 1].~Key();
+        }
+    }
+    /**
+     * close the raw slot at pos in an array of n keys
+     */
+    static void shift_left(Key *keys, size_t n, size_t pos) {
+        for (size_t i = pos; i + 1 < n; ++i) {
+            new (&keys[i]) Key(std::move(keys[i + 1]));
+            keys[i + 1].~Key();
+        }
+    }
+    /**
+     * the number of keys of x not greater than key: the child to descend into
+     */
+    static size_t upper_index(const node *x, const Key &key) {
+        const Key *keys = x->keys();
+        size_t l = 0, r = x->count;
+        while (l < r) {
+            size_t mid = (l + r) >> 1;
+            if (key < keys[mid]) r = mid; else l = mid + 1;
+        }
+        return l;
+    }
+    /**
+     * the number of keys of x less than key
+     */
+    static size_t lower_index(const node *x, const Key &key) {
+        const Key *keys = x->keys();
+        size_t l = 0, r = x->count;
+        while (l < r) {
+            size_t mid = (l + r) >> 1;
+            if (keys[mid] < key) l = mid + 1; else r = mid;
+        }
+        return l;
+    }
+    /**
+     * the leaf that holds key if it is in the map
+     */
+    leaf *find_leaf(const Key &key) const {
+        node *x = root;
+        while (!x->is_leaf) {
+            inner *in = static_cast<inner *>(x);
+            x = in->children[upper_index(in, key)];
+        }
+        return static_cast<leaf *>(x);
+    }
+
+    static void destroy(node *x) {
+        Key *keys = x->keys();
+        if (x->is_leaf) {
+            leaf *l = static_cast<leaf *>(x);
+            for (size_t i = 0; i < l->count; ++i) {
+                delete l->items[i];
+            }
+        } else {
+            inner *in = static_cast<inner *>(x);
+            for (size_t i = 0; i <= in->count; ++i) {
+                destroy(in->children[i]);
+            }
+        }
+        for (size_t i = 0; i < x->count; ++i) {
+            keys[i].~Key();
+        }
+        if (x->is_leaf) {
+            delete static_cast<leaf *>(x);
+        } else {
+            delete static_cast<inner *>(x);
+        }
+    }
+
+    /**
+     * split the full child p->children[i] in two and put the separator into p, which is not full
+     */
+    void split_child(inner *p, size_t i) {
+        node *child = p->children[i];
+        Key *from = child->keys();
+        size_t mid = child->count / 2;
+        node *right;
+        size_t up;  // index in child of the key that becomes the separator
+        if (child->is_leaf) {
+            leaf *l = static_cast<leaf *>(child), *r = new leaf;
+            for (size_t k = mid; k < l->count; ++k) {
+                new (&r->keys()[k - mid]) Key(std::move(from[k]));
+                from[k].~Key();
+                r->items[k - mid] = l->items[k];
+            }
+            r->count = l->count - mid;
+            l->count = mid;
+            r->prev = l;
+            r->next = l->next;
+            if (l->next != nullptr) {
+                l->next->prev = r;
+            } else {
+                last_leaf = r;
+            }
+            l->next = r;
+            right = r;
+            up = 0;
+        } else {
+            inner *in = static_cast<inner *>(child), *r = new inner;
+            for (size_t k = mid + 1; k < in->count; ++k) {
+                new (&r->keys()[k - mid - 1]) Key(std::move(from[k]));
+                from[k].~Key();
+            }
+            for (size_t k = mid + 1; k <= in->count; ++k) {
+                r->children[k - mid - 1] = in->children[k];
+            }
+            r->count = in->count - mid - 1;
+            in->count = mid;
+            right = r;
+            up = mid;
+        }
+        Key *keys = p->keys();
+        shift_right(keys, p->count, i);
+        if (child->is_leaf) {
+            new (&keys[i]) Key(right->keys()[up]);
+        } else {
+            new (&keys[i]) Key(std::move(from[up]));
+            from[up].~Key();
+        }
+        for (size_t k = p->count + 1; k > i + 1; --k) {
+            p->children[k] = p->children[k - 1];
+        }
+        p->children[i + 1] = right;
+        p->count++;
+    }
+
+    /**
+     * remove key from the subtree of x; return whether x became empty and was freed
+     */
+    bool erase_from(node *x, const Key &key, bool &found) {
+        Key *keys = x->keys();
+        if (x->is_leaf) {
+            leaf *l = static_cast<leaf *>(x);
+            size_t i = lower_index(l, key);
+            if (i == l->count || key < keys[i]) {
+                found = false;
+                return false;
+            }
+            found = true;
+            delete l->items[i];
+            keys[i].~Key();
+            shift_left(keys, l->count, i);
+            for (size_t k = i; k + 1 < l->count; ++k) {
+                l->items[k] = l->items[k + 1];
+            }
+            l->count--;
+            map_size--;
+            if (l->count > 0) return false;
+            if (l->prev != nullptr) l->prev->next = l->next; else first_leaf = l->next;
+            if (l->next != nullptr) l->next->prev = l->prev; else last_leaf = l->prev;
+            delete l;
+            return true;
+        }
+        inner *in = static_cast<inner *>(x);
+        size_t i = upper_index(in, key);
+        if (!erase_from(in->children[i], key, found)) return false;
+        if (in->count == 0) {
+            delete in;
+            return true;
+        }
+        // drop the child with a separator next to it
+        size_t k = i > 0 ? i - 1 : 0;
+        keys[k].~Key();
+        shift_left(keys, in->count, k);
+        for (size_t c = i; c < in->count; ++c) {
+            in->children[c] = in->children[c + 1];
+        }
+        in->count--;
+        return false;
+    }
+
+public:
+    class iterator {
+    private:
+        leaf *current;  // nullptr for end()
+        size_t index;
+        const map *container;
+
+    public:
+        friend class map;
+        friend class const_iterator;
+        iterator() : current(nullptr), index(0), container(nullptr) {}
+        iterator(leaf *l, size_t i, const map *c) : current(l), index(i), container(c) {}
+
+        iterator operator++(int) {
+            iterator temp = *this;
+            ++*this;
+            return temp;
+        }
+        iterator & operator++() {
+            if (current == nullptr) {
+                throw invalid_iterator();
+            }
+            if (++index == current->count) {
+                current = current->next;
+                index = 0;
+            }
+            return *this;
+        }
+        iterator operator--(int) {
+            iterator temp = *this;
+            --*this;
+            return temp;
+        }
+        iterator & operator--() {
+            if (container == nullptr) {
+                throw invalid_iterator();
+            }
+            if (current == nullptr) {
+                if (container->last_leaf == nullptr) throw invalid_iterator();
+                current = container->last_leaf;
+                index = current->count - 1;
+            } else if (index > 0) {
+                index--;
+            } else {
+                if (current->prev == nullptr) throw invalid_iterator();
+                current = current->prev;
+                index = current->count - 1;
+            }
+            return *this;
+        }
+        value_type & operator *() const {
+            if (current == nullptr) {
+                throw invalid_iterator();
+            }
+            return *current->items[index];
+        }
+        value_type * operator ->() const {
+            return &**this;
+        }
+        bool operator==(const iterator &rhs) const {
+            return current == rhs.current && index == rhs.index;
+        }
+        bool operator==(const const_iterator &rhs) const {
+            return current == rhs.current && index == rhs.index;
+        }
+        bool operator!=(const iterator &rhs) const {
+            return !(*this == rhs);
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return !(*this == rhs);
+        }
+    };
+    class const_iterator {
+    private:
+        const leaf *current;
+        size_t index;
+        const map *container;
+
+    public:
+        friend class map;
+        friend class iterator;
+        const_iterator() : current(nullptr), index(0), container(nullptr) {}
+        const_iterator(const leaf *l, size_t i, const map *c) : current(l), index(i), container(c) {}
+        const_iterator(const iterator &it) : current(it.current), index(it.index), container(it.container) {}
+
+        const_iterator operator++(int) {
+            const_iterator temp = *this;
+            ++*this;
+            return temp;
+        }
+        const_iterator & operator++() {
+            if (current == nullptr) {
+                throw invalid_iterator();
+            }
+            if (++index == current->count) {
+                current = current->next;
+                index = 0;
+            }
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator temp = *this;
+            --*this;
+            return temp;
+        }
+        const_iterator & operator--() {
+            if (container == nullptr) {
+                throw invalid_iterator();
+            }
+            if (current == nullptr) {
+                if (container->last_leaf == nullptr) throw invalid_iterator();
+                current = container->last_leaf;
+                index = current->count - 1;
+            } else if (index > 0) {
+                index--;
+            } else {
+                if (current->prev == nullptr) throw invalid_iterator();
+                current = current->prev;
+                index = current->count - 1;
+            }
+            return *this;
+        }
+        const value_type & operator *() const {
+            if (current == nullptr) {
+                throw invalid_iterator();
+            }
+            return *current->items[index];
+        }
+        const value_type * operator ->() const {
+            return &**this;
+        }
+        bool operator==(const const_iterator &rhs) const {
+            return current == rhs.current && index == rhs.index;
+        }
+        bool operator==(const iterator &rhs) const {
+            return current == rhs.current && index == rhs.index;
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return !(*this == rhs);
+        }
+        bool operator!=(const iterator &rhs) const {
+            return !(*this == rhs);
+        }
+    };
+
+    map() : root(nullptr), first_leaf(nullptr), last_leaf(nullptr), map_size(0) {}
+    map(const map &other) : map() {
+        assign_sorted(other.cbegin(), other.cend());
+    }
+    ~map() {
+        clear();
+    }
+    map &operator=(const map &other) {
+        if (this == &other) return *this;
+        assign_sorted(other.cbegin(), other.cend());
+        return *this;
+    }
+
+    /**
+     * replace the contents by the elements of [first, last), which must be in
+     * strictly ascending order of first; the tree is built bottom-up with full nodes
+     * in O(n), without a search per element.
+     * throw runtime_error if the keys are out of order or repeated, the map is empty then
+     */
+    template<class Iter>
+    void assign_sorted(Iter first, Iter last) {
+        clear();
+        size_t n = 0;
+        Iter prev = first;
+        for (Iter it = first; it != last; ++it, ++n) {
+            if (n > 0) {
+                if (!((*prev).first < (*it).first)) throw runtime_error();
+                ++prev;
+            }
+        }
+        if (n == 0) return;
+
+        size_t count = (n + capacity - 1) / capacity;
+        node **level = new node*[count];
+        size_t made = 0;
+        try {
+            Iter it = first;
+            while (made < count) {
+                size_t take = n / count + (made < n % count ? 1 : 0);
+                // counted as made at once, so that a throw below frees what the leaf holds
+                leaf *l = new leaf;
+                level[made++] = l;
+                for (; l->count < take; ++it) {
+                    l->items[l->count] = new value_type((*it).first, (*it).second);
+                    try {
+                        new (&l->keys()[l->count]) Key((*it).first);
+                    } catch (...) {
+                        delete l->items[l->count];
+                        throw;
+                    }
+                    l->count++;
+                }
+            }
+        } catch (...) {
+            for (size_t i = 0; i < made; ++i) {
+                destroy(level[i]);
+            }
+            delete [] level;
+            throw;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            leaf *l = static_cast<leaf *>(level[i]);
+            l->prev = i > 0 ? static_cast<leaf *>(level[i - 1]) : nullptr;
+            l->next = i + 1 < count ? static_cast<leaf *>(level[i + 1]) : nullptr;
+        }
+        first_leaf = static_cast<leaf *>(level[0]);
+        last_leaf = static_cast<leaf *>(level[count - 1]);
+        map_size = n;
+
+        // the smallest key under each node of the level, for the separators above
+        const Key **least = new const Key*[count];
+        for (size_t i = 0; i < count; ++i) {
+            least[i] = &level[i]->keys()[0];
+        }
+        while (count > 1) {
+            size_t parents = (count + capacity) / (capacity + 1);
+            node **up = new node*[parents];
+            const Key **up_least = new const Key*[parents];
+            size_t adopted = 0, built = 0;
+            try {
+                while (built < parents) {
+                    size_t take = count / parents + (built < count % parents ? 1 : 0);
+                    inner *in = new inner;
+                    up_least[built] = least[adopted];
+                    in->children[0] = level[adopted++];
+                    up[built++] = in;
+                    for (size_t c = 1; c < take; ++c) {
+                        new (&in->keys()[c - 1]) Key(*least[adopted]);
+                        in->children[c] = level[adopted++];
+                        in->count++;
+                    }
+                }
+            } catch (...) {
+                for (size_t i = 0; i < built; ++i) {
+                    destroy(up[i]);
+                }
+                for (size_t i = adopted; i < count; ++i) {
+                    destroy(level[i]);
+                }
+                delete [] up;
+                delete [] up_least;
+                delete [] level;
+                delete [] least;
+                first_leaf = last_leaf = nullptr;
+                map_size = 0;
+                throw;
+            }
+            delete [] level;
+            delete [] least;
+            level = up;
+            least = up_least;
+            count = parents;
+        }
+        root = level[0];
+        delete [] level;
+        delete [] least;
+    }
+
+    /**
+     * access the value of key
+     * throw index_out_of_bound if key is not in the map
+     */
+    T & at(const Key &key) {
+        iterator it = find(key);
+        if (it == end()) throw index_out_of_bound();
+        return it->second;
+    }
+    const T & at(const Key &key) const {
+        const_iterator it = find(key);
+        if (it == cend()) throw index_out_of_bound();
+        return it->second;
+    }
+    /**
+     * access the value of key, inserting T() first if key is not in the map
+     */
+    T & operator[](const Key &key) {
+        iterator it = find(key);
+        if (it == end()) {
+            it = insert(value_type(key, T())).first;
+        }
+        return it->second;
+    }
+
+    iterator begin() {
+        return iterator(first_leaf, 0, this);
+    }
+    const_iterator cbegin() const {
+        return const_iterator(first_leaf, 0, this);
+    }
+    iterator end() {
+        return iterator(nullptr, 0, this);
+    }
+    const_iterator cend() const {
+        return const_iterator(nullptr, 0, this);
+    }
+
+    bool empty() const {
+        return map_size == 0;
+    }
+    size_t size() const {
+        return map_size;
+    }
+    void clear() {
+        if (root != nullptr) {
+            destroy(root);
+        }
+        root = nullptr;
+        first_leaf = last_leaf = nullptr;
+        map_size = 0;
+    }
+
+    /**
+     * insert value unless its key is in the map already
+     * return an iterator to the element with that key and whether it was inserted
+     * full nodes met on the way down are split before descending
+     */
+    pair<iterator, bool> insert(const value_type &value) {
+        const Key &key = value.first;
+        if (root == nullptr) {
+            root = first_leaf = last_leaf = new leaf;
+        }
+        if (root->count == capacity) {
+            inner *r = new inner;
+            r->children[0] = root;
+            split_child(r, 0);
+            root = r;
+        }
+        node *x = root;
+        while (!x->is_leaf) {
+            inner *in = static_cast<inner *>(x);
+            size_t i = upper_index(in, key);
+            if (in->children[i]->count == capacity) {
+                split_child(in, i);
+                if (!(key < in->keys()[i])) i++;
+            }
+            x = in->children[i];
+        }
+        leaf *l = static_cast<leaf *>(x);
+        size_t i = lower_index(l, key);
+        if (i < l->count && !(key < l->keys()[i])) {
+            return pair<iterator, bool>(iterator(l, i, this), false);
+        }
+        value_type *item = new value_type(value);
+        Key *keys = l->keys();
+        shift_right(keys, l->count, i);
+        try {
+            new (&keys[i]) Key(key);
+        } catch (...) {
+            shift_left(keys, l->count + 1, i);
+            delete item;
+            throw;
+        }
+        for (size_t k = l->count; k > i; --k) {
+            l->items[k] = l->items[k - 1];
+        }
+        l->items[i] = item;
+        l->count++;
+        map_size++;
+        return pair<iterator, bool>(iterator(l, i, this), true);
+    }
+    /**
+     * remove the element at pos (end() is invalid)
+     * return an iterator to the element that followed it
+     */
+    iterator erase(iterator pos) {
+        if (pos.container != this || pos.current == nullptr) throw invalid_iterator();
+        leaf *l = pos.current;
+        size_t i = pos.index;
+        bool vanishes = l->count == 1;
+        leaf *after = l->next;
+        Key key = l->keys()[i];
+        erase(key);
+        if (vanishes) return iterator(after, 0, this);
+        if (i < l->count) return iterator(l, i, this);
+        return iterator(l->next, 0, this);
+    }
+    /**
+     * remove the element with key, return the number of elements removed (0 or 1)
+     */
+    size_t erase(const Key &key) {
+        if (root == nullptr) return 0;
+        bool found = false;
+        if (erase_from(root, key, found)) {
+            root = nullptr;
+        }
+        // a root left with a single child gives the tree up to it
+        while (root != nullptr && !root->is_leaf && root->count == 0) {
+            inner *old = static_cast<inner *>(root);
+            root = old->children[0];
+            delete old;
+        }
+        return found ? 1 : 0;
+    }
+
+    size_t count(const Key &key) const {
+        return find(key) == cend() ? 0 : 1;
+    }
+    iterator find(const Key &key) {
+        if (root == nullptr) return end();
+        leaf *l = find_leaf(key);
+        size_t i = lower_index(l, key);
+        if (i == l->count || key < l->keys()[i]) return end();
+        return iterator(l, i, this);
+    }
+    const_iterator find(const Key &key) const {
+        return const_cast<map *>(this)->find(key);
+    }
+    /**
+     * the first element whose key is not less than key, as sjtu::lower_bound
+     */
+    iterator lower_bound(const Key &key) {
+        if (root == nullptr) return end();
+        leaf *l = find_leaf(key);
+        size_t i = lower_index(l, key);
+        if (i == l->count) return iterator(l->next, 0, this);
+        return iterator(l, i, this);
+    }
+    const_iterator lower_bound(const Key &key) const {
+        return const_cast<map *>(this)->lower_bound(key);
+    }
+    /**
+     * the first element whose key is greater than key, as sjtu::upper_bound
+     */
+    iterator upper_bound(const Key &key) {
+        if (root == nullptr) return end();
+        leaf *l = find_leaf(key);
+        size_t i = upper_index(l, key);
+        if (i == l->count) return iterator(l->next, 0, this);
+        return iterator(l, i, this);
+    }
+    const_iterator upper_bound(const Key &key) const {
+        return const_cast<map *>(this)->upper_bound(key);
+    }
+};
+
+}
+
+#endif //SJTU_MAP_HPP
@@ -0,0 +1,578 @@
+#ifndef SJTU_PAIR_LIST_HPP
+#define SJTU_PAIR_LIST_HPP
+
+#include "exceptions.hpp"
+#include "utility.hpp"
+
+#include <cstddef>
+#include <new>
+
+namespace sjtu {
+
+/**
+ * a list of sjtu::pair<K, V> split into a key column and a value column
+ * the nodes hold the key and the links only and are carved from chunks, so a
+ * scan by key walks small records packed together; every value lives in its
+ * own allocation and is reached through the node only when it is asked for.
+ * sort(), merge(), unique() and find() compare keys and never touch a value.
+ * iterators yield a reference {first, second} to the key and the value.
+ */
+template<typename K, typename V>
+class pair_list {
+public:
+    class const_iterator;
+    class iterator;
+    typedef pair<K, V> value_type;
+
+    /**
+     * what *it yields: the key and the value of one element
+     * the key is const, as moving it would break the order kept by sort()
+     */
+    struct reference {
+        const K &first;
+        V &second;
+
+        operator value_type() const {
+            return value_type(first, second);
+        }
+    };
+    struct const_reference {
+        const K &first;
+        const V &second;
+
+        const_reference(const K &k, const V &v) : first(k), second(v) {}
+        const_reference(const reference &r) : first(r.first), second(r.second) {}
+        operator value_type() const {
+            return value_type(first, second);
+        }
+    };
+
+protected:
+    class node {
+    public:
+        K key;
+        node *prev;
+        node *next;
+        V *value;
+
+        node(const K &k, V *v) : key(k), prev(nullptr), next(nullptr), value(v) {}
+    };
+
+    /**
+     * nodes are allocated nodes_per_chunk at a time; a freed node goes back
+     * to free_nodes and is reused before a new chunk is allocated
+     */
+    static const size_t nodes_per_chunk = 64;
+    struct slot {
+        alignas(node) alignas(slot *) unsigned char bytes[sizeof(node) > sizeof(slot *) ? sizeof(node) : sizeof(slot *)];
+
+        slot *&free_next() {
+            return *reinterpret_cast<slot **>(bytes);
+        }
+    };
+    struct chunk {
+        slot slots[nodes_per_chunk];
+        chunk *next;
+    };
+
+    node *head;
+    node *tail;
+    size_t list_size;
+    chunk *chunks;
+    slot *free_nodes;
+
+    void init() {
+        head = static_cast<node *>(::operator new(sizeof(node)));
+        tail = static_cast<node *>(::operator new(sizeof(node)));
+        head->prev = nullptr;
+        head->next = tail;
+        tail->prev = head;
+        tail->next = nullptr;
+        list_size = 0;
+        chunks = nullptr;
+        free_nodes = nullptr;
+    }
+
+    /**
+     * slots come from free_nodes, which is refilled a chunk at a time
+     */
+    slot *take_slot() {
+        if (free_nodes == nullptr) {
+            chunk *c = new chunk;
+            c->next = chunks;
+            chunks = c;
+            for (size_t i = nodes_per_chunk; i > 0; --i) {
+                put_slot(&c->slots[i - 1]);
+            }
+        }
+        slot *s = free_nodes;
+        free_nodes = s->free_next();
+        return s;
+    }
+    void put_slot(slot *s) {
+        s->free_next() = free_nodes;
+        free_nodes = s;
+    }
+    /**
+     * a node for key that takes over value
+     */
+    node *adopt_node(const K &key, V *value) {
+        slot *s = take_slot();
+        try {
+            return new (s->bytes) node(key, value);
+        } catch (...) {
+            put_slot(s);
+            throw;
+        }
+    }
+    /**
+     * a node for key and a copy of value, stored out of line
+     */
+    node *make_node(const K &key, const V &value) {
+        V *stored = new V(value);
+        try {
+            return adopt_node(key, stored);
+        } catch (...) {
+            delete stored;
+            throw;
+        }
+    }
+    /**
+     * destroy the node, and its value unless keep_value
+     */
+    void free_node(node *n, bool keep_value = false) {
+        if (!keep_value) {
+            delete n->value;
+        }
+        n->~node();
+        put_slot(reinterpret_cast<slot *>(n));
+    }
+
+    /**
+     * insert node cur before node pos
+     */
+    node *link(node *pos, node *cur) {
+        cur->prev = pos->prev;
+        cur->next = pos;
+        pos->prev->next = cur;
+        pos->prev = cur;
+        list_size++;
+        return cur;
+    }
+    /**
+     * remove node pos from the list without freeing it
+     */
+    node *unlink(node *pos) {
+        pos->prev->next = pos->next;
+        pos->next->prev = pos->prev;
+        list_size--;
+        return pos;
+    }
+
+    /**
+     * merge two null-terminated runs by key, a before b; stable
+     */
+    static node *merge_runs(node *a, node *b) {
+        node *result = nullptr;
+        node **link = &result;
+        while (a != nullptr && b != nullptr) {
+            if (b->key < a->key) {
+                *link = b;
+                b = b->next;
+            } else {
+                *link = a;
+                a = a->next;
+            }
+            link = &((*link)->next);
+        }
+        *link = (a != nullptr) ? a : b;
+        return result;
+    }
+
+public:
+    class iterator {
+    private:
+        node *current;
+        const pair_list *container;
+
+    public:
+        friend class pair_list<K, V>;
+        friend class const_iterator;
+        /**
+         * it->first, it->second through a reference held by value
+         */
+        struct pointer {
+            reference ref;
+            reference *operator->() {
+                return &ref;
+            }
+        };
+
+        iterator() : current(nullptr), container(nullptr) {}
+        iterator(node *n, const pair_list *c) : current(n), container(c) {}
+
+        iterator operator++(int) {
+            iterator temp = *this;
+            ++*this;
+            return temp;
+        }
+        iterator & operator++() {
+            if (current == nullptr || current == container->tail) {
+                throw invalid_iterator();
+            }
+            current = current->next;
+            return *this;
+        }
+        iterator operator--(int) {
+            iterator temp = *this;
+            --*this;
+            return temp;
+        }
+        iterator & operator--() {
+            if (current == nullptr || current == container->head->next) {
+                throw invalid_iterator();
+            }
+            current = current->prev;
+            return *this;
+        }
+        reference operator *() const {
+            if (current == nullptr || current == container->head || current == container->tail) {
+                throw invalid_iterator();
+            }
+            return reference{current->key, *current->value};
+        }
+        pointer operator ->() const {
+            return pointer{**this};
+        }
+        /**
+         * the key alone, without loading the value
+         */
+        const K &key() const {
+            if (current == nullptr || current == container->head || current == container->tail) {
+                throw invalid_iterator();
+            }
+            return current->key;
+        }
+        bool operator==(const iterator &rhs) const {
+            return current == rhs.current;
+        }
+        bool operator==(const const_iterator &rhs) const {
+            return current == rhs.current;
+        }
+        bool operator!=(const iterator &rhs) const {
+            return current != rhs.current;
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return current != rhs.current;
+        }
+    };
+    class const_iterator {
+    private:
+        const node *current;
+        const pair_list *container;
+
+    public:
+        friend class pair_list<K, V>;
+        friend class iterator;
+        struct pointer {
+            const_reference ref;
+            const_reference *operator->() {
+                return &ref;
+            }
+        };
+
+        const_iterator() : current(nullptr), container(nullptr) {}
+        const_iterator(const node *n, const pair_list *c) : current(n), container(c) {}
+        const_iterator(const iterator &it) : current(it.current), container(it.container) {}
+
+        const_iterator operator++(int) {
+            const_iterator temp = *this;
+            ++*this;
+            return temp;
+        }
+        const_iterator & operator++() {
+            if (current == nullptr || current == container->tail) {
+                throw invalid_iterator();
+            }
+            current = current->next;
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator temp = *this;
+            --*this;
+            return temp;
+        }
+        const_iterator & operator--() {
+            if (current == nullptr || current == container->head->next) {
+                throw invalid_iterator();
+            }
+            current = current->prev;
+            return *this;
+        }
+        const_reference operator *() const {
+            if (current == nullptr || current == container->head || current == container->tail) {
+                throw invalid_iterator();
+            }
+            return const_reference(current->key, *current->value);
+        }
+        pointer operator ->() const {
+            return pointer{**this};
+        }
+        const K &key() const {
+            if (current == nullptr || current == container->head || current == container->tail) {
+                throw invalid_iterator();
+            }
+            return current->key;
+        }
+        bool operator==(const const_iterator &rhs) const {
+            return current == rhs.current;
+        }
+        bool operator==(const iterator &rhs) const {
+            return current == rhs.current;
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return current != rhs.current;
+        }
+        bool operator!=(const iterator &rhs) const {
+            return current != rhs.current;
+        }
+    };
+
+    pair_list() {
+        init();
+    }
+    pair_list(const pair_list &other) {
+        init();
+        try {
+            for (const node *cur = other.head->next; cur != other.tail; cur = cur->next) {
+                link(tail, make_node(cur->key, *cur->value));
+            }
+        } catch (...) {
+            destroy();
+            throw;
+        }
+    }
+    ~pair_list() {
+        destroy();
+    }
+    pair_list &operator=(const pair_list &other) {
+        if (this == &other) return *this;
+        clear();
+        for (const node *cur = other.head->next; cur != other.tail; cur = cur->next) {
+            link(tail, make_node(cur->key, *cur->value));
+        }
+        return *this;
+    }
+
+    /**
+     * access the first / last element
+     * throw container_is_empty when the container is empty.
+     */
+    reference front() {
+        if (empty()) throw container_is_empty();
+        return reference{head->next->key, *head->next->value};
+    }
+    const_reference front() const {
+        if (empty()) throw container_is_empty();
+        return const_reference(head->next->key, *head->next->value);
+    }
+    reference back() {
+        if (empty()) throw container_is_empty();
+        return reference{tail->prev->key, *tail->prev->value};
+    }
+    const_reference back() const {
+        if (empty()) throw container_is_empty();
+        return const_reference(tail->prev->key, *tail->prev->value);
+    }
+
+    iterator begin() {
+        return iterator(head->next, this);
+    }
+    const_iterator cbegin() const {
+        return const_iterator(head->next, this);
+    }
+    iterator end() {
+        return iterator(tail, this);
+    }
+    const_iterator cend() const {
+        return const_iterator(tail, this);
+    }
+
+    bool empty() const {
+        return list_size == 0;
+    }
+    size_t size() const {
+        return list_size;
+    }
+
+    /**
+     * clears the contents; the node chunks are kept for reuse
+     */
+    void clear() {
+        node *cur = head->next;
+        while (cur != tail) {
+            node *next = cur->next;
+            free_node(cur);
+            cur = next;
+        }
+        head->next = tail;
+        tail->prev = head;
+        list_size = 0;
+    }
+    /**
+     * insert value before pos (pos may be end())
+     * return an iterator pointing to the inserted value
+     * throw if the iterator is invalid
+     */
+    iterator insert(iterator pos, const value_type &value) {
+        if (pos.container != this || pos.current == head) throw invalid_iterator();
+        return iterator(link(pos.current, make_node(value.first, value.second)), this);
+    }
+    /**
+     * remove the element at pos (end() is invalid)
+     * return an iterator pointing to the following element
+     * throw if the container is empty or the iterator is invalid
+     */
+    iterator erase(iterator pos) {
+        if (empty()) throw container_is_empty();
+        if (pos.container != this || pos.current == head || pos.current == tail) throw invalid_iterator();
+        node *next = pos.current->next;
+        free_node(unlink(pos.current));
+        return iterator(next, this);
+    }
+    void push_back(const value_type &value) {
+        link(tail, make_node(value.first, value.second));
+    }
+    void push_front(const value_type &value) {
+        link(head->next, make_node(value.first, value.second));
+    }
+    /**
+     * throw container_is_empty when the container is empty.
+     */
+    void pop_back() {
+        if (empty()) throw container_is_empty();
+        free_node(unlink(tail->prev));
+    }
+    void pop_front() {
+        if (empty()) throw container_is_empty();
+        free_node(unlink(head->next));
+    }
+
+    /**
+     * the first element whose key equals key, or end()
+     * only the key column is read
+     */
+    iterator find(const K &key) {
+        node *cur = head->next;
+        while (cur != tail && !(cur->key == key)) {
+            cur = cur->next;
+        }
+        return iterator(cur, this);
+    }
+    const_iterator find(const K &key) const {
+        const node *cur = head->next;
+        while (cur != tail && !(cur->key == key)) {
+            cur = cur->next;
+        }
+        return const_iterator(cur, this);
+    }
+    /**
+     * the number of elements whose key equals key
+     */
+    size_t count(const K &key) const {
+        size_t n = 0;
+        for (const node *cur = head->next; cur != tail; cur = cur->next) {
+            if (cur->key == key) {
+                n++;
+            }
+        }
+        return n;
+    }
+
+    /**
+     * sort by key in ascending order with operator< of K, stable
+     * a bottom-up merge sort that relinks the nodes; no value is read, copied or moved
+     */
+    void sort() {
+        if (list_size <= 1) return;
+        node *bins[64] = {};
+        tail->prev->next = nullptr;
+        node *rest = head->next;
+        while (rest != nullptr) {
+            node *run = rest;
+            rest = rest->next;
+            run->next = nullptr;
+            size_t i = 0;
+            for (; bins[i] != nullptr; ++i) {
+                run = merge_runs(bins[i], run);
+                bins[i] = nullptr;
+            }
+            bins[i] = run;
+        }
+        node *result = nullptr;
+        for (size_t i = 0; i < 64; ++i) {
+            if (bins[i] != nullptr) {
+                result = (result == nullptr) ? bins[i] : merge_runs(bins[i], result);
+            }
+        }
+        node *prev = head;
+        for (node *cur = result; cur != nullptr; cur = cur->next) {
+            cur->prev = prev;
+            prev = cur;
+        }
+        head->next = result;
+        prev->next = tail;
+        tail->prev = prev;
+    }
+    /**
+     * merge two lists sorted by key into one, other becomes empty
+     * for equal keys the elements of *this come first
+     * the keys of other are copied into nodes of *this; the values are handed over
+     * without being copied or moved
+     */
+    void merge(pair_list &other) {
+        if (this == &other) return;
+        node *this_ptr = head->next;
+        node *other_ptr = other.head->next;
+        while (other_ptr != other.tail) {
+            while (this_ptr != tail && !(other_ptr->key < this_ptr->key)) {
+                this_ptr = this_ptr->next;
+            }
+            link(this_ptr, adopt_node(other_ptr->key, other_ptr->value));
+            node *next_other = other_ptr->next;
+            other.free_node(other.unlink(other_ptr), true);
+            other_ptr = next_other;
+        }
+    }
+    /**
+     * remove all consecutive elements with equal keys but the first of each group
+     * compares the keys with operator== of K
+     */
+    void unique() {
+        if (list_size <= 1) return;
+        node *cur = head->next;
+        while (cur->next != tail) {
+            if (cur->next->key == cur->key) {
+                free_node(unlink(cur->next));
+            } else {
+                cur = cur->next;
+            }
+        }
+    }
+
+private:
+    void destroy() {
+        clear();
+        while (chunks != nullptr) {
+            chunk *next = chunks->next;
+            delete chunks;
+            chunks = next;
+        }
+        ::operator delete(head);
+        ::operator delete(tail);
+    }
+};
+
+}
+
+#endif //SJTU_PAIR_LIST_HPP
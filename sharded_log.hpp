@@ -0,0 +1,243 @@
+#ifndef SJTU_SHARDED_LOG_HPP
+#define SJTU_SHARDED_LOG_HPP
+
+#include "exceptions.hpp"
+#include "list.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+namespace sjtu {
+
+/**
+ * an append-only log written by many threads and read in batches
+ * every thread appends to a shard of its own, a list<T> on a cache line of its
+ * own, so appends from different threads never touch the same memory; a reader
+ * collects the shards by splicing them, without copying an element.
+ * each shard has a lock that only its writer and a collecting reader take, so
+ * it is uncontended unless there are more threads than shards.
+ * with stamped set, every append also takes a number from a global sequence, and
+ * collect_ordered() restores the order of the appends by a k-way merge of the shards.
+ */
+template<typename T>
+class sharded_log {
+protected:
+    typedef typename list<T>::node node;
+
+    /**
+     * stamps[i] is the sequence number of the i-th element of items
+     */
+    struct alignas(64) shard {
+        std::atomic<bool> busy;
+        list<T> items;
+        unsigned long long *stamps;
+        size_t stamp_count;
+        size_t stamp_capacity;
+
+        shard() : busy(false), stamps(nullptr), stamp_count(0), stamp_capacity(0) {}
+        ~shard() {
+            delete [] stamps;
+        }
+    };
+    class shard_lock {
+    public:
+        shard *s;
+
+        explicit shard_lock(shard *locked) : s(locked) {
+            while (s->busy.exchange(true, std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+        }
+        ~shard_lock() {
+            s->busy.store(false, std::memory_order_release);
+        }
+        shard_lock(const shard_lock &) = delete;
+        shard_lock &operator=(const shard_lock &) = delete;
+    };
+
+    shard *shards;
+    size_t count;
+    bool stamped;
+    alignas(64) std::atomic<unsigned long long> sequence;
+
+    static size_t home_shard() {
+        static std::atomic<size_t> threads(0);
+        thread_local size_t id = threads.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+    static void reserve_stamp(shard &s) {
+        if (s.stamp_count < s.stamp_capacity) return;
+        size_t capacity = s.stamp_capacity == 0 ? 64 : s.stamp_capacity * 2;
+        unsigned long long *grown = new unsigned long long[capacity];
+        for (size_t i = 0; i < s.stamp_count; ++i) {
+            grown[i] = s.stamps[i];
+        }
+        delete [] s.stamps;
+        s.stamps = grown;
+        s.stamp_capacity = capacity;
+    }
+    /**
+     * move the first node of from to the end of to
+     */
+    static void move_front(list<T> &from, list<T> &to) {
+        node *first = from.erase(from.head->next);
+        to.insert(to.tail, first);
+    }
+
+public:
+    /**
+     * shards == 0 gives one shard per hardware thread
+     */
+    explicit sharded_log(size_t shards = 0, bool stamps = false) : stamped(stamps), sequence(0) {
+        count = shards != 0 ? shards : std::thread::hardware_concurrency();
+        if (count == 0) count = 1;
+        this->shards = new shard[count];
+    }
+    sharded_log(const sharded_log &) = delete;
+    sharded_log &operator=(const sharded_log &) = delete;
+    ~sharded_log() {
+        delete [] shards;
+    }
+
+    size_t shard_count() const {
+        return count;
+    }
+    bool is_stamped() const {
+        return stamped;
+    }
+    /**
+     * append value to the shard of the calling thread
+     */
+    void append(const T &value) {
+        shard &s = shards[home_shard() % count];
+        shard_lock lock(&s);
+        if (stamped) {
+            reserve_stamp(s);
+        }
+        s.items.push_back(value);
+        if (stamped) {
+            // taken under the lock, so the stamps of a shard ascend even if threads share it
+            s.stamps[s.stamp_count++] = sequence.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    /**
+     * the number of elements not collected yet, at the moment each shard is counted
+     */
+    size_t size() {
+        size_t n = 0;
+        for (size_t i = 0; i < count; ++i) {
+            shard_lock lock(&shards[i]);
+            n += shards[i].items.size();
+        }
+        return n;
+    }
+    /**
+     * take every element appended so far, shard after shard, each shard in the
+     * order of its appends; O(number of shards)
+     */
+    void collect_into(list<T> &into) {
+        for (size_t i = 0; i < count; ++i) {
+            shard_lock lock(&shards[i]);
+            into.splice(into.end(), shards[i].items);
+            shards[i].stamp_count = 0;
+        }
+    }
+    list<T> collect() {
+        list<T> out;
+        collect_into(out);
+        return out;
+    }
+    /**
+     * take the elements appended so far in the order the appends took their
+     * stamps, which extends the order of the appends of every thread
+     * the sequence is read once as a cutoff: exactly the stamps below it are
+     * taken, and later appends stay in their shards, so successive collects
+     * hand out consecutive runs of the sequence with nothing skipped between.
+     * the shards are detached under their locks and merged after, relinking nodes
+     * throw runtime_error if the log is not stamped
+     */
+    list<T> collect_ordered() {
+        if (!stamped) throw runtime_error();
+        list<T> out;
+        list<T> *parts = new list<T>[count];
+        unsigned long long **stamps = new unsigned long long *[count]();
+        size_t *heap = nullptr, *at = nullptr;
+        try {
+            // an append with a stamp below cutoff still held the lock of its shard
+            // when cutoff was read, so it is complete once that lock is taken here
+            const unsigned long long cutoff = sequence.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < count; ++i) {
+                shard &s = shards[i];
+                shard_lock lock(&s);
+                size_t taken = 0;
+                while (taken < s.stamp_count && s.stamps[taken] < cutoff) {
+                    taken++;
+                }
+                if (taken == 0) continue;
+                if (taken == s.stamp_count) {
+                    parts[i].splice(parts[i].end(), s.items);
+                    parts[i].sorted_prefix = 0;
+                    stamps[i] = s.stamps;
+                    s.stamps = nullptr;
+                    s.stamp_count = s.stamp_capacity = 0;
+                } else {
+                    stamps[i] = new unsigned long long[taken];
+                    for (size_t k = 0; k < taken; ++k) {
+                        stamps[i][k] = s.stamps[k];
+                        move_front(s.items, parts[i]);
+                    }
+                    for (size_t k = taken; k < s.stamp_count; ++k) {
+                        s.stamps[k - taken] = s.stamps[k];
+                    }
+                    s.stamp_count -= taken;
+                }
+            }
+            // a binary heap of the non-empty parts by the stamp of their first element
+            heap = new size_t[count];
+            at = new size_t[count]();
+            size_t heap_size = 0;
+            auto before = [&](size_t a, size_t b) {
+                return stamps[a][at[a]] < stamps[b][at[b]];
+            };
+            auto sift_down = [&](size_t i) {
+                while (true) {
+                    size_t least = i, l = 2 * i + 1, r = l + 1;
+                    if (l < heap_size && before(heap[l], heap[least])) least = l;
+                    if (r < heap_size && before(heap[r], heap[least])) least = r;
+                    if (least == i) return;
+                    size_t tmp = heap[i];
+                    heap[i] = heap[least];
+                    heap[least] = tmp;
+                    i = least;
+                }
+            };
+            for (size_t i = 0; i < count; ++i) {
+                if (!parts[i].empty()) heap[heap_size++] = i;
+            }
+            for (size_t i = heap_size / 2; i-- > 0;) {
+                sift_down(i);
+            }
+            while (heap_size > 0) {
+                size_t p = heap[0];
+                move_front(parts[p], out);
+                at[p]++;
+                if (parts[p].empty()) {
+                    heap[0] = heap[--heap_size];
+                }
+                sift_down(0);
+            }
+        } catch (...) {
+            for (size_t i = 0; i < count; ++i) delete [] stamps[i];
+            delete [] stamps; delete [] parts; delete [] heap; delete [] at;
+            throw;
+        }
+        for (size_t i = 0; i < count; ++i) delete [] stamps[i];
+        delete [] stamps; delete [] parts; delete [] heap; delete [] at;
+        return out;
+    }
+};
+
+}
+
+#endif //SJTU_SHARDED_LOG_HPP
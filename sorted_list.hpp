@@ -0,0 +1,431 @@
+#ifndef SJTU_SORTED_LIST_HPP
+#define SJTU_SORTED_LIST_HPP
+
+#include "exceptions.hpp"
+#include "list.hpp"
+
+#include <cstddef>
+#include <utility>
+
+namespace sjtu {
+
+/**
+ * a list kept in ascending order with operator< of T, as a skip list
+ * the elements are the nodes of sjtu::list, doubly-linked on the bottom level;
+ * the upper levels are index nodes pointing down to them, so a list can be
+ * turned into a sorted_list and back by relinking its nodes.
+ * equivalent elements keep their insertion order.
+ */
+template<typename T>
+class sorted_list {
+public:
+    class const_iterator;
+    /**
+     * the elements are keys of the order and cannot be modified in place
+     */
+    typedef const_iterator iterator;
+
+protected:
+    typedef typename list<T>::node node;
+    /**
+     * an entry of an upper level: base is the node it stands for,
+     * down the entry of the same node one level lower (nullptr on level 1)
+     */
+    struct index_node {
+        node *base;
+        index_node *right;
+        index_node *down;
+
+        index_node(node *b, index_node *r, index_node *d) : base(b), right(r), down(d) {}
+    };
+    /**
+     * a node gets each further level with probability 1 / 4
+     */
+    static const size_t max_level = 24;
+
+    node *head;
+    node *tail;
+    size_t list_size;
+    /**
+     * heads[l] starts upper level l + 1, levels of them are in use
+     */
+    index_node *heads[max_level];
+    size_t levels;
+    unsigned int seed;
+
+    void init() {
+        // Create sentinel nodes without calling T's constructor
+        head = static_cast<node*>(::operator new(sizeof(node)));
+        tail = static_cast<node*>(::operator new(sizeof(node)));
+        head->prev = nullptr;
+        head->next = tail;
+        tail->prev = head;
+        tail->next = nullptr;
+        head->dead = tail->dead = false;
+        list_size = 0;
+        levels = 0;
+        seed = 2463534242u;
+    }
+    /**
+     * number of upper levels for a new node
+     */
+    size_t random_level() {
+        size_t h = 0;
+        while (h < max_level) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            if (seed & 3) break;
+            ++h;
+        }
+        return h;
+    }
+    void raise_levels(size_t h) {
+        while (levels < h) {
+            heads[levels] = new index_node(head, nullptr, levels > 0 ? heads[levels - 1] : nullptr);
+            ++levels;
+        }
+    }
+    void drop_index() {
+        for (size_t l = 0; l < levels; ++l) {
+            index_node *x = heads[l];
+            while (x != nullptr) {
+                index_node *next = x->right;
+                delete x;
+                x = next;
+            }
+        }
+        levels = 0;
+    }
+    /**
+     * builds the upper levels over the bottom level in one pass
+     */
+    void rebuild_index() {
+        drop_index();
+        index_node *last[max_level];
+        for (node *cur = head->next; cur != tail; cur = cur->next) {
+            size_t h = random_level();
+            for (size_t l = levels; l < h; ++l) {
+                raise_levels(l + 1);
+                last[l] = heads[l];
+            }
+            index_node *down = nullptr;
+            for (size_t l = 0; l < h; ++l) {
+                last[l]->right = new index_node(cur, nullptr, down);
+                last[l] = down = last[l]->right;
+            }
+        }
+    }
+    static bool goes_before(const T &a, const T &b, bool inclusive) {
+        return inclusive ? !(b < a) : a < b;
+    }
+    /**
+     * the last node less than value (or not greater than value if inclusive),
+     * head if there is none; update[l] receives the last entry visited on level l + 1
+     */
+    node *find_before(const T &value, bool inclusive, index_node **update) const {
+        index_node *x = levels > 0 ? heads[levels - 1] : nullptr;
+        for (size_t l = levels; l-- > 0;) {
+            while (x->right != nullptr && goes_before(x->right->base->data, value, inclusive)) {
+                x = x->right;
+            }
+            if (update != nullptr) update[l] = x;
+            if (l > 0) x = x->down;
+        }
+        node *cur = x != nullptr ? x->base : head;
+        while (cur->next != tail && goes_before(cur->next->data, value, inclusive)) {
+            cur = cur->next;
+        }
+        return cur;
+    }
+    /**
+     * removes the entries standing for target from the upper levels
+     */
+    void unlink_index(node *target) {
+        const T &value = target->data;
+        index_node *x = levels > 0 ? heads[levels - 1] : nullptr;
+        for (size_t l = levels; l-- > 0;) {
+            while (x->right != nullptr && x->right->base->data < value) {
+                x = x->right;
+            }
+            // equivalent entries may stand on either side of target, so they
+            // are searched without leaving the last entry strictly before it
+            index_node *y = x;
+            while (y->right != nullptr && y->right->base != target && !(value < y->right->base->data)) {
+                y = y->right;
+            }
+            if (y->right != nullptr && y->right->base == target) {
+                index_node *gone = y->right;
+                y->right = gone->right;
+                delete gone;
+            }
+            if (l > 0) x = x->down;
+        }
+        while (levels > 0 && heads[levels - 1]->right == nullptr) {
+            delete heads[--levels];
+        }
+    }
+
+public:
+    class const_iterator {
+    private:
+        const node *current;
+        const sorted_list *container;
+
+    public:
+        friend class sorted_list<T>;
+        const_iterator() : current(nullptr), container(nullptr) {}
+        const_iterator(const node *n, const sorted_list *c) : current(n), container(c) {}
+
+        /**
+         * iter++
+         */
+        const_iterator operator++(int) {
+            if (current == nullptr || current == container->tail) {
+                throw invalid_iterator();
+            }
+            const_iterator temp = *this;
+            current = current->next;
+            return temp;
+        }
+        /**
+         * ++iter
+         */
+        const_iterator & operator++() {
+            if (current == nullptr || current == container->tail) {
+                throw invalid_iterator();
+            }
+            current = current->next;
+            return *this;
+        }
+        /**
+         * iter--
+         */
+        const_iterator operator--(int) {
+            if (current == nullptr || current == container->head->next) {
+                throw invalid_iterator();
+            }
+            const_iterator temp = *this;
+            current = current->prev;
+            return temp;
+        }
+        /**
+         * --iter
+         */
+        const_iterator & operator--() {
+            if (current == nullptr || current == container->head->next) {
+                throw invalid_iterator();
+            }
+            current = current->prev;
+            return *this;
+        }
+        const T & operator *() const {
+            if (current == nullptr || current == container->head || current == container->tail) {
+                throw invalid_iterator();
+            }
+            return current->data;
+        }
+        const T * operator ->() const {
+            if (current == nullptr || current == container->head || current == container->tail) {
+                throw invalid_iterator();
+            }
+            return &(current->data);
+        }
+        bool operator==(const const_iterator &rhs) const {
+            return current == rhs.current;
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return current != rhs.current;
+        }
+    };
+
+    sorted_list() {
+        init();
+    }
+    sorted_list(const sorted_list &other) {
+        init();
+        for (const node *cur = other.head->next; cur != other.tail; cur = cur->next) {
+            node *copy = new node(cur->data);
+            copy->prev = tail->prev;
+            copy->next = tail;
+            tail->prev->next = copy;
+            tail->prev = copy;
+            ++list_size;
+        }
+        rebuild_index();
+    }
+    /**
+     * takes over the nodes of other, which becomes empty
+     * the nodes are merge sorted and relinked, no element is copied or moved
+     */
+    explicit sorted_list(list<T> &&other) {
+        init();
+        other.compact_erased();
+        if (other.empty()) return;
+        typename list<T>::identity_key key;
+        other.merge_sort(key);
+        head->next = other.head->next;
+        head->next->prev = head;
+        tail->prev = other.tail->prev;
+        tail->prev->next = tail;
+        list_size = other.list_size;
+        other.head->next = other.tail;
+        other.tail->prev = other.head;
+        other.list_size = 0;
+        other.sorted_prefix = 0;
+        rebuild_index();
+    }
+    ~sorted_list() {
+        clear();
+        ::operator delete(head);
+        ::operator delete(tail);
+    }
+    sorted_list &operator=(const sorted_list &other) {
+        if (this == &other) return *this;
+        clear();
+        for (const node *cur = other.head->next; cur != other.tail; cur = cur->next) {
+            node *copy = new node(cur->data);
+            copy->prev = tail->prev;
+            copy->next = tail;
+            tail->prev->next = copy;
+            tail->prev = copy;
+            ++list_size;
+        }
+        rebuild_index();
+        return *this;
+    }
+
+    /**
+     * access the first / last element
+     * throw container_is_empty when the container is empty.
+     */
+    const T & front() const {
+        if (empty()) throw container_is_empty();
+        return head->next->data;
+    }
+    const T & back() const {
+        if (empty()) throw container_is_empty();
+        return tail->prev->data;
+    }
+    const_iterator begin() const {
+        return const_iterator(head->next, this);
+    }
+    const_iterator cbegin() const {
+        return const_iterator(head->next, this);
+    }
+    const_iterator end() const {
+        return const_iterator(tail, this);
+    }
+    const_iterator cend() const {
+        return const_iterator(tail, this);
+    }
+    bool empty() const {
+        return list_size == 0;
+    }
+    size_t size() const {
+        return list_size;
+    }
+    void clear() {
+        drop_index();
+        node *cur = head->next;
+        while (cur != tail) {
+            node *next = cur->next;
+            delete cur;
+            cur = next;
+        }
+        head->next = tail;
+        tail->prev = head;
+        list_size = 0;
+    }
+
+    /**
+     * the first element not less than value, end() if there is none
+     */
+    const_iterator lower_bound(const T &value) const {
+        return const_iterator(find_before(value, false, nullptr)->next, this);
+    }
+    /**
+     * the first element greater than value, end() if there is none
+     */
+    const_iterator upper_bound(const T &value) const {
+        return const_iterator(find_before(value, true, nullptr)->next, this);
+    }
+    /**
+     * the first element equivalent to value, end() if there is none
+     */
+    const_iterator find(const T &value) const {
+        const_iterator it = lower_bound(value);
+        if (it.current != tail && !(value < it.current->data)) return it;
+        return end();
+    }
+    /**
+     * insert value after the elements not greater than it, in O(log n) expected
+     * return an iterator pointing to the inserted value
+     */
+    const_iterator insert(const T &value) {
+        index_node *update[max_level];
+        node *before = find_before(value, true, update);
+        node *cur = new node(value);
+        cur->prev = before;
+        cur->next = before->next;
+        before->next->prev = cur;
+        before->next = cur;
+        ++list_size;
+
+        size_t h = random_level();
+        for (size_t l = levels; l < h; ++l) {
+            raise_levels(l + 1);
+            update[l] = heads[l];
+        }
+        index_node *down = nullptr;
+        for (size_t l = 0; l < h; ++l) {
+            update[l]->right = down = new index_node(cur, update[l]->right, down);
+        }
+        return const_iterator(cur, this);
+    }
+    /**
+     * remove the element at pos (the end() iterator is invalid)
+     * returns an iterator pointing to the following element
+     * throw if the container is empty, the iterator is invalid
+     */
+    const_iterator erase(const_iterator pos) {
+        if (empty()) throw container_is_empty();
+        if (pos.container != this || pos.current == tail || pos.current == nullptr) throw invalid_iterator();
+
+        node *cur = const_cast<node *>(pos.current);
+        node *next = cur->next;
+        unlink_index(cur);
+        cur->prev->next = next;
+        next->prev = cur->prev;
+        --list_size;
+        delete cur;
+        return const_iterator(next, this);
+    }
+    /**
+     * moves every element, in order, to the end of target by relinking the nodes
+     * *this becomes empty
+     */
+    void splice_into(list<T> &target) {
+        if (empty()) return;
+        drop_index();
+        target.reap_before(target.tail);
+        node *first = head->next, *last = tail->prev;
+        // appending keeps the known sorted prefix of target, and extends a sorted target
+        if (target.sorted_prefix == target.list_size
+            && (target.empty() || !(first->data < target.tail->prev->data))) {
+            target.sorted_prefix += list_size;
+        }
+        first->prev = target.tail->prev;
+        target.tail->prev->next = first;
+        last->next = target.tail;
+        target.tail->prev = last;
+        target.list_size += list_size;
+        head->next = tail;
+        tail->prev = head;
+        list_size = 0;
+    }
+};
+
+}
+
+#endif //SJTU_SORTED_LIST_HPP
@@ -0,0 +1,54 @@
+#ifndef SJTU_TUNING_HPP
+#define SJTU_TUNING_HPP
+
+/*
+ * Crossover thresholds of the numeric kernels.
+ * The autotune target measures them on the host and writes
+ * tuning_generated.hpp; when that header is on the include path its
+ * values win, otherwise the defaults below are used. Any of them can
+ * also be set with -D on the command line.
+ */
+#if defined(__has_include)
+#if __has_include("tuning_generated.hpp")
+#include "tuning_generated.hpp"
+#endif
+#endif
+
+/*
+ * sjtu::sort: partitions of at most this many elements are insertion sorted.
+ */
+#ifndef SJTU_SORT_CUTOFF
+#define SJTU_SORT_CUTOFF 16
+#endif
+
+/*
+ * Util::Bint multiplication: operands shorter than this many limbs are
+ * multiplied by schoolbook, longer ones are split by Karatsuba.
+ */
+#ifndef UTIL_BINT_MUL_BASE
+#define UTIL_BINT_MUL_BASE 48
+#endif
+
+/*
+ * Diamond::Matrix multiplication: tile sizes for rows of the result,
+ * the inner dimension and columns of the result.
+ */
+#ifndef DIAMOND_MATRIX_TILE_ROWS
+#define DIAMOND_MATRIX_TILE_ROWS 32
+#endif
+#ifndef DIAMOND_MATRIX_TILE_INNER
+#define DIAMOND_MATRIX_TILE_INNER 64
+#endif
+#ifndef DIAMOND_MATRIX_TILE_COLS
+#define DIAMOND_MATRIX_TILE_COLS 256
+#endif
+
+/*
+ * Diamond::LUDecompose: columns factored per panel before the rest of the
+ * matrix is updated by one blocked multiply.
+ */
+#ifndef DIAMOND_MATRIX_LU_BLOCK
+#define DIAMOND_MATRIX_LU_BLOCK 48
+#endif
+
+#endif //SJTU_TUNING_HPP
@@ -0,0 +1,502 @@
+#ifndef SJTU_UNORDERED_MAP_HPP
+#define SJTU_UNORDERED_MAP_HPP
+
+#include "exceptions.hpp"
+#include "utility.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace sjtu {
+
+/**
+ * a hash map like std::unordered_map, with open addressing in the Swiss table layout
+ * every slot has a control byte: empty, deleted, or the low 7 bits of the hash of
+ * its key. a lookup reads the control bytes of a group of 16 slots at once (one SSE2
+ * compare where available) and only compares keys whose 7 bits match.
+ * an erase leaves a tombstone only in a group without an empty slot, since a probe
+ * never goes past a group that has one; tombstones are dropped on rehash.
+ * the elements sjtu::pair<const Key, T> live in the slot array, so a rehash or an
+ * insert that grows the table invalidates iterators and references.
+ * find, count and erase take any key type when Hash and Equal both declare is_transparent.
+ */
+template<class Key, class T, class Hash = std::hash<Key>, class Equal = std::equal_to<Key>>
+class unordered_map {
+public:
+    typedef pair<const Key, T> value_type;
+    class const_iterator;
+    class iterator;
+
+protected:
+    typedef signed char ctrl_t;
+    static const ctrl_t ctrl_empty = -128;
+    static const ctrl_t ctrl_deleted = -2;
+    static const size_t group_width = 16;
+    static const size_t npos = size_t(-1);
+
+    /**
+     * the control bytes of one group, as bit masks of the slots that match
+     */
+    class group {
+    public:
+#ifdef __SSE2__
+        __m128i bytes;
+
+        explicit group(const ctrl_t *pos) : bytes(_mm_load_si128(reinterpret_cast<const __m128i *>(pos))) {}
+        unsigned match(ctrl_t h2) const {
+            return unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), bytes)));
+        }
+        unsigned match_empty() const {
+            return match(ctrl_empty);
+        }
+        unsigned match_free() const {
+            // empty and deleted are the only negative bytes
+            return unsigned(_mm_movemask_epi8(bytes));
+        }
+#else
+        const ctrl_t *bytes;
+
+        explicit group(const ctrl_t *pos) : bytes(pos) {}
+        unsigned match(ctrl_t h2) const {
+            unsigned mask = 0;
+            for (size_t i = 0; i < group_width; ++i) {
+                mask |= unsigned(bytes[i] == h2) << i;
+            }
+            return mask;
+        }
+        unsigned match_empty() const {
+            return match(ctrl_empty);
+        }
+        unsigned match_free() const {
+            unsigned mask = 0;
+            for (size_t i = 0; i < group_width; ++i) {
+                mask |= unsigned(bytes[i] < 0) << i;
+            }
+            return mask;
+        }
+#endif
+    };
+    struct alignas(16) ctrl_block {
+        ctrl_t bytes[group_width];
+    };
+
+    ctrl_t *ctrl;        // capacity control bytes, 16-aligned
+    value_type *slots;   // raw storage of capacity elements
+    size_t capacity;     // 0 or a power of two, at least group_width
+    size_t map_size;
+    size_t growth_left;  // empty slots that may still be filled before a rehash
+    Hash hasher;
+    Equal equal;
+
+    template<class H, class = void>
+    struct transparent : std::false_type {};
+    template<class H>
+    struct transparent<H, decltype(void(sizeof(typename H::is_transparent *)))> : std::true_type {};
+    typedef std::integral_constant<bool, transparent<Hash>::value && transparent<Equal>::value> heterogeneous;
+
+    static size_t lowest_bit(unsigned mask) {
+        return size_t(__builtin_ctz(mask));
+    }
+    /**
+     * at most 7 / 8 of the slots are in use, so every probe meets an empty slot
+     */
+    static size_t max_load(size_t cap) {
+        return cap - cap / 8;
+    }
+    /**
+     * std::hash of an integer is the integer itself: spread it over all bits,
+     * as the group comes from the high bits and the control byte from the low ones
+     */
+    template<class Q>
+    size_t hash_of(const Q &key) const {
+        unsigned long long h = (unsigned long long)hasher(key) * 0x9E3779B97F4A7C15ULL;
+        return size_t(h ^ (h >> 32));
+    }
+    static ctrl_t h2_of(size_t h) {
+        return ctrl_t(h & 0x7F);
+    }
+
+    /**
+     * the slot holding key, or npos
+     */
+    template<class Q>
+    size_t find_index(const Q &key) const {
+        if (capacity == 0) return npos;
+        size_t h = hash_of(key);
+        ctrl_t h2 = h2_of(h);
+        size_t mask = capacity / group_width - 1;
+        size_t g = (h >> 7) & mask;
+        for (size_t step = 1;; ++step) {
+            group grp(ctrl + g * group_width);
+            for (unsigned m = grp.match(h2); m != 0; m &= m - 1) {
+                size_t i = g * group_width + lowest_bit(m);
+                if (equal(slots[i].first, key)) return i;
+            }
+            if (grp.match_empty() != 0) return npos;
+            g = (g + step) & mask;
+        }
+    }
+    /**
+     * the first empty or deleted slot on the probe sequence of hash h
+     */
+    size_t find_free(size_t h) const {
+        size_t mask = capacity / group_width - 1;
+        size_t g = (h >> 7) & mask;
+        for (size_t step = 1;; ++step) {
+            unsigned m = group(ctrl + g * group_width).match_free();
+            if (m != 0) return g * group_width + lowest_bit(m);
+            g = (g + step) & mask;
+        }
+    }
+    size_t next_full(size_t i) const {
+        while (i < capacity && ctrl[i] < 0) {
+            ++i;
+        }
+        return i;
+    }
+
+    /**
+     * move every element into a fresh table of new_capacity slots, dropping the tombstones
+     */
+    void rehash(size_t new_capacity) {
+        ctrl_t *old_ctrl = ctrl;
+        value_type *old_slots = slots;
+        size_t old_capacity = capacity;
+        ctrl_block *blocks = new ctrl_block[new_capacity / group_width];
+        try {
+            slots = static_cast<value_type *>(::operator new(new_capacity * sizeof(value_type)));
+        } catch (...) {
+            delete [] blocks;
+            throw;
+        }
+        ctrl = reinterpret_cast<ctrl_t *>(blocks);
+        capacity = new_capacity;
+        for (size_t i = 0; i < capacity; ++i) {
+            ctrl[i] = ctrl_empty;
+        }
+        for (size_t i = 0; i < old_capacity; ++i) {
+            if (old_ctrl[i] >= 0) {
+                size_t h = hash_of(old_slots[i].first);
+                size_t j = find_free(h);
+                new (&slots[j]) value_type(std::move(old_slots[i]));
+                old_slots[i].~value_type();
+                ctrl[j] = h2_of(h);
+            }
+        }
+        growth_left = max_load(capacity) - map_size;
+        delete [] reinterpret_cast<ctrl_block *>(old_ctrl);
+        ::operator delete(old_slots);
+    }
+    /**
+     * make room for one more element: drop the tombstones if they fill half of the
+     * load budget, grow the table otherwise
+     */
+    void prepare_insert() {
+        if (growth_left > 0) return;
+        if (capacity > 0 && map_size <= max_load(capacity) / 2) {
+            rehash(capacity);
+        } else {
+            rehash(capacity == 0 ? group_width : capacity * 2);
+        }
+    }
+    /**
+     * put value into a free slot for hash h, the key being known to be absent
+     */
+    size_t emplace_new(size_t h, const value_type &value) {
+        size_t i = find_free(h);
+        new (&slots[i]) value_type(value);
+        if (ctrl[i] == ctrl_empty) {
+            growth_left--;
+        }
+        ctrl[i] = h2_of(h);
+        map_size++;
+        return i;
+    }
+    void erase_index(size_t i) {
+        slots[i].~value_type();
+        if (group(ctrl + i / group_width * group_width).match_empty() != 0) {
+            ctrl[i] = ctrl_empty;
+            growth_left++;
+        } else {
+            ctrl[i] = ctrl_deleted;
+        }
+        map_size--;
+    }
+    void release() {
+        clear();
+        delete [] reinterpret_cast<ctrl_block *>(ctrl);
+        ::operator delete(slots);
+        ctrl = nullptr;
+        slots = nullptr;
+        capacity = growth_left = 0;
+    }
+
+public:
+    class iterator {
+    private:
+        const unordered_map *container;
+        size_t index;
+
+    public:
+        friend class unordered_map;
+        friend class const_iterator;
+        iterator() : container(nullptr), index(0) {}
+        iterator(const unordered_map *c, size_t i) : container(c), index(i) {}
+
+        iterator operator++(int) {
+            iterator temp = *this;
+            ++*this;
+            return temp;
+        }
+        iterator & operator++() {
+            if (container == nullptr || index >= container->capacity) {
+                throw invalid_iterator();
+            }
+            index = container->next_full(index + 1);
+            return *this;
+        }
+        value_type & operator *() const {
+            if (container == nullptr || index >= container->capacity || container->ctrl[index] < 0) {
+                throw invalid_iterator();
+            }
+            return container->slots[index];
+        }
+        value_type * operator ->() const {
+            return &**this;
+        }
+        bool operator==(const iterator &rhs) const {
+            return container == rhs.container && index == rhs.index;
+        }
+        bool operator==(const const_iterator &rhs) const {
+            return container == rhs.container && index == rhs.index;
+        }
+        bool operator!=(const iterator &rhs) const {
+            return !(*this == rhs);
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return !(*this == rhs);
+        }
+    };
+    class const_iterator {
+    private:
+        const unordered_map *container;
+        size_t index;
+
+    public:
+        friend class unordered_map;
+        friend class iterator;
+        const_iterator() : container(nullptr), index(0) {}
+        const_iterator(const unordered_map *c, size_t i) : container(c), index(i) {}
+        const_iterator(const iterator &it) : container(it.container), index(it.index) {}
+
+        const_iterator operator++(int) {
+            const_iterator temp = *this;
+            ++*this;
+            return temp;
+        }
+        const_iterator & operator++() {
+            if (container == nullptr || index >= container->capacity) {
+                throw invalid_iterator();
+            }
+            index = container->next_full(index + 1);
+            return *this;
+        }
+        const value_type & operator *() const {
+            if (container == nullptr || index >= container->capacity || container->ctrl[index] < 0) {
+                throw invalid_iterator();
+            }
+            return container->slots[index];
+        }
+        const value_type * operator ->() const {
+            return &**this;
+        }
+        bool operator==(const const_iterator &rhs) const {
+            return container == rhs.container && index == rhs.index;
+        }
+        bool operator==(const iterator &rhs) const {
+            return container == rhs.container && index == rhs.index;
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return !(*this == rhs);
+        }
+        bool operator!=(const iterator &rhs) const {
+            return !(*this == rhs);
+        }
+    };
+
+    unordered_map() : ctrl(nullptr), slots(nullptr), capacity(0), map_size(0), growth_left(0) {}
+    unordered_map(const unordered_map &other) : unordered_map() {
+        hasher = other.hasher;
+        equal = other.equal;
+        reserve(other.size());
+        for (const_iterator it = other.cbegin(); it != other.cend(); ++it) {
+            emplace_new(hash_of(it->first), *it);
+        }
+    }
+    ~unordered_map() {
+        release();
+    }
+    unordered_map &operator=(const unordered_map &other) {
+        if (this == &other) return *this;
+        clear();
+        hasher = other.hasher;
+        equal = other.equal;
+        reserve(other.size());
+        for (const_iterator it = other.cbegin(); it != other.cend(); ++it) {
+            emplace_new(hash_of(it->first), *it);
+        }
+        return *this;
+    }
+
+    iterator begin() {
+        return iterator(this, next_full(0));
+    }
+    const_iterator cbegin() const {
+        return const_iterator(this, next_full(0));
+    }
+    iterator end() {
+        return iterator(this, capacity);
+    }
+    const_iterator cend() const {
+        return const_iterator(this, capacity);
+    }
+
+    bool empty() const {
+        return map_size == 0;
+    }
+    size_t size() const {
+        return map_size;
+    }
+    /**
+     * the number of slots
+     */
+    size_t bucket_count() const {
+        return capacity;
+    }
+    /**
+     * destroy the elements and keep the slots
+     */
+    void clear() {
+        for (size_t i = 0; i < capacity; ++i) {
+            if (ctrl[i] >= 0) {
+                slots[i].~value_type();
+            }
+            ctrl[i] = ctrl_empty;
+        }
+        map_size = 0;
+        growth_left = max_load(capacity);
+    }
+    /**
+     * make room for n elements, so that inserting up to n of them never rehashes
+     */
+    void reserve(size_t n) {
+        if (n == 0) return;
+        size_t cap = group_width;
+        while (max_load(cap) < n) {
+            cap *= 2;
+        }
+        if (cap > capacity || (n > map_size && growth_left < n - map_size)) {
+            rehash(cap > capacity ? cap : capacity);
+        }
+    }
+
+    /**
+     * insert value unless its key is in the map already
+     * return an iterator to the element with that key and whether it was inserted
+     */
+    pair<iterator, bool> insert(const value_type &value) {
+        size_t i = find_index(value.first);
+        if (i != npos) {
+            return pair<iterator, bool>(iterator(this, i), false);
+        }
+        prepare_insert();
+        return pair<iterator, bool>(iterator(this, emplace_new(hash_of(value.first), value)), true);
+    }
+    /**
+     * access the value of key, inserting T() first if key is not in the map
+     */
+    T & operator[](const Key &key) {
+        size_t i = find_index(key);
+        if (i == npos) {
+            prepare_insert();
+            i = emplace_new(hash_of(key), value_type(key, T()));
+        }
+        return slots[i].second;
+    }
+    /**
+     * throw index_out_of_bound if key is not in the map
+     */
+    T & at(const Key &key) {
+        size_t i = find_index(key);
+        if (i == npos) throw index_out_of_bound();
+        return slots[i].second;
+    }
+    const T & at(const Key &key) const {
+        size_t i = find_index(key);
+        if (i == npos) throw index_out_of_bound();
+        return slots[i].second;
+    }
+
+    iterator find(const Key &key) {
+        size_t i = find_index(key);
+        return iterator(this, i == npos ? capacity : i);
+    }
+    const_iterator find(const Key &key) const {
+        size_t i = find_index(key);
+        return const_iterator(this, i == npos ? capacity : i);
+    }
+    template<class Q, class = typename std::enable_if<heterogeneous::value, Q>::type>
+    iterator find(const Q &key) {
+        size_t i = find_index(key);
+        return iterator(this, i == npos ? capacity : i);
+    }
+    template<class Q, class = typename std::enable_if<heterogeneous::value, Q>::type>
+    const_iterator find(const Q &key) const {
+        size_t i = find_index(key);
+        return const_iterator(this, i == npos ? capacity : i);
+    }
+    size_t count(const Key &key) const {
+        return find_index(key) == npos ? 0 : 1;
+    }
+    template<class Q, class = typename std::enable_if<heterogeneous::value, Q>::type>
+    size_t count(const Q &key) const {
+        return find_index(key) == npos ? 0 : 1;
+    }
+
+    /**
+     * remove the element at pos (end() is invalid)
+     * return an iterator to the next element; erase never moves the others
+     */
+    iterator erase(iterator pos) {
+        if (pos.container != this || pos.index >= capacity || ctrl[pos.index] < 0) throw invalid_iterator();
+        erase_index(pos.index);
+        return iterator(this, next_full(pos.index + 1));
+    }
+    /**
+     * remove the element with key, return the number of elements removed (0 or 1)
+     */
+    size_t erase(const Key &key) {
+        size_t i = find_index(key);
+        if (i == npos) return 0;
+        erase_index(i);
+        return 1;
+    }
+    template<class Q, class = typename std::enable_if<heterogeneous::value && !std::is_convertible<const Q &, iterator>::value, Q>::type>
+    size_t erase(const Q &key) {
+        size_t i = find_index(key);
+        if (i == npos) return 0;
+        erase_index(i);
+        return 1;
+    }
+};
+
+}
+
+#endif //SJTU_UNORDERED_MAP_HPP